@@ -0,0 +1,201 @@
+/*
+ * ytvk-bench: CPU microbenchmarks for engine hot paths
+ *
+ * Nothing here touches the GPU, so it runs on machines without a display or Vulkan driver.
+ * Run from the repository root so the bundled models resolve (make bench writes bin/bench.json).
+ */
+
+#include "model.hpp"
+#include "texture.hpp"
+#include "game_object.hpp"
+#include "camera.hpp"
+#include "utils.hpp"
+#include "draw_list.hpp"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    const char *const VASE_MODELS[] = {"models/flat_vase.obj", "models/smooth_vase.obj"};
+    const char *const TEXTURES[] = {"textures/checker.ktx2", "textures/tiles.ppm"};
+
+    // The vase with every index expanded, i.e. the vertex stream loadModel deduplicates
+    const std::vector<YTVK::Model::Vertex> &expandedVase()
+    {
+        static const std::vector<YTVK::Model::Vertex> vertices = []
+        {
+            YTVK::Model::Builder builder{};
+            builder.loadModel(VASE_MODELS[1]);
+
+            std::vector<YTVK::Model::Vertex> expanded;
+            expanded.reserve(builder.indices.size());
+            for (uint32_t index : builder.indices)
+            {
+                expanded.push_back(builder.vertices[index]);
+            }
+            return expanded;
+        }();
+        return vertices;
+    }
+
+    void BM_LoadModel(benchmark::State &state)
+    {
+        const std::string path = VASE_MODELS[state.range(0)];
+        for (auto _ : state)
+        {
+            YTVK::Model::Builder builder{};
+            builder.loadModel(path);
+            benchmark::DoNotOptimize(builder.vertices.data());
+        }
+        state.SetLabel(path);
+    }
+    BENCHMARK(BM_LoadModel)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+    // Parsing and validation only; the upload needs a device
+    void BM_LoadTexture(benchmark::State &state)
+    {
+        const std::string path = TEXTURES[state.range(0)];
+        for (auto _ : state)
+        {
+            YTVK::Texture::Builder builder{};
+            builder.loadTexture(path);
+            benchmark::DoNotOptimize(builder.data.data());
+        }
+        state.SetLabel(path);
+    }
+    BENCHMARK(BM_LoadTexture)->Arg(0)->Arg(1)->Unit(benchmark::kMicrosecond);
+
+    void BM_VertexHash(benchmark::State &state)
+    {
+        const auto &vertices = expandedVase();
+        std::hash<YTVK::Model::Vertex> hasher{};
+        for (auto _ : state)
+        {
+            size_t combined = 0;
+            for (const auto &vertex : vertices)
+            {
+                combined ^= hasher(vertex);
+            }
+            benchmark::DoNotOptimize(combined);
+        }
+        state.SetItemsProcessed(state.iterations() * vertices.size());
+    }
+    BENCHMARK(BM_VertexHash);
+
+    // Same map-based dedup loadModel runs on every shape
+    void BM_VertexDedup(benchmark::State &state)
+    {
+        const auto &vertices = expandedVase();
+        for (auto _ : state)
+        {
+            YTVK::Model::Builder builder{};
+            std::unordered_map<YTVK::Model::Vertex, uint32_t> uniqueVertices{};
+            for (const auto &vertex : vertices)
+            {
+                builder.addVertex(vertex, uniqueVertices);
+            }
+            benchmark::DoNotOptimize(builder.indices.data());
+        }
+        state.SetItemsProcessed(state.iterations() * vertices.size());
+    }
+    BENCHMARK(BM_VertexDedup);
+
+    void BM_TransformMat4(benchmark::State &state)
+    {
+        YTVK::TransformComponent transform{{1.0f, 0.0f, 2.5f}, {0.5f, 0.25f, 0.5f}, {0.1f, 0.2f, 0.3f}};
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(transform);
+            glm::mat4 matrix = transform.mat4();
+            benchmark::DoNotOptimize(matrix);
+        }
+    }
+    BENCHMARK(BM_TransformMat4);
+
+    void BM_TransformNormalMatrix(benchmark::State &state)
+    {
+        YTVK::TransformComponent transform{{1.0f, 0.0f, 2.5f}, {0.5f, 0.25f, 0.5f}, {0.1f, 0.2f, 0.3f}};
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(transform);
+            glm::mat3 matrix = transform.normalMatrix();
+            benchmark::DoNotOptimize(matrix);
+        }
+    }
+    BENCHMARK(BM_TransformNormalMatrix);
+
+    void BM_CameraSetViewYXZ(benchmark::State &state)
+    {
+        YTVK::Camera camera{};
+        glm::vec3 position{0.0f, -1.0f, -2.5f};
+        glm::vec3 rotation{0.2f, 0.4f, 0.0f};
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(position);
+            camera.setViewYXZ(position, rotation);
+            benchmark::DoNotOptimize(camera.getView());
+        }
+    }
+    BENCHMARK(BM_CameraSetViewYXZ);
+
+    void BM_CameraSetPerspectiveProjection(benchmark::State &state)
+    {
+        YTVK::Camera camera{};
+        float aspect = 800.0f / 600.0f;
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(aspect);
+            camera.setPerspectiveProjection(glm::radians(50.0f), aspect, 0.1f, 10.0f);
+            benchmark::DoNotOptimize(camera.getProjection());
+        }
+    }
+    BENCHMARK(BM_CameraSetPerspectiveProjection);
+
+    void BM_HashCombine(benchmark::State &state)
+    {
+        glm::vec3 a{1.0f, 2.0f, 3.0f};
+        glm::vec3 b{4.0f, 5.0f, 6.0f};
+        glm::vec2 c{7.0f, 8.0f};
+        for (auto _ : state)
+        {
+            benchmark::DoNotOptimize(a);
+            size_t seed = 0;
+            YTVK::hashCombine(seed, a, b, c);
+            benchmark::DoNotOptimize(seed);
+        }
+    }
+    BENCHMARK(BM_HashCombine);
+
+    // A frame's worth of draws over a few models and textures at scattered depths, as RenderSystem keys them
+    void BM_DrawListSort(benchmark::State &state)
+    {
+        std::mt19937 random{42};
+        std::uniform_real_distribution<float> depth{0.1f, 100.0f};
+        std::vector<uint64_t> keys(state.range(0));
+        for (auto &key : keys)
+        {
+            key = YTVK::DrawList::opaqueKey(0, random() % 8, random() % 64, depth(random));
+        }
+
+        YTVK::DrawList drawList{};
+        for (auto _ : state)
+        {
+            drawList.clear();
+            for (uint32_t i = 0; i < keys.size(); ++i)
+            {
+                drawList.add(keys[i], i);
+            }
+            drawList.sort();
+            benchmark::DoNotOptimize(drawList.getDraws().data());
+        }
+        state.SetItemsProcessed(state.iterations() * keys.size());
+    }
+    BENCHMARK(BM_DrawListSort)->Arg(1000)->Arg(10000)->Arg(100000)->Unit(benchmark::kMicrosecond)->UseRealTime();
+}
+
+BENCHMARK_MAIN();
@@ -1,2 +1,7 @@
 $(which glslc) shaders/simple.vert -o shaders/simple.vert.spv
 $(which glslc) shaders/simple.frag -o shaders/simple.frag.spv
+$(which glslc) shaders/simple_bindless.frag -o shaders/simple_bindless.frag.spv
+$(which glslc) shaders/simple_textured.frag -o shaders/simple_textured.frag.spv
+$(which glslc) shaders/cluster.comp -o shaders/cluster.comp.spv
+$(which glslc) shaders/shadow.vert -o shaders/shadow.vert.spv
+$(which glslc) shaders/depth_prepass.vert -o shaders/depth_prepass.vert.spv
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * Heap allocation counters for verifying that steady-state frames never allocate.
+ *
+ * Building with -DYTVK_TRACK_ALLOCATIONS replaces the global operator new/delete with versions that
+ * count allocations per thread and in total; without it every counter stays at zero. Only C++
+ * allocations are seen: direct malloc calls (drivers, GLFW) are not hooked.
+ *
+ *   AllocationTracker::Scope frame{};
+ *   ...
+ *   if (frame.allocations() > 0) ...
+ */
+
+namespace YTVK
+{
+    class AllocationTracker
+    {
+    public:
+        // True when the operator new hooks are compiled in
+        static bool isEnabled();
+
+        // Made by the calling thread since it started
+        static uint64_t threadAllocations();
+        static uint64_t threadBytes();
+        static uint64_t totalAllocations();
+
+        // Counts what the current thread allocates between construction and the query
+        class Scope
+        {
+        public:
+            Scope() : startAllocations{threadAllocations()}, startBytes{threadBytes()} {}
+
+            uint64_t allocations() const { return threadAllocations() - startAllocations; }
+            uint64_t bytes() const { return threadBytes() - startBytes; }
+
+        private:
+            uint64_t startAllocations;
+            uint64_t startBytes;
+        };
+    };
+}
@@ -4,7 +4,14 @@
 #include "device.hpp"
 #include "renderer.hpp"
 #include "descriptors.hpp"
+#include "bindless.hpp"
+#include "texture.hpp"
+#include "texture_streamer.hpp"
+#include "clustered_lighting.hpp"
 #include "game_object.hpp"
+#include "asset_archive.hpp"
+#include "app_config.hpp"
+#include "scene.hpp"
 
 #include <memory>
 #include <vector>
@@ -15,10 +22,9 @@ namespace YTVK
     class App
     {
     public:
-        static constexpr int WIDTH = 800;
-        static constexpr int HEIGHT = 600;
+        static constexpr const char *ASSET_ARCHIVE_PATH = "assets.ytva";
 
-        App();
+        explicit App(const AppConfig &config = {});
         ~App();
         App(const App &) = delete;
         App &operator=(const App &) = delete;
@@ -27,11 +33,35 @@ namespace YTVK
 
     private:
         void loadGameObjects();
+        void loadScene(const SceneDescription &scene);
+        void finishStartupReport();
 
-        Window window;
+        AppConfig config;
+        std::unique_ptr<AssetArchive> assetArchive;
+        // Null when running headless
+        std::unique_ptr<Window> window;
         Device device;
-        Renderer renderer;
-        std::unique_ptr<DescriptorPool> globalPool;
+        std::unique_ptr<Renderer> renderer;
+        std::unique_ptr<DescriptorAllocator> descriptorAllocator;
+        std::unique_ptr<DescriptorLayoutCache> layoutCache;
+        std::unique_ptr<DescriptorSetCache> descriptorSetCache;
+        // Null when the device lacks descriptor indexing
+        std::unique_ptr<BindlessSet> bindlessSet;
+        std::unique_ptr<SamplerCache> samplerCache;
+        // Scene textures, sampled through bindlessSet or pushed per draw by RenderSystem without one
+        std::vector<std::unique_ptr<Texture>> textures;
+        // Set with --texture-budget-mb; owns the scene textures instead of textures
+        std::unique_ptr<TextureStreamer> textureStreamer;
         std::vector<GameObject> gameObjects;
+        // Generated scenes spin part of their objects every frame
+        struct MovingObject
+        {
+            size_t index;
+            glm::vec3 spin;
+        };
+        std::vector<MovingObject> movingObjects;
+        std::vector<ClusteredLighting::PointLight> pointLights;
+        // Set in benchmark mode
+        std::unique_ptr<SceneDescription> benchmarkScene;
     };
 };
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "depth_prepass_mode.hpp"
+#include "swapchain.hpp"
+
+#include <string>
+
+namespace YTVK
+{
+    // Startup options, so latency/throughput tuning does not need a rebuild
+    struct AppConfig
+    {
+        SwapChainSettings swapChain{};
+        bool printFrameStats = false;
+
+        uint32_t width = 800;
+        uint32_t height = 600;
+        // Render offscreen without a window, surface or GLFW
+        bool headless = false;
+        // Stop after this many frames, 0 runs until the window is closed (headless defaults to 1)
+        uint32_t frameCount = 0;
+        // Headless only: write the last frame to this PPM file
+        std::string capturePath{};
+
+        // Replay the camera path of this scene file instead of taking keyboard input
+        std::string benchmarkScenePath{};
+        // Results file; .csv gets one row per frame, anything else a JSON summary
+        std::string benchmarkOutputPath{"benchmark.json"};
+        // Also the frames --check-allocations ignores
+        uint32_t benchmarkWarmupFrames = 60;
+        // Overrides the object count of the scene's generate directives (0 keeps them)
+        uint32_t sceneObjectCount = 0;
+
+        // Collect pipeline statistics per render system (printed with --frame-stats, added to benchmarks)
+        bool pipelineStatistics = false;
+
+        // CPU trace zones are recorded when set; the trace is written here on exit and on F12
+        std::string tracePath{};
+        // Also write a trace whenever a frame takes longer than this (0 disables)
+        float traceSpikeMs = 0.0f;
+
+        // Print the GPU memory report every few seconds and on exit
+        bool printMemoryStats = false;
+        // Device local allocations past this many MiB throw (0 is unlimited)
+        uint32_t vramBudgetMb = 0;
+        // Stream scene texture mips within this many MiB instead of loading them whole (0 disables)
+        uint32_t textureBudgetMb = 0;
+
+        // Fail the run if a frame allocates on the heap after the warm-up frames (needs YTVK_TRACK_ALLOCATIONS)
+        bool checkAllocations = false;
+
+        // Per-phase startup timings and counts, printed and/or written as JSON once the first frame is done
+        bool printStartupReport = false;
+        std::string startupReportPath{};
+
+        // Lay down depth in a pre-pass so the main pass shades each pixel once; auto keeps whichever measures faster
+        DepthPrepassMode depthPrepass = DepthPrepassMode::Auto;
+
+        bool isBenchmark() const { return !benchmarkScenePath.empty(); }
+
+        // Throws std::runtime_error on unknown or malformed arguments
+        static AppConfig fromCommandLine(int argc, char **argv);
+        static std::string usage();
+        static const char *depthPrepassModeName(DepthPrepassMode mode);
+    };
+}
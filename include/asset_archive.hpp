@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace YTVK
+{
+    // Non-owning view of bytes inside a mapped archive (stand-in for std::span under C++17)
+    struct AssetView
+    {
+        const char *data = nullptr;
+        size_t size = 0;
+
+        bool empty() const { return size == 0; }
+        explicit operator bool() const { return data != nullptr; }
+    };
+
+    /*
+     * Single-file asset pack. Layout on disk:
+     *
+     *   Header | blob 0 | blob 1 | ... | directory (Entry[], sorted by pathHash) | path strings
+     *
+     * Every blob starts on a BLOB_ALIGNMENT boundary so SPIR-V and vertex data can be consumed
+     * straight out of the mapping. Entries may optionally be stored LZ compressed, in which case
+     * they have to be read through read() instead of view().
+     */
+    class AssetArchive
+    {
+    public:
+        static constexpr uint32_t MAGIC = 0x41565459; // "YTVA"
+        static constexpr uint32_t VERSION = 1;
+        static constexpr uint64_t BLOB_ALIGNMENT = 64;
+
+        enum class Compression : uint32_t
+        {
+            None = 0,
+            LZ = 1,
+        };
+
+        struct Header
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t entryCount;
+            uint32_t reserved;
+            uint64_t directoryOffset;
+            uint64_t stringsOffset;
+            uint64_t stringsSize;
+        };
+
+        struct Entry
+        {
+            uint64_t pathHash;
+            uint64_t offset;
+            uint64_t size;    // bytes stored in the archive
+            uint64_t rawSize; // bytes after decompression
+            uint32_t compression;
+            uint32_t pathOffset;
+            uint32_t pathLength;
+            uint32_t reserved;
+        };
+
+        class Writer
+        {
+        public:
+            Writer &addFile(const std::string &archivePath, const std::string &sourcePath, bool compress = false);
+            Writer &addData(const std::string &archivePath, std::vector<char> data, bool compress = false);
+            void write(const std::string &outputPath) const;
+
+        private:
+            struct PendingEntry
+            {
+                std::string path;
+                std::vector<char> data;
+                bool compress;
+            };
+
+            std::vector<PendingEntry> entries{};
+        };
+
+        explicit AssetArchive(const std::string &path);
+        ~AssetArchive();
+        AssetArchive(const AssetArchive &) = delete;
+        AssetArchive &operator=(const AssetArchive &) = delete;
+
+        const Entry *find(const std::string &path) const;
+        bool contains(const std::string &path) const { return find(path) != nullptr; }
+
+        // Zero-copy access; returns an empty view for missing or compressed entries
+        AssetView view(const std::string &path) const;
+        // Copies (and decompresses if needed) an entry, throws if it is missing
+        std::vector<char> read(const std::string &path) const;
+
+        uint32_t entryCount() const { return header->entryCount; }
+        const std::string &getPath() const { return path; }
+
+        static uint64_t hashPath(const std::string &path);
+        static uint64_t hashBytes(const char *data, size_t size, uint64_t seed = 0xcbf29ce484222325ull);
+
+        // Process-wide archive consulted by Pipeline and Model before falling back to loose files
+        static void mount(AssetArchive *archive);
+        static AssetArchive *mounted();
+
+        // Resolves a path against the mounted archive, then the filesystem. The returned view points
+        // into the mapping when possible and into storage otherwise.
+        static AssetView load(const std::string &path, std::vector<char> &storage);
+        static std::vector<char> readFile(const std::string &path);
+
+        static std::vector<char> compressLZ(const char *data, size_t size);
+        static void decompressLZ(const char *data, size_t size, char *out, size_t outSize);
+
+    private:
+        std::string path;
+        const char *mapping = nullptr;
+        size_t mappingSize = 0;
+
+        const Header *header = nullptr;
+        const Entry *entries = nullptr;
+        const char *strings = nullptr;
+    };
+}
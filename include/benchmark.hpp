@@ -0,0 +1,73 @@
+#pragma once
+
+#include "frame_stats.hpp"
+#include "pipeline_statistics.hpp"
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace YTVK
+{
+    // Collects per-frame timings for --benchmark runs and reports percentiles as JSON or CSV
+    class BenchmarkRecorder
+    {
+    public:
+        struct Summary
+        {
+            uint32_t count = 0;
+            float mean = 0.0f;
+            float p50 = 0.0f;
+            float p95 = 0.0f;
+            float p99 = 0.0f;
+            float max = 0.0f;
+        };
+
+        using Metadata = std::vector<std::pair<std::string, std::string>>;
+
+        // The first warmupFrames frames are ignored (pipeline warm-up, first uploads)
+        explicit BenchmarkRecorder(uint32_t warmupFrames) : warmupFrames{warmupFrames} {}
+
+        void add(const FrameStats &stats, float cpuFrameMs);
+        // Averaged per scope; results for the same frame number are only counted once
+        void addPipelineStatistics(const std::vector<PipelineStatistics::Result> &results, uint64_t frameNumber);
+
+        static Summary summarize(std::vector<float> samples);
+
+        // Writes CSV (one row per frame) if path ends in .csv, JSON (metadata + summaries) otherwise
+        void write(const std::string &path, const Metadata &metadata) const;
+        void printSummary() const;
+
+    private:
+        struct FrameRecord
+        {
+            uint64_t frameNumber;
+            float cpuFrameMs;
+            float cpuWaitMs;
+            // Filled in when the result arrives, framesInFlight frames later; negative if it never did
+            float gpuTimeMs = -1.0f;
+        };
+
+        void writeJson(const std::string &path, const Metadata &metadata) const;
+        void writeCsv(const std::string &path) const;
+        // The recorded frames' values of one field; frames without a GPU time are left out
+        std::vector<float> samples(float FrameRecord::*field) const;
+
+        uint32_t warmupFrames;
+        uint32_t framesSeen = 0;
+        std::vector<FrameRecord> frames;
+
+        struct StatisticsTotals
+        {
+            uint64_t frames = 0;
+            uint64_t inputAssemblyVertices = 0;
+            uint64_t vertexShaderInvocations = 0;
+            uint64_t clippingPrimitives = 0;
+            uint64_t fragmentShaderInvocations = 0;
+        };
+        std::map<std::string, StatisticsTotals> pipelineStatistics;
+        uint64_t lastStatisticsFrame = 0;
+    };
+}
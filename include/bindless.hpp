@@ -0,0 +1,64 @@
+#pragma once
+
+#include "device.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace YTVK
+{
+    /*
+     * One global descriptor set holding every sampled image and storage buffer in large, partially
+     * bound, update-after-bind arrays. Objects and materials refer to resources by array index in
+     * their per-object data, so the set is bound once per frame instead of once per draw. Needs
+     * Device::supportsBindless().
+     */
+    class BindlessSet
+    {
+    public:
+        static constexpr uint32_t TEXTURE_BINDING = 0;
+        static constexpr uint32_t STORAGE_BUFFER_BINDING = 1;
+        static constexpr uint32_t INVALID_INDEX = ~0u;
+
+        // Upper bounds, lowered to the device's update-after-bind limits
+        static constexpr uint32_t MAX_TEXTURES = 16384;
+        static constexpr uint32_t MAX_STORAGE_BUFFERS = 4096;
+
+        explicit BindlessSet(Device &device);
+        ~BindlessSet();
+        BindlessSet(const BindlessSet &) = delete;
+        BindlessSet &operator=(const BindlessSet &) = delete;
+
+        // Returned indices are valid in shaders straight away, including frames already recorded
+        uint32_t addTexture(VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+        uint32_t addStorageBuffer(const VkDescriptorBufferInfo &bufferInfo);
+
+        // The index is handed out again once frames that may still use it have retired
+        void removeTexture(uint32_t index);
+        void removeStorageBuffer(uint32_t index);
+
+        VkDescriptorSetLayout getLayout() const { return layout; }
+        VkDescriptorSet getDescriptorSet() const { return set; }
+        uint32_t getTextureCapacity() const { return textures->capacity; }
+        uint32_t getStorageBufferCapacity() const { return storageBuffers->capacity; }
+
+    private:
+        struct Slots
+        {
+            uint32_t capacity = 0;
+            uint32_t next = 0;
+            std::vector<uint32_t> available;
+        };
+
+        static uint32_t acquireSlot(Slots &slots, const char *table);
+        void releaseSlot(const std::shared_ptr<Slots> &slots, uint32_t index);
+
+        Device &device;
+        VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+        VkDescriptorPool pool = VK_NULL_HANDLE;
+        VkDescriptorSet set = VK_NULL_HANDLE;
+        // Shared with deletion queue callbacks, which may run after the set is gone
+        std::shared_ptr<Slots> textures;
+        std::shared_ptr<Slots> storageBuffers;
+    };
+}
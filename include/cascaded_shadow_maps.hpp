@@ -0,0 +1,129 @@
+#pragma once
+
+#include "camera.hpp"
+#include "device.hpp"
+#include "frame_info.hpp"
+#include "game_object.hpp"
+#include "pipeline.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <array>
+#include <memory>
+#include <vector>
+
+namespace YTVK
+{
+    /*
+     * Cascaded shadow maps for the directional light. The camera frustum up to the far plane is
+     * split into CASCADE_COUNT slices, each covered by an orthographic light space box fitted to the
+     * slice's bounding sphere. Boxes move in coarse steps (SNAP_FRACTION of their size, always whole
+     * texels), so while the camera moves inside a step a cascade keeps exactly the same matrix.
+     *
+     * Static objects (GameObject::isStatic) are rendered into a cached depth layer per cascade that is
+     * only redrawn when the cascade's matrix changes or invalidateStaticCasters() is called. Each
+     * frame the cached layer is copied into the sampled map and dynamic objects are drawn on top;
+     * cascades without dynamic casters skip even the copy. Casters are culled per cascade on the CPU
+     * and drawn with a depth-only pipeline that fetches positions only.
+     *
+     * The sampled map is binding SHADOW_MAP_BINDING of the global set. render() must be recorded
+     * outside a render pass and before the passes that sample it.
+     */
+    class CascadedShadowMaps
+    {
+    public:
+        // Must match shaders/global.glsl
+        static constexpr uint32_t CASCADE_COUNT = 4;
+        static constexpr uint32_t SHADOW_MAP_BINDING = 3;
+        static constexpr uint32_t RESOLUTION = 2048;
+        // Cascade boxes are padded by and move in steps of this fraction of their size
+        static constexpr float SNAP_FRACTION = 0.125f;
+        // Casters up to this far towards the light from a cascade still shadow it
+        static constexpr float CASTER_DISTANCE = 20.0f;
+        // Blend between uniform (0) and logarithmic (1) split distances
+        static constexpr float SPLIT_LAMBDA = 0.75f;
+
+        struct Cascade
+        {
+            glm::mat4 viewProjection{1.0f};
+            // View depth where the cascade ends
+            float splitDepth = 0.0f;
+        };
+
+        CascadedShadowMaps(Device &device);
+        ~CascadedShadowMaps();
+        CascadedShadowMaps(const CascadedShadowMaps &) = delete;
+        CascadedShadowMaps &operator=(const CascadedShadowMaps &) = delete;
+
+        // Fits the cascades to the camera between near and far and culls the casters into them
+        void update(const Camera &camera, float near, float far, const glm::vec3 &directionToLight, std::vector<GameObject> &gameObjects);
+        // Redraws what update() found out of date, then composites the dynamic casters
+        void render(FrameInfo &frameInfo, std::vector<GameObject> &gameObjects);
+
+        // Static objects were added, removed or moved
+        void invalidateStaticCasters() { staticCastersChanged = true; }
+
+        const std::array<Cascade, CASCADE_COUNT> &getCascades() const { return cascades; }
+        VkDescriptorImageInfo descriptorInfo() const;
+
+    private:
+        struct CascadeState
+        {
+            // Light view space box, extended towards the light by CASTER_DISTANCE
+            glm::vec3 boundsMin{};
+            glm::vec3 boundsMax{};
+            // Matrix the cached static layer was drawn with
+            glm::mat4 cachedViewProjection{0.0f};
+            bool staticOutOfDate = true;
+            // The sampled layer holds exactly the cached static layer
+            bool sampledMatchesStatic = false;
+            std::vector<uint32_t> staticCasters;
+            std::vector<uint32_t> dynamicCasters;
+        };
+
+        void createImages();
+        void createRenderPasses();
+        void createFramebuffers();
+        void createSampler();
+        void createPipelineLayout();
+        void createPipeline();
+
+        void fitCascades(const Camera &camera, float near, float far, const glm::vec3 &directionToLight);
+        void drawCasters(FrameInfo &frameInfo, std::vector<GameObject> &gameObjects, const std::vector<uint32_t> &casters, const glm::mat4 &viewProjection, const char *statisticsName);
+        void beginPass(VkCommandBuffer commandBuffer, VkRenderPass renderPass, VkFramebuffer framebuffer);
+        void transition(VkCommandBuffer commandBuffer, VkImage image, uint32_t layer, VkImageLayout oldLayout, VkImageLayout newLayout,
+                        VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess);
+
+        Device &device;
+        VkFormat depthFormat;
+
+        // One layer per cascade; static holds the cached casters, sampled is what the shaders read
+        VkImage staticImage;
+        VkDeviceMemory staticImageMemory;
+        VkImage sampledImage;
+        VkDeviceMemory sampledImageMemory;
+        std::array<VkImageView, CASCADE_COUNT> staticLayerViews{};
+        std::array<VkImageView, CASCADE_COUNT> sampledLayerViews{};
+        VkImageView sampledArrayView;
+        std::array<VkFramebuffer, CASCADE_COUNT> staticFramebuffers{};
+        std::array<VkFramebuffer, CASCADE_COUNT> sampledFramebuffers{};
+        VkSampler sampler;
+
+        // Compatible passes: clearPass redraws a static layer, loadPass draws dynamic casters on top
+        VkRenderPass clearPass;
+        VkRenderPass loadPass;
+        VkPipelineLayout pipelineLayout;
+        std::unique_ptr<Pipeline> pipeline;
+
+        std::array<Cascade, CASCADE_COUNT> cascades{};
+        std::array<CascadeState, CASCADE_COUNT> states{};
+        glm::mat4 lightView{1.0f};
+        bool staticCastersChanged = true;
+        bool sampledImageInitialized = false;
+        size_t objectCount = 0;
+        // Bounding spheres of the objects in light view space, refreshed for dynamic ones every update
+        std::vector<glm::vec4> casterSpheres;
+    };
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "buffer.hpp"
+#include "device.hpp"
+#include "frame_info.hpp"
+#include "pipeline.hpp"
+
+#define GLM_FORCE_RADIANS
+#define GLM_FORCE_DEPTH_ZERO_TO_ONE
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace YTVK
+{
+    /*
+     * Clustered forward shading for many point lights. The view frustum is split into a grid of
+     * screen tiles and exponential depth slices; each frame a compute pass (shaders/cluster.comp)
+     * tests every light against every cluster's view space bounds and writes the light indices per
+     * cluster, so the fragment shaders only loop over the lights of their own cluster.
+     *
+     * The light and cluster buffers are bindings 1 and 2 of the global set, next to the UBO, and the
+     * cull pass uses that same set. Must be recorded outside a render pass.
+     */
+    class ClusteredLighting
+    {
+    public:
+        // Must match shaders/global.glsl
+        static constexpr uint32_t CLUSTERS_X = 16;
+        static constexpr uint32_t CLUSTERS_Y = 9;
+        static constexpr uint32_t CLUSTERS_Z = 24;
+        static constexpr uint32_t CLUSTER_COUNT = CLUSTERS_X * CLUSTERS_Y * CLUSTERS_Z;
+        static constexpr uint32_t MAX_LIGHTS_PER_CLUSTER = 128;
+        static constexpr uint32_t MAX_LIGHTS = 4096;
+        static constexpr uint32_t LIGHTS_BINDING = 1;
+        static constexpr uint32_t CLUSTERS_BINDING = 2;
+
+        struct PointLight
+        {
+            // World space position, w is the radius past which the light has no effect
+            glm::vec4 positionRadius{};
+            // rgb, w is the intensity
+            glm::vec4 color{1.0f};
+        };
+
+        ClusteredLighting(Device &device, uint32_t framesInFlight, VkDescriptorSetLayout globalSetLayout);
+        ~ClusteredLighting();
+        ClusteredLighting(const ClusteredLighting &) = delete;
+        ClusteredLighting &operator=(const ClusteredLighting &) = delete;
+
+        // Lights past MAX_LIGHTS are dropped; returns the count to put in the UBO
+        uint32_t writeLights(int frameIndex, const std::vector<PointLight> &lights);
+        void cullLights(FrameInfo &frameInfo);
+
+        VkDescriptorBufferInfo lightsDescriptorInfo(int frameIndex) { return lightBuffers[frameIndex]->descriptorInfo(); }
+        VkDescriptorBufferInfo clustersDescriptorInfo(int frameIndex) { return clusterBuffers[frameIndex]->descriptorInfo(); }
+
+    private:
+        void createPipelineLayout(VkDescriptorSetLayout globalSetLayout);
+
+        Device &device;
+        VkPipelineLayout pipelineLayout;
+        std::unique_ptr<ComputePipeline> pipeline;
+        std::vector<std::unique_ptr<Buffer>> lightBuffers;
+        std::vector<std::unique_ptr<Buffer>> clusterBuffers;
+    };
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+namespace YTVK
+{
+    /*
+     * Defers destruction of GPU objects until the device timeline has passed the last submission
+     * that may use them. Work pushed while a frame is being recorded is bound to that frame's
+     * timeline value when the frame is submitted (seal), so callers never need to know the value.
+     */
+    class DeletionQueue
+    {
+    public:
+        DeletionQueue() = default;
+        ~DeletionQueue();
+        DeletionQueue(const DeletionQueue &) = delete;
+        DeletionQueue &operator=(const DeletionQueue &) = delete;
+
+        // Retire once the next sealed submission has completed
+        void push(std::function<void()> destroy);
+        // Retire once a specific timeline value has completed
+        void push(uint64_t timelineValue, std::function<void()> destroy);
+
+        void seal(uint64_t timelineValue);
+        void collect(uint64_t completedTimelineValue);
+        void flush();
+
+        size_t size() const { return pending.size() + retiring.size(); }
+
+    private:
+        struct Retiring
+        {
+            uint64_t timelineValue;
+            std::function<void()> destroy;
+        };
+
+        std::vector<std::function<void()>> pending;
+        std::deque<Retiring> retiring;
+    };
+}
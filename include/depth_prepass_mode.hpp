@@ -0,0 +1,13 @@
+#pragma once
+
+namespace YTVK
+{
+    // Whether RenderSystem lays down depth before shading; lives apart so AppConfig needs no renderer headers
+    enum class DepthPrepassMode
+    {
+        Off,
+        On,
+        // Measures both variants on the GPU every so often and keeps the faster one
+        Auto
+    };
+}
@@ -3,12 +3,15 @@
 #include "device.hpp"
 
 // std
+#include <array>
 #include <memory>
+#include <functional>
 #include <unordered_map>
 #include <vector>
 
 namespace YTVK
 {
+    class DescriptorLayoutCache;
 
     class DescriptorSetLayout
     {
@@ -23,27 +26,78 @@ namespace YTVK
                 VkDescriptorType descriptorType,
                 VkShaderStageFlags stageFlags,
                 uint32_t count = 1);
+            // Sets are pushed into command buffers (PushDescriptorWriter) when the device supports it
+            Builder &setPushDescriptor();
             std::unique_ptr<DescriptorSetLayout> build() const;
+            // Shares one VkDescriptorSetLayout between every builder with the same bindings
+            std::shared_ptr<DescriptorSetLayout> build(DescriptorLayoutCache &cache) const;
 
         private:
             Device &device;
             std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings{};
+            VkDescriptorSetLayoutCreateFlags flags = 0;
         };
 
         DescriptorSetLayout(
-            Device &device, std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings);
+            Device &device,
+            std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings,
+            VkDescriptorSetLayoutCreateFlags flags = 0);
         ~DescriptorSetLayout();
         DescriptorSetLayout(const DescriptorSetLayout &) = delete;
         DescriptorSetLayout &operator=(const DescriptorSetLayout &) = delete;
 
         VkDescriptorSetLayout getDescriptorSetLayout() const { return descriptorSetLayout; }
+        bool isPushDescriptor() const { return (flags & VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR) != 0; }
 
     private:
         Device &device;
         VkDescriptorSetLayout descriptorSetLayout;
         std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings;
+        VkDescriptorSetLayoutCreateFlags flags;
 
         friend class DescriptorWriter;
+        friend class PushDescriptorWriter;
+    };
+
+    class DescriptorLayoutCache
+    {
+    public:
+        explicit DescriptorLayoutCache(Device &device) : device{device} {}
+        DescriptorLayoutCache(const DescriptorLayoutCache &) = delete;
+        DescriptorLayoutCache &operator=(const DescriptorLayoutCache &) = delete;
+
+        std::shared_ptr<DescriptorSetLayout> getLayout(
+            const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> &bindings,
+            VkDescriptorSetLayoutCreateFlags flags = 0);
+
+        size_t size() const { return layouts.size(); }
+
+    private:
+        struct Binding
+        {
+            uint32_t binding;
+            VkDescriptorType descriptorType;
+            uint32_t descriptorCount;
+            VkShaderStageFlags stageFlags;
+
+            bool operator==(const Binding &other) const;
+        };
+
+        struct Key
+        {
+            VkDescriptorSetLayoutCreateFlags flags = 0;
+            std::vector<Binding> bindings;
+
+            bool operator==(const Key &other) const { return flags == other.flags && bindings == other.bindings; }
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const Key &key) const;
+        };
+
+        Device &device;
+        std::unordered_map<Key, std::shared_ptr<DescriptorSetLayout>, KeyHash> layouts;
     };
 
     class DescriptorPool
@@ -89,21 +143,198 @@ namespace YTVK
         friend class DescriptorWriter;
     };
 
+    /*
+     * Chains descriptor pools so allocation never runs dry. Static sets live as long as the
+     * allocator; transient sets come from per-frame pools that are reset wholesale by beginFrame
+     * once that frame slot has retired, which makes per-draw sets cheap.
+     */
+    class DescriptorAllocator
+    {
+    public:
+        enum class Lifetime
+        {
+            Static,
+            Frame
+        };
+
+        class Builder
+        {
+        public:
+            Builder(Device &device) : device{device} {}
+
+            // Descriptors of this type reserved per set in each pool
+            Builder &addPoolSize(VkDescriptorType descriptorType, float descriptorsPerSet);
+            Builder &setSetsPerPool(uint32_t count);
+            Builder &setFramesInFlight(uint32_t count);
+            std::unique_ptr<DescriptorAllocator> build() const;
+
+        private:
+            Device &device;
+            std::vector<std::pair<VkDescriptorType, float>> poolSizes{};
+            uint32_t setsPerPool = 64;
+            uint32_t framesInFlight = 1;
+        };
+
+        // Pools double in size as a chain grows, up to this many sets
+        static constexpr uint32_t MAX_SETS_PER_POOL = 4096;
+
+        DescriptorAllocator(
+            Device &device,
+            uint32_t setsPerPool,
+            uint32_t framesInFlight,
+            const std::vector<std::pair<VkDescriptorType, float>> &poolSizes);
+        ~DescriptorAllocator();
+        DescriptorAllocator(const DescriptorAllocator &) = delete;
+        DescriptorAllocator &operator=(const DescriptorAllocator &) = delete;
+
+        // Call after the frame slot has been acquired; frees every transient set it handed out before
+        void beginFrame(uint32_t frameIndex);
+
+        bool allocate(VkDescriptorSetLayout descriptorSetLayout, VkDescriptorSet &descriptor, Lifetime lifetime = Lifetime::Static);
+
+        size_t poolCount() const;
+
+    private:
+        struct PoolChain
+        {
+            std::vector<VkDescriptorPool> pools;
+            size_t current = 0;
+        };
+
+        VkDescriptorPool createPool(uint32_t maxSets);
+        bool allocateFromChain(PoolChain &chain, VkDescriptorSetLayout descriptorSetLayout, VkDescriptorSet &descriptor);
+
+        Device &device;
+        uint32_t setsPerPool;
+        std::vector<std::pair<VkDescriptorType, float>> poolSizes;
+
+        PoolChain staticChain;
+        std::vector<PoolChain> frameChains;
+        uint32_t currentFrameIndex = 0;
+    };
+
+    class DescriptorWriter;
+
+    /*
+     * Reuses descriptor sets whose layout and written resources (handles, offsets, ranges, image
+     * layouts) match a set built before, skipping both the allocation and vkUpdateDescriptorSets.
+     * Sets referencing a destroyed resource are dropped and recycled once the GPU is done with them.
+     */
+    class DescriptorSetCache
+    {
+    public:
+        DescriptorSetCache(Device &device, DescriptorAllocator &allocator);
+        ~DescriptorSetCache();
+        DescriptorSetCache(const DescriptorSetCache &) = delete;
+        DescriptorSetCache &operator=(const DescriptorSetCache &) = delete;
+
+        void invalidate(uint64_t resourceHandle);
+
+        size_t size() const { return sets.size(); }
+        uint64_t getHits() const { return hits; }
+        uint64_t getMisses() const { return misses; }
+
+    private:
+        struct Resource
+        {
+            uint32_t binding;
+            uint32_t arrayElement;
+            VkDescriptorType descriptorType;
+            uint64_t handle;
+            uint64_t sampler;
+            VkDeviceSize offset;
+            VkDeviceSize range;
+            VkImageLayout imageLayout;
+
+            bool operator==(const Resource &other) const;
+        };
+
+        struct Key
+        {
+            VkDescriptorSetLayout layout = VK_NULL_HANDLE;
+            std::vector<Resource> resources;
+
+            bool operator==(const Key &other) const { return layout == other.layout && resources == other.resources; }
+        };
+
+        struct KeyHash
+        {
+            size_t operator()(const Key &key) const;
+        };
+
+        using RecycledSets = std::unordered_map<VkDescriptorSetLayout, std::vector<VkDescriptorSet>>;
+
+        bool find(VkDescriptorSetLayout layout, const std::vector<VkWriteDescriptorSet> &writes, VkDescriptorSet &set);
+        bool acquire(VkDescriptorSetLayout layout, VkDescriptorSet &set);
+        void insert(VkDescriptorSet set);
+
+        Device &device;
+        DescriptorAllocator &allocator;
+        uint32_t listenerId;
+
+        // Rebuilt by every find() so cache hits do not allocate
+        Key lookupKey;
+        std::unordered_map<Key, VkDescriptorSet, KeyHash> sets;
+        // Shared with deletion queue callbacks, which may run after the cache is gone
+        std::shared_ptr<RecycledSets> recycled;
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+
+        friend class DescriptorWriter;
+    };
+
     class DescriptorWriter
     {
     public:
         DescriptorWriter(DescriptorSetLayout &setLayout, DescriptorPool &pool);
+        DescriptorWriter(
+            DescriptorSetLayout &setLayout,
+            DescriptorAllocator &allocator,
+            DescriptorAllocator::Lifetime lifetime = DescriptorAllocator::Lifetime::Static);
 
         DescriptorWriter &writeBuffer(uint32_t binding, VkDescriptorBufferInfo *bufferInfo);
         DescriptorWriter &writeImage(uint32_t binding, VkDescriptorImageInfo *imageInfo);
 
         bool build(VkDescriptorSet &set);
+        // Returns the cached set when the same resources were written with this layout before
+        bool build(VkDescriptorSet &set, DescriptorSetCache &cache);
         void overwrite(VkDescriptorSet &set);
 
     private:
         DescriptorSetLayout &setLayout;
-        DescriptorPool &pool;
+        DescriptorPool *pool = nullptr;
+        DescriptorAllocator *allocator = nullptr;
+        DescriptorAllocator::Lifetime lifetime = DescriptorAllocator::Lifetime::Static;
         std::vector<VkWriteDescriptorSet> writes;
     };
 
+    /*
+     * Short-lived per-draw bindings, e.g. RenderSystem's object textures without a BindlessSet. With
+     * VK_KHR_push_descriptor and a layout built with setPushDescriptor() the writes go straight into
+     * the command buffer; otherwise a Lifetime::Frame set is allocated, written and bound. Writes are
+     * kept inline, so neither path touches the heap.
+     */
+    class PushDescriptorWriter
+    {
+    public:
+        static constexpr uint32_t MAX_WRITES = 8;
+
+        PushDescriptorWriter(DescriptorSetLayout &setLayout, DescriptorAllocator &allocator);
+
+        // The infos must stay alive until push()
+        PushDescriptorWriter &writeBuffer(uint32_t binding, VkDescriptorBufferInfo *bufferInfo);
+        PushDescriptorWriter &writeImage(uint32_t binding, VkDescriptorImageInfo *imageInfo);
+
+        // Binds the writes as set `set` of pipelineLayout; false if the fallback set could not be allocated
+        bool push(VkCommandBuffer commandBuffer, VkPipelineBindPoint bindPoint, VkPipelineLayout pipelineLayout, uint32_t set);
+
+    private:
+        VkWriteDescriptorSet &addWrite(uint32_t binding);
+
+        DescriptorSetLayout &setLayout;
+        DescriptorAllocator &allocator;
+        std::array<VkWriteDescriptorSet, MAX_WRITES> writes{};
+        uint32_t writeCount = 0;
+    };
+
 } // namespace lve
\ No newline at end of file
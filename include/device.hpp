@@ -1,7 +1,13 @@
 #pragma once
 
 #include "window.hpp"
+#include "deletion_queue.hpp"
+#include "memory_tracker.hpp"
+
+#include <cstring>
+#include <functional>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace YTVK
@@ -32,7 +38,8 @@ namespace YTVK
     const bool enableValidationLayers = true;
 #endif
 
-    Device(Window &window);
+    // A null window creates a headless device: no surface, no swap chain extension and no GLFW
+    explicit Device(Window *window);
     ~Device();
 
     // Not copyable or movable
@@ -46,12 +53,63 @@ namespace YTVK
     VkSurfaceKHR surface() { return surface_; }
     VkQueue graphicsQueue() { return graphicsQueue_; }
     VkQueue presentQueue() { return presentQueue_; }
+    bool isHeadless() const { return window == nullptr; }
+    // Optional feature, enabled at creation when the physical device has it
+    bool supportsPipelineStatistics() const { return pipelineStatisticsQuery_; }
+    // Descriptor indexing with partially bound, update-after-bind arrays (see BindlessSet)
+    bool supportsBindless() const { return bindless_; }
+    // VK_EXT_swapchain_maintenance1: presents can signal a fence, see SwapChain::presentsComplete
+    bool supportsPresentFences() const { return presentFences_; }
+    // VK_KHR_push_descriptor, see PushDescriptorWriter
+    bool supportsPushDescriptors() const { return cmdPushDescriptorSet_ != nullptr; }
+    void cmdPushDescriptorSet(
+        VkCommandBuffer commandBuffer,
+        VkPipelineBindPoint bindPoint,
+        VkPipelineLayout layout,
+        uint32_t set,
+        uint32_t writeCount,
+        const VkWriteDescriptorSet *writes)
+    {
+      cmdPushDescriptorSet_(commandBuffer, bindPoint, layout, set, writeCount, writes);
+    }
+
+    // Single timeline semaphore shared by every queue submission. Each submit signals a new,
+    // strictly increasing value, so "has submission N finished?" is a counter comparison.
+    VkSemaphore timelineSemaphore() { return timelineSemaphore_; }
+    uint64_t nextTimelineValue() { return ++timelineValue_; }
+    uint64_t lastTimelineValue() const { return timelineValue_; }
+    uint64_t completedTimelineValue();
+    bool isTimelineValueComplete(uint64_t value);
+    void waitForTimelineValue(uint64_t value);
+
+    // Objects handed to this queue are destroyed once the timeline passes their last use
+    DeletionQueue &deletionQueue() { return deletionQueue_; }
+
+    // Caches that hold raw handles (descriptor sets, ...) listen for resources being destroyed
+    using ResourceListener = std::function<void(uint64_t handle)>;
+    uint32_t addResourceListener(ResourceListener listener);
+    void removeResourceListener(uint32_t id);
+    void notifyResourceDestroyed(uint64_t handle);
+
+    // Non-dispatchable handles are pointers on 64-bit builds and uint64_t elsewhere
+    template <typename T>
+    static uint64_t handleKey(T handle)
+    {
+      uint64_t key = 0;
+      std::memcpy(&key, &handle, sizeof(handle));
+      return key;
+    }
+
+    // Every allocation made by createBuffer/createImageWithInfo is booked here; release it with freeMemory
+    MemoryTracker &memoryTracker() { return memoryTracker_; }
+    MemoryReport memoryReport() { return memoryTracker_.report(); }
 
     SwapChainSupportDetails getSwapChainSupport() { return querySwapChainSupport(physicalDevice); }
     uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
     QueueFamilyIndices findPhysicalQueueFamilies() { return findQueueFamilies(physicalDevice); }
     VkFormat findSupportedFormat(
         const std::vector<VkFormat> &candidates, VkImageTiling tiling, VkFormatFeatureFlags features);
+    VkFormatProperties getFormatProperties(VkFormat format);
 
     // Buffer Helper Functions
     void createBuffer(
@@ -62,6 +120,8 @@ namespace YTVK
         VkDeviceMemory &bufferMemory);
     VkCommandBuffer beginSingleTimeCommands();
     void endSingleTimeCommands(VkCommandBuffer commandBuffer);
+    // Like endSingleTimeCommands without the wait; returns the timeline value that marks completion
+    uint64_t submitSingleTimeCommands(VkCommandBuffer commandBuffer);
     void copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
     void copyBufferToImage(
         VkBuffer buffer, VkImage image, uint32_t width, uint32_t height, uint32_t layerCount);
@@ -72,7 +132,10 @@ namespace YTVK
         VkImage &image,
         VkDeviceMemory &imageMemory);
 
+    void freeMemory(VkDeviceMemory memory);
+
     VkPhysicalDeviceProperties properties;
+    VkPhysicalDeviceVulkan12Properties vulkan12Properties{};
 
   private:
     void createInstance();
@@ -81,6 +144,9 @@ namespace YTVK
     void pickPhysicalDevice();
     void createLogicalDevice();
     void createCommandPool();
+    void createTimelineSemaphore();
+    // Ends, submits and signals the next timeline value
+    uint64_t submitCommands(VkCommandBuffer commandBuffer);
 
     // helper functions
     bool isDeviceSuitable(VkPhysicalDevice device);
@@ -90,20 +156,35 @@ namespace YTVK
     void populateDebugMessengerCreateInfo(VkDebugUtilsMessengerCreateInfoEXT &createInfo);
     void hasGflwRequiredInstanceExtensions();
     bool checkDeviceExtensionSupport(VkPhysicalDevice device);
+    bool checkOptionalDeviceExtension(VkPhysicalDevice device, const char *name);
+    bool checkOptionalInstanceExtension(const char *name);
     SwapChainSupportDetails querySwapChainSupport(VkPhysicalDevice device);
 
     VkInstance instance;
     VkDebugUtilsMessengerEXT debugMessenger;
     VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
-    Window &window;
+    Window *window;
     VkCommandPool commandPool;
 
     VkDevice device_;
-    VkSurfaceKHR surface_;
+    VkSurfaceKHR surface_ = VK_NULL_HANDLE;
     VkQueue graphicsQueue_;
     VkQueue presentQueue_;
+    VkSemaphore timelineSemaphore_ = VK_NULL_HANDLE;
+    uint64_t timelineValue_ = 0;
+    uint64_t completedTimelineValue_ = 0;
+    DeletionQueue deletionQueue_;
+    MemoryTracker memoryTracker_;
+    std::vector<std::pair<uint32_t, ResourceListener>> resourceListeners_;
+    uint32_t nextResourceListenerId_ = 0;
+    bool pipelineStatisticsQuery_ = false;
+    bool bindless_ = false;
+    // Instance side of the present fences, VK_EXT_surface_maintenance1
+    bool surfaceMaintenance_ = false;
+    bool presentFences_ = false;
+    PFN_vkCmdPushDescriptorSetKHR cmdPushDescriptorSet_ = nullptr;
 
     const std::vector<const char *> validationLayers = {"VK_LAYER_KHRONOS_validation"};
-    const std::vector<const char *> deviceExtensions = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
+    std::vector<const char *> deviceExtensions;
   };
 };
\ No newline at end of file
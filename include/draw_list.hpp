@@ -0,0 +1,72 @@
+#pragma once
+
+#include "thread_pool.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace YTVK
+{
+    /*
+     * The draws of a frame, ordered by a 64-bit state key so that recording them changes state as
+     * rarely as possible. Opaque keys hold, from the top bit down: 0, pipeline, model, material and
+     * view depth, so draws group by state and run front to back within a group. Translucent keys
+     * start with 1 and the inverted view depth, so they come after every opaque draw, back to front.
+     *
+     * sort() is an LSD radix sort over 8-bit digits that skips digits shared by every key. Large
+     * lists are split across a ThreadPool, each worker histogramming and scattering its own chunk.
+     */
+    class DrawList
+    {
+    public:
+        static constexpr uint32_t PIPELINE_BITS = 7;
+        static constexpr uint32_t MODEL_BITS = 16;
+        static constexpr uint32_t MATERIAL_BITS = 16;
+        static constexpr uint32_t DEPTH_BITS = 24;
+        // Lists shorter than this per worker are not worth waking another thread for
+        static constexpr size_t MIN_DRAWS_PER_THREAD = 8192;
+        static constexpr uint32_t MAX_THREADS = 8;
+
+        struct Draw
+        {
+            uint64_t key;
+            uint32_t objectIndex;
+        };
+
+        // Fields wider than their bits are truncated, which only costs grouping, never correctness
+        static uint64_t opaqueKey(uint32_t pipeline, uint32_t model, uint32_t material, float viewDepth);
+        static uint64_t translucentKey(uint32_t pipeline, uint32_t model, uint32_t material, float viewDepth);
+
+        explicit DrawList(uint32_t threadCount = MAX_THREADS);
+        DrawList(const DrawList &) = delete;
+        DrawList &operator=(const DrawList &) = delete;
+
+        // Keeps the capacity, so a list refilled every frame stops allocating once warmed up
+        void clear() { draws.clear(); }
+        void add(uint64_t key, uint32_t objectIndex) { draws.push_back({key, objectIndex}); }
+        void sort();
+
+        const std::vector<Draw> &getDraws() const { return draws; }
+
+    private:
+        using Histogram = std::array<uint32_t, 256>;
+
+        void sortChunks(size_t firstChunk, size_t lastChunk);
+
+        ThreadPool pool;
+        std::vector<Draw> draws;
+        std::vector<Draw> scratch;
+
+        // State of the current sort, shared with the workers
+        size_t chunkCount = 0;
+        size_t chunkSize = 0;
+        uint32_t step = 0;
+        uint32_t shift = 0;
+        Draw *source = nullptr;
+        Draw *destination = nullptr;
+        std::vector<uint64_t> chunkDifferences;
+        std::vector<Histogram> chunkOffsets;
+    };
+}
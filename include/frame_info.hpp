@@ -1,6 +1,9 @@
 #pragma once
 
 #include "camera.hpp"
+#include "descriptors.hpp"
+#include "gpu_profiler.hpp"
+#include "pipeline_statistics.hpp"
 
 #include <vulkan/vulkan.h>
 
@@ -13,6 +16,9 @@ namespace YTVK
         VkCommandBuffer commandBuffer;
         Camera &camera;
         VkDescriptorSet globalDescriptorSet;
-
+        GpuProfiler &profiler;
+        PipelineStatistics &pipelineStatistics;
+        // Lifetime::Frame sets are valid until this frame slot comes around again
+        DescriptorAllocator &descriptorAllocator;
     };
 }
\ No newline at end of file
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+namespace YTVK
+{
+    // Per-frame timings in milliseconds, filled in by Renderer
+    struct FrameStats
+    {
+        uint64_t frameNumber = 0;
+        // Time blocked in beginFrame waiting for a free frame slot and swap chain image
+        float cpuWaitMs = 0.0f;
+        // CPU time from the start of acquire until vkQueuePresentKHR returned
+        float acquireToPresentMs = 0.0f;
+        // GpuProfiler's whole-frame scope. Results are read back when a frame slot is reused, so this
+        // belongs to the earlier frame gpuFrameNumber; negative if no new result was available
+        float gpuTimeMs = -1.0f;
+        uint64_t gpuFrameNumber = 0;
+    };
+}
@@ -30,6 +30,10 @@ namespace YTVK
         std::shared_ptr<Model> model{};
         glm::vec3 color{};
         TransformComponent transform{};
+        // Index into the BindlessSet texture table (RenderSystem's textures without one), ~0u for vertex colors only
+        uint32_t textureIndex = ~0u;
+        // Never moves after loading; static objects are cached in the shadow cascades
+        bool isStatic = true;
 
         id_t getId() { return id; }
 
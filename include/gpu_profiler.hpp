@@ -0,0 +1,94 @@
+#pragma once
+
+#include "device.hpp"
+
+#include <cstdint>
+#include <array>
+#include <vector>
+
+namespace YTVK
+{
+    /*
+     * Timestamp queries grouped into named scopes, one query range per frame in flight. Results of
+     * a frame slot are read back without waiting the next time that slot begins, once its timeline
+     * value has been reached, so they trail the current frame by framesInFlight frames.
+     *
+     * Scope names must outlive the profiler (string literals).
+     */
+    class GpuProfiler
+    {
+    public:
+        static constexpr uint32_t MAX_SCOPES_PER_FRAME = 64;
+
+        struct Result
+        {
+            const char *name;
+            uint32_t depth;
+            float milliseconds;
+        };
+
+        class Scope
+        {
+        public:
+            Scope(GpuProfiler &profiler, VkCommandBuffer commandBuffer, const char *name);
+            ~Scope();
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            GpuProfiler &profiler;
+            VkCommandBuffer commandBuffer;
+            uint32_t index;
+        };
+
+        GpuProfiler(Device &device, uint32_t framesInFlight);
+        ~GpuProfiler();
+        GpuProfiler(const GpuProfiler &) = delete;
+        GpuProfiler &operator=(const GpuProfiler &) = delete;
+
+        // Without timestampComputeAndGraphics every call is a no-op and no results are produced
+        bool isEnabled() const { return queryPool != VK_NULL_HANDLE; }
+
+        // Right after vkBeginCommandBuffer: collects the slot's previous results and resets its queries
+        void beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+        // After submission, with the timeline value that submission signals
+        void endFrame(uint64_t timelineValue);
+
+        // For scopes that cannot be expressed as a C++ scope (e.g. split across begin/end calls)
+        uint32_t beginScope(VkCommandBuffer commandBuffer, const char *name);
+        void endScope(VkCommandBuffer commandBuffer, uint32_t index);
+
+        // Most recently completed frame, in the order the scopes were opened
+        const std::vector<Result> &getResults() const { return results; }
+        uint64_t getResultsFrameNumber() const { return resultsFrameNumber; }
+
+    private:
+        static constexpr uint32_t INVALID_SCOPE = ~0u;
+
+        struct FrameQueries
+        {
+            std::vector<const char *> names;
+            std::vector<uint32_t> depths;
+            uint64_t timelineValue = 0;
+            uint64_t frameNumber = 0;
+            bool submitted = false;
+        };
+
+        void collect(FrameQueries &frame, uint32_t frameIndex);
+        uint32_t firstQuery(uint32_t frameIndex) const { return frameIndex * MAX_SCOPES_PER_FRAME * 2; }
+
+        Device &device;
+        VkQueryPool queryPool = VK_NULL_HANDLE;
+        float timestampPeriod = 1.0f;
+
+        std::vector<FrameQueries> frames;
+        uint32_t currentFrameIndex = 0;
+        uint32_t currentDepth = 0;
+        uint64_t frameNumber = 0;
+
+        // Begin/end timestamp plus availability word each, for one frame
+        std::array<uint64_t, MAX_SCOPES_PER_FRAME * 4> queryData{};
+        std::vector<Result> results;
+        uint64_t resultsFrameNumber = 0;
+    };
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+namespace YTVK
+{
+    enum class MemoryCategory
+    {
+        Vertex,
+        Index,
+        Uniform,
+        Depth,
+        Staging,
+        Texture,
+        RenderTarget,
+        Other,
+        Count
+    };
+
+    const char *memoryCategoryName(MemoryCategory category);
+
+    struct MemoryUsage
+    {
+        VkDeviceSize bytes = 0;
+        uint32_t allocations = 0;
+    };
+
+    struct MemoryHeapReport
+    {
+        VkDeviceSize size = 0;
+        VkMemoryHeapFlags flags = 0;
+        // What this engine instance allocated through Device
+        MemoryUsage tracked{};
+        // From VK_EXT_memory_budget, zero when the extension is missing
+        VkDeviceSize driverUsage = 0;
+        VkDeviceSize driverBudget = 0;
+
+        // The driver's usage also covers swap chain images, pools and pipelines, so it may exceed what
+        // is tracked by this much; beyond it, or below the tracked total, an allocation went unbooked
+        static constexpr VkDeviceSize UNTRACKED_SLACK = 256 * 1024 * 1024;
+        bool divergesFromDriver() const;
+    };
+
+    struct MemoryReport
+    {
+        std::vector<MemoryHeapReport> heaps;
+        std::array<MemoryUsage, static_cast<size_t>(MemoryCategory::Count)> categories{};
+        bool hasDriverBudget = false;
+        // Sum over device local heaps, and the per-instance cap on it (0 is unlimited)
+        VkDeviceSize deviceLocalBytes = 0;
+        VkDeviceSize deviceLocalLimit = 0;
+
+        void print(std::ostream &out) const;
+    };
+
+    // Thrown by Device when an allocation would go over MemoryTracker's device local limit
+    class MemoryBudgetExceeded : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    // Books every VkDeviceMemory allocated through Device by heap and category. Device reserves the
+    // size against the per-instance limit before allocating, so several engines can share a GPU
+    // within fixed budgets and concurrent allocations cannot overshoot it together.
+    class MemoryTracker
+    {
+    public:
+        void init(VkPhysicalDevice physicalDevice, bool hasMemoryBudget);
+
+        static MemoryCategory categorize(VkBufferUsageFlags usage, VkMemoryPropertyFlags properties);
+        static MemoryCategory categorize(VkImageUsageFlags usage);
+
+        void setDeviceLocalLimit(VkDeviceSize bytes) { deviceLocalLimit = bytes; }
+        VkDeviceSize getDeviceLocalLimit() const { return deviceLocalLimit; }
+        // What may still be allocated from device local heaps before the limit, unlimited without one
+        VkDeviceSize getDeviceLocalHeadroom();
+        // False if the size does not fit under the limit. A reservation is either turned into an
+        // allocation by track() or handed back with release() when vkAllocateMemory fails
+        bool tryReserve(VkDeviceSize size, uint32_t memoryTypeIndex);
+        void release(VkDeviceSize size, uint32_t memoryTypeIndex);
+
+        void track(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryTypeIndex, MemoryCategory category);
+        void untrack(VkDeviceMemory memory);
+
+        MemoryReport report();
+
+    private:
+        struct Allocation
+        {
+            VkDeviceSize size;
+            uint32_t heapIndex;
+            MemoryCategory category;
+        };
+
+        bool isDeviceLocal(uint32_t heapIndex) const;
+        VkDeviceSize deviceLocalBytes() const;
+
+        VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+        VkPhysicalDeviceMemoryProperties memoryProperties{};
+        bool hasMemoryBudget = false;
+        VkDeviceSize deviceLocalLimit = 0;
+
+        std::mutex mutex;
+        std::unordered_map<VkDeviceMemory, Allocation> allocations;
+        std::array<MemoryUsage, VK_MAX_MEMORY_HEAPS> heaps{};
+        std::array<VkDeviceSize, VK_MAX_MEMORY_HEAPS> reservedBytes{};
+        std::array<MemoryUsage, static_cast<size_t>(MemoryCategory::Count)> categories{};
+    };
+}
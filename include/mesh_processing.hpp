@@ -0,0 +1,71 @@
+#pragma once
+
+#include "model.hpp"
+#include "asset_archive.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace YTVK
+{
+    // Offline mesh optimization passes, run by ytvk-cook rather than at load time
+    void deduplicateVertices(Model::Builder &builder);
+    void optimizeVertexCache(Model::Builder &builder, uint32_t cacheSize = 32);
+    void optimizeVertexFetch(Model::Builder &builder);
+    Model::Builder generateLod(const Model::Builder &builder, uint32_t gridResolution);
+
+    // Average cache miss ratio (transformed vertices per triangle) of a FIFO post-transform cache
+    float averageCacheMissRatio(const Model::Builder &builder, uint32_t cacheSize = 32);
+
+    /*
+     * Binary mesh artifact written by ytvk-cook. Vertices are stored quantized (positions and uvs
+     * as 16-bit unorm within the mesh bounds, colors as unorm8, normals as snorm8) and indices are
+     * narrowed to 16 bits when possible; everything is expanded back to Model::Vertex on load.
+     */
+    struct CookedMesh
+    {
+        static constexpr uint32_t MAGIC = 0x4D565459; // "YTVM"
+        static constexpr uint32_t VERSION = 1;
+
+        struct Header
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t sourceHash;
+            uint32_t lodCount;
+            uint32_t reserved;
+            float positionMin[3];
+            float positionExtent[3];
+            float uvMin[2];
+            float uvExtent[2];
+        };
+
+        struct LodHeader
+        {
+            uint32_t vertexCount;
+            uint32_t indexCount;
+            uint32_t indexSize;
+            uint32_t reserved;
+            uint64_t vertexOffset;
+            uint64_t indexOffset;
+        };
+
+        struct PackedVertex
+        {
+            uint16_t position[4];
+            uint16_t uv[2];
+            uint8_t color[4];
+            int8_t normal[4];
+        };
+
+        uint64_t sourceHash = 0;
+        std::vector<Model::Builder> lods{};
+
+        void write(const std::string &path) const;
+        static Model::Builder read(AssetView data, uint32_t lod);
+
+        // Returns 0 if the artifact is missing or unreadable, so callers can treat it as stale
+        static uint64_t readSourceHash(const std::string &path);
+    };
+}
@@ -2,13 +2,17 @@
 
 #include "device.hpp"
 #include "buffer.hpp"
+#include "utils.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/hash.hpp>
 
 #include <vector>
 #include <memory>
+#include <unordered_map>
 
 namespace YTVK
 {
@@ -24,6 +28,9 @@ namespace YTVK
 
             static std::vector<VkVertexInputBindingDescription> getBindDescriptions();
             static std::vector<VkVertexInputAttributeDescription> getAtributeDescriptions();
+            // Position-only stream for depth-only passes, see Model::bindPositions
+            static std::vector<VkVertexInputBindingDescription> getPositionBindDescriptions();
+            static std::vector<VkVertexInputAttributeDescription> getPositionAttributeDescriptions();
 
             bool operator==(const Vertex &) const;
         };
@@ -34,6 +41,10 @@ namespace YTVK
             std::vector<uint32_t> indices{};
 
             void loadModel(const std::string &);
+            void loadCookedMesh(const std::string &, uint32_t lod = 0);
+
+            // Indexes vertex, appending it only if no equal vertex went through uniqueVertices before
+            void addVertex(const Vertex &vertex, std::unordered_map<Vertex, uint32_t> &uniqueVertices);
         };
 
         Model(Device &, const Model::Builder &);
@@ -42,21 +53,49 @@ namespace YTVK
         Model &operator=(const Model &) = delete;
 
         void bind(VkCommandBuffer);
+        // Binds the tightly packed positions instead of the full vertices; draw() works with either
+        void bindPositions(VkCommandBuffer);
         void draw(VkCommandBuffer);
 
+        // Bounding sphere in model space
+        const glm::vec3 &getBoundsCenter() const { return boundsCenter; }
+        float getBoundsRadius() const { return boundsRadius; }
+        // Small number unique per model (until it wraps), for grouping draws by model
+        uint32_t getSortId() const { return sortId; }
+
         static std::unique_ptr<Model> createModelFromFile(Device&, const std::string &);
 
     private:
         Device &device;
+        uint32_t sortId;
 
         std::unique_ptr<Buffer> vertexBuffer;
+        std::unique_ptr<Buffer> positionBuffer;
         uint32_t vertexCount;
+        glm::vec3 boundsCenter{};
+        float boundsRadius = 0.0f;
 
         bool hasIndexBuffer;
         std::unique_ptr<Buffer> indexBuffer;
         uint32_t indexCount;
 
         void createVertexBuffers(const std::vector<Vertex> &);
+        void createPositionBuffer(const std::vector<Vertex> &);
+        void computeBounds(const std::vector<Vertex> &);
         void createIndexBuffers(const std::vector<uint32_t> &);
     };
+}
+
+namespace std
+{
+    template <>
+    struct hash<YTVK::Model::Vertex>
+    {
+        size_t operator()(YTVK::Model::Vertex const &vertex) const
+        {
+            size_t seed = 0;
+            YTVK::hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
+            return seed;
+        }
+    };
 }
\ No newline at end of file
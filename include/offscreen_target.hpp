@@ -0,0 +1,62 @@
+#pragma once
+
+#include "device.hpp"
+#include "render_target.hpp"
+
+#include <string>
+#include <vector>
+
+namespace YTVK
+{
+    /*
+     * Headless stand-in for SwapChain: one color/depth image pair per frame slot, rendered without a
+     * surface and left in TRANSFER_SRC layout so results can be read back.
+     */
+    class OffscreenTarget : public RenderTarget
+    {
+    public:
+        static constexpr VkFormat COLOR_FORMAT = VK_FORMAT_R8G8B8A8_SRGB;
+
+        OffscreenTarget(Device &device, VkExtent2D extent, uint32_t framesInFlight);
+        ~OffscreenTarget();
+        OffscreenTarget(const OffscreenTarget &) = delete;
+        OffscreenTarget &operator=(const OffscreenTarget &) = delete;
+
+        VkRenderPass getRenderPass() override { return renderPass; }
+        VkFramebuffer getFrameBuffer(int index) override { return framebuffers[index]; }
+        VkExtent2D getExtent() override { return extent; }
+        uint32_t framesInFlight() const override { return static_cast<uint32_t>(frameTimelineValues.size()); }
+
+        // Hands out the image of the current frame slot once its previous submission has finished
+        VkResult acquireNextImage(uint32_t *imageIndex) override;
+        VkResult submitCommandBuffers(const VkCommandBuffer *buffers, uint32_t *imageIndex) override;
+
+        uint64_t getFrameTimelineValue(size_t frameIndex) const override { return frameTimelineValues[frameIndex]; }
+
+        // Waits for the image's last submission and returns tightly packed RGBA8 pixels
+        std::vector<uint8_t> readPixels(uint32_t imageIndex);
+        // Writes the image as a binary PPM
+        void saveImage(uint32_t imageIndex, const std::string &path);
+
+    private:
+        void createRenderPass();
+        void createImages();
+        void createFramebuffers();
+
+        Device &device;
+        VkExtent2D extent;
+        VkFormat depthFormat;
+        VkRenderPass renderPass = VK_NULL_HANDLE;
+
+        std::vector<VkImage> colorImages;
+        std::vector<VkDeviceMemory> colorImageMemorys;
+        std::vector<VkImageView> colorImageViews;
+        std::vector<VkImage> depthImages;
+        std::vector<VkDeviceMemory> depthImageMemorys;
+        std::vector<VkImageView> depthImageViews;
+        std::vector<VkFramebuffer> framebuffers;
+
+        std::vector<uint64_t> frameTimelineValues;
+        size_t currentFrame = 0;
+    };
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include "device.hpp"
+#include "asset_archive.hpp"
 #include <string>
 #include <vector>
 
@@ -16,6 +17,9 @@ namespace YTVK
         VkPipelineDepthStencilStateCreateInfo depthStencilInfo;
         VkPipelineDynamicStateCreateInfo dynamicStateInfo;
         std::vector<VkDynamicState> dynamicStateEnables;
+        // Model::Vertex by default; depth-only passes use the position stream
+        std::vector<VkVertexInputBindingDescription> bindingDescriptions{};
+        std::vector<VkVertexInputAttributeDescription> attributeDescriptions{};
         VkPipelineLayout pipelineLayout = nullptr;
         VkRenderPass renderPass = nullptr;
         uint32_t subpass = 0;
@@ -24,6 +28,7 @@ namespace YTVK
     class Pipeline
     {
     public:
+        // An empty fragFilePath creates a depth-only pipeline without a fragment stage
         Pipeline(
             Device &device,
             const PipelineConfigInfo &configInfo,
@@ -44,13 +49,26 @@ namespace YTVK
         VkShaderModule vertexShader;
         VkShaderModule fragmentShader;
 
-        static std::vector<char> readFile(const std::string &filePath);
-
         void createGraphicsPipeline(
             const std::string &vertFilePath,
             const std::string &fragFilePath,
             const PipelineConfigInfo &configInfo);
 
-        void createShaderModule(const std::vector<char> &code, VkShaderModule *shaderModule);
+        void createShaderModule(AssetView code, VkShaderModule *shaderModule);
+    };
+
+    class ComputePipeline
+    {
+    public:
+        ComputePipeline(Device &device, VkPipelineLayout pipelineLayout, const std::string &compFilePath);
+        ~ComputePipeline();
+        ComputePipeline(const ComputePipeline &) = delete;
+        ComputePipeline &operator=(const ComputePipeline &) = delete;
+
+        void bind(VkCommandBuffer commandBuffer);
+
+    private:
+        Device &device;
+        VkPipeline computePipeline;
     };
 };
\ No newline at end of file
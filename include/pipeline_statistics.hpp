@@ -0,0 +1,89 @@
+#pragma once
+
+#include "device.hpp"
+
+#include <cstdint>
+#include <array>
+#include <vector>
+
+namespace YTVK
+{
+    /*
+     * Optional VK_QUERY_TYPE_PIPELINE_STATISTICS queries, one per named scope and frame in flight.
+     * Pipeline statistics queries cannot be nested, so unlike GpuProfiler scopes these must not
+     * overlap. Results are read back without waiting when the frame slot comes around again.
+     */
+    class PipelineStatistics
+    {
+    public:
+        static constexpr uint32_t MAX_SCOPES_PER_FRAME = 16;
+
+        struct Result
+        {
+            const char *name;
+            uint64_t inputAssemblyVertices;
+            uint64_t vertexShaderInvocations;
+            uint64_t clippingPrimitives;
+            uint64_t fragmentShaderInvocations;
+        };
+
+        class Scope
+        {
+        public:
+            Scope(PipelineStatistics &statistics, VkCommandBuffer commandBuffer, const char *name);
+            ~Scope();
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            PipelineStatistics &statistics;
+            VkCommandBuffer commandBuffer;
+            uint32_t index;
+        };
+
+        // Disabled (every call a no-op) unless requested and Device::supportsPipelineStatistics()
+        PipelineStatistics(Device &device, uint32_t framesInFlight, bool enabled);
+        ~PipelineStatistics();
+        PipelineStatistics(const PipelineStatistics &) = delete;
+        PipelineStatistics &operator=(const PipelineStatistics &) = delete;
+
+        bool isEnabled() const { return queryPool != VK_NULL_HANDLE; }
+
+        void beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex);
+        void endFrame(uint64_t timelineValue);
+
+        uint32_t beginScope(VkCommandBuffer commandBuffer, const char *name);
+        void endScope(VkCommandBuffer commandBuffer, uint32_t index);
+
+        // Most recently completed frame; empty until the first frame slot has been reused
+        const std::vector<Result> &getResults() const { return results; }
+        uint64_t getResultsFrameNumber() const { return resultsFrameNumber; }
+
+    private:
+        static constexpr uint32_t INVALID_SCOPE = ~0u;
+        static constexpr uint32_t COUNTER_COUNT = 4;
+
+        struct FrameQueries
+        {
+            std::vector<const char *> names;
+            uint64_t timelineValue = 0;
+            uint64_t frameNumber = 0;
+            bool submitted = false;
+        };
+
+        void collect(FrameQueries &frame, uint32_t frameIndex);
+        uint32_t firstQuery(uint32_t frameIndex) const { return frameIndex * MAX_SCOPES_PER_FRAME; }
+
+        Device &device;
+        VkQueryPool queryPool = VK_NULL_HANDLE;
+
+        std::vector<FrameQueries> frames;
+        uint32_t currentFrameIndex = 0;
+        uint64_t frameNumber = 0;
+        bool scopeActive = false;
+
+        std::array<uint64_t, MAX_SCOPES_PER_FRAME * (COUNTER_COUNT + 1)> queryData{};
+        std::vector<Result> results;
+        uint64_t resultsFrameNumber = 0;
+    };
+}
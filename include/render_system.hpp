@@ -1,9 +1,13 @@
 #pragma once
 
 #include "pipeline.hpp"
+#include "bindless.hpp"
+#include "descriptors.hpp"
 #include "device.hpp"
+#include "draw_list.hpp"
 #include "game_object.hpp"
 #include "camera.hpp"
+#include "depth_prepass_mode.hpp"
 #include "frame_info.hpp"
 
 #include <memory>
@@ -11,23 +15,69 @@
 
 namespace YTVK
 {
-
     class RenderSystem
     {
     public:
-        RenderSystem(Device &, VkRenderPass, VkDescriptorSetLayout);
+        // Auto mode: frames measured per variant, and frames until both are measured again
+        static constexpr uint32_t PREPASS_TRIAL_FRAMES = 30;
+        static constexpr uint32_t PREPASS_REEVALUATE_FRAMES = 1800;
+
+        // With a BindlessSet, objects with a textureIndex are textured from it (bound as set 1)
+        RenderSystem(Device &, VkRenderPass, VkDescriptorSetLayout, BindlessSet * = nullptr, DepthPrepassMode = DepthPrepassMode::Auto);
         ~RenderSystem();
         RenderSystem(const RenderSystem &) = delete;
         RenderSystem &operator=(const RenderSystem &) = delete;
 
+        // Culls objects outside the view frustum and orders the rest by state and depth for both
+        // passes; call before the render pass
+        void sortDraws(FrameInfo &, std::vector<GameObject> &);
+        // In RenderTarget::DEPTH_PREPASS_SUBPASS; records nothing when the pre-pass is off this frame
+        void renderDepthPrepass(FrameInfo &, std::vector<GameObject> &);
+        // In RenderTarget::MAIN_SUBPASS; only shades the visible surface when the pre-pass ran
         void renderGameObjects(FrameInfo &, std::vector<GameObject> &);
 
+        bool isDepthPrepassActive() const { return prepassThisFrame; }
+
+        // Without a BindlessSet, textureIndex indexes these instead and each textured draw pushes its
+        // image as set 1 through PushDescriptorWriter
+        void setTextures(std::vector<VkDescriptorImageInfo> textureInfos) { textures = std::move(textureInfos); }
+
     private:
         void createPipelineLayout(VkDescriptorSetLayout);
         void createPipeline(VkRenderPass);
+        void bindDescriptorSets(FrameInfo &);
+        bool isPushTextured(const GameObject &object) const { return bindless == nullptr && object.textureIndex < textures.size(); }
+        bool chooseDepthPrepass(const GpuProfiler &);
 
         Device &device;
+        BindlessSet *bindless;
+        DepthPrepassMode depthPrepassMode;
+        // Depth test LESS with writes; used without a pre-pass
         std::unique_ptr<Pipeline> pipeline;
+        // Position-only, depth-only pipeline of the pre-pass
+        std::unique_ptr<Pipeline> depthPrepassPipeline;
+        // Depth test EQUAL without writes; shades only what the pre-pass left visible
+        std::unique_ptr<Pipeline> depthEqualPipeline;
+        // Without a BindlessSet: the variants above sampling the per-draw texture set
+        std::unique_ptr<Pipeline> texturedPipeline;
+        std::unique_ptr<Pipeline> texturedDepthEqualPipeline;
+        std::unique_ptr<DescriptorSetLayout> textureSetLayout;
+        std::vector<VkDescriptorImageInfo> textures;
         VkPipelineLayout pipelineLayout;
+        bool prepassThisFrame = false;
+        DrawList drawList;
+
+        // GPU milliseconds of the render system per variant, see chooseDepthPrepass
+        struct PrepassTrial
+        {
+            double withoutPrepassMs = 0.0;
+            double withPrepassMs = 0.0;
+            uint32_t withoutPrepassFrames = 0;
+            uint32_t withPrepassFrames = 0;
+            uint32_t framesSinceDecision = 0;
+            bool decided = false;
+            bool useDepthPrepass = false;
+            uint64_t lastResultsFrame = 0;
+        } trial{};
     };
 };
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace YTVK
+{
+    /*
+     * What Renderer draws into: a set of framebuffers sharing one render pass, handed out one at
+     * a time through acquire/submit. Implemented by SwapChain (presented to a window surface) and
+     * OffscreenTarget (headless).
+     *
+     * The render pass has a depth-only subpass for an optional depth pre-pass, followed by the main
+     * subpass that writes color. The first subpass is left empty when there is no pre-pass.
+     */
+    class RenderTarget
+    {
+    public:
+        static constexpr uint32_t DEPTH_PREPASS_SUBPASS = 0;
+        static constexpr uint32_t MAIN_SUBPASS = 1;
+
+        virtual ~RenderTarget() = default;
+
+        virtual VkRenderPass getRenderPass() = 0;
+        virtual VkFramebuffer getFrameBuffer(int index) = 0;
+        virtual VkExtent2D getExtent() = 0;
+        virtual uint32_t framesInFlight() const = 0;
+
+        virtual VkResult acquireNextImage(uint32_t *imageIndex) = 0;
+        virtual VkResult submitCommandBuffers(const VkCommandBuffer *buffers, uint32_t *imageIndex) = 0;
+
+        // Timeline value signaled by the most recent submission from the given frame slot
+        virtual uint64_t getFrameTimelineValue(size_t frameIndex) const = 0;
+
+        float extentAspectRatio()
+        {
+            VkExtent2D extent = getExtent();
+            return static_cast<float>(extent.width) / static_cast<float>(extent.height);
+        }
+    };
+}
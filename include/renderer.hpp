@@ -3,8 +3,14 @@
 #include "window.hpp"
 #include "device.hpp"
 #include "swapchain.hpp"
+#include "offscreen_target.hpp"
+#include "frame_stats.hpp"
+#include "gpu_profiler.hpp"
+#include "pipeline_statistics.hpp"
 
+#include <chrono>
 #include <memory>
+#include <string>
 #include <vector>
 
 namespace YTVK
@@ -12,7 +18,9 @@ namespace YTVK
     class Renderer
     {
     public:
-        Renderer(Window &, Device &);
+        Renderer(Window &, Device &, const SwapChainSettings & = {});
+        // Headless: renders into an OffscreenTarget of the given size, only framesInFlight is used from settings
+        Renderer(Device &, VkExtent2D extent, const SwapChainSettings & = {});
         ~Renderer();
         Renderer(const Renderer &) = delete;
         Renderer &operator=(const Renderer &) = delete;
@@ -23,26 +31,67 @@ namespace YTVK
 
         VkCommandBuffer getCurrentCommandBuffer() const;
         int getCurrentFrameIndex() const;
+        uint32_t getFramesInFlight() const { return settings.framesInFlight; }
+
+        // Timings of the most recently submitted frame
+        const FrameStats &getFrameStats() const { return frameStats; }
+        GpuProfiler &getProfiler() { return *profiler; }
+        PipelineStatistics &getPipelineStatistics() { return *pipelineStatistics; }
+        // Off by default, the queries are not free on every driver
+        void setPipelineStatisticsEnabled(bool enabled);
+
+        // Timeline value signaled by the most recently submitted frame
+        uint64_t getLastFrameTimelineValue() const { return lastFrameTimelineValue; }
 
         float getAspectRation() const;
+        VkExtent2D getExtent() const;
+        bool isHeadless() const { return window == nullptr; }
+
+        // Headless only: writes the most recently submitted frame as a PPM image
+        void saveLastFrame(const std::string &path);
 
+        // Starts in RenderTarget::DEPTH_PREPASS_SUBPASS; beginMainSubpass moves on to MAIN_SUBPASS
         void beginSwapChainRenderPass(VkCommandBuffer);
+        void beginMainSubpass(VkCommandBuffer);
         void endSwapChainRenderPass(VkCommandBuffer);
         VkRenderPass getSwapChainRenderPass() const;
 
     private:
-        Window &window;
+        Window *window;
         Device &device;
+        SwapChainSettings settings;
 
         uint32_t currentImageIndex;
         uint32_t currentFrameIndex;
         bool isFrameStarted;
+        uint64_t lastFrameTimelineValue = 0;
 
         std::unique_ptr<SwapChain> swapchain;
+        std::unique_ptr<OffscreenTarget> offscreenTarget;
+        // Whichever of the two above is in use
+        RenderTarget *target = nullptr;
         std::vector<VkCommandBuffer> commandBuffers;
 
+        std::unique_ptr<GpuProfiler> profiler;
+        std::unique_ptr<PipelineStatistics> pipelineStatistics;
+        uint32_t frameScope = 0;
+        uint32_t renderPassScope = 0;
+        uint64_t lastProfiledFrame = 0;
+
+        // Replaced swap chains, kept until nothing can still be presenting from them
+        struct RetiredSwapChain
+        {
+            std::shared_ptr<SwapChain> swapChain;
+            // Frames to submit on the new chain before release, when there are no present fences
+            uint32_t framesUntilRelease;
+        };
+        std::vector<RetiredSwapChain> retiredSwapChains;
+        std::chrono::high_resolution_clock::time_point acquireStart;
+        FrameStats frameStats{};
+
         void createCommandBuffers();
         void freeCommandBuffers();
         void recreateSwapchain();
+        void releaseRetiredSwapChains();
     };
 };
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "game_object.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace YTVK
+{
+    /*
+     * Plain-text scene used by the benchmark mode. One directive per line, '#' starts a comment:
+     *
+     *   object <model path> <tx ty tz> <rx ry rz> <sx sy sz>
+     *   camera <tx ty tz> <rx ry rz>     control point of the camera spline, in order
+     *   frames <count>                   default benchmark length
+     *   texture <path | none>            texture of the objects that follow (.ktx2 or .ppm)
+     *   light <tx ty tz> <r g b> <radius>   point light
+     *   generate <distribution> <count> ...   procedural objects, see SceneGeneratorSettings
+     */
+    struct SceneDescription
+    {
+        static constexpr uint32_t NO_TEXTURE = ~0u;
+
+        struct Object
+        {
+            // Index into models
+            uint32_t model = 0;
+            TransformComponent transform{};
+            // Radians per second added to the rotation each frame; zero for static objects
+            glm::vec3 spin{};
+            // Index into textures
+            uint32_t texture = NO_TEXTURE;
+        };
+
+        struct Light
+        {
+            glm::vec3 position{};
+            // Linear, may exceed 1
+            glm::vec3 color{1.0f};
+            float radius = 1.0f;
+        };
+
+        struct CameraKey
+        {
+            glm::vec3 translation{};
+            glm::vec3 rotation{};
+        };
+
+        std::string path{};
+        std::vector<std::string> models{};
+        std::vector<std::string> textures{};
+        std::vector<Object> objects{};
+        std::vector<Light> lights{};
+        std::vector<CameraKey> cameraPath{};
+        uint32_t frameCount = 600;
+
+        // A non-zero objectCount overrides the count of every generate directive, for scaling sweeps
+        static SceneDescription load(const std::string &path, uint32_t objectCount = 0);
+
+        uint32_t findOrAddModel(const std::string &modelPath);
+
+        // Uniform Catmull-Rom through cameraPath; t in [0, 1] spans the whole path
+        CameraKey sampleCamera(float t) const;
+    };
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace YTVK
+{
+    struct SceneDescription;
+
+    enum class SceneDistribution
+    {
+        Grid,
+        Clustered,
+        Random,
+        // Jittered grid on the ground plane, one model, random yaw and scale
+        Forest
+    };
+
+    /*
+     * Procedural stress scenes for scaling tests, written in a scene file as
+     *
+     *   generate <grid|clustered|random|forest> <count> [models=N] [static=F] [coverage=F] [clusters=N] [lights=N] [seed=N]
+     *
+     * Placement is relative to the default view: a camera at the origin looking down +z with the
+     * projection App uses (50 degree fov, 4:3, far plane 10). `coverage` of the objects land inside
+     * that frustum and the rest in its mirror image behind the camera, so the frustum culling in
+     * RenderSystem::sortDraws and draw submission can be scaled independently. Output only depends
+     * on the settings and the seed.
+     */
+    struct SceneGeneratorSettings
+    {
+        SceneDistribution distribution = SceneDistribution::Grid;
+        uint32_t objectCount = 1000;
+        // Distinct bundled models to cycle through, 0 uses all of them (forest defaults to 1)
+        uint32_t modelVariety = 0;
+        // The rest spin about their y axis and are updated every frame
+        float staticFraction = 1.0f;
+        float coverage = 1.0f;
+        uint32_t clusters = 16;
+        // Point lights scattered through the visible frustum, sized to overlap a few neighbours
+        uint32_t lightCount = 0;
+        uint32_t seed = 1;
+
+        // Parses everything after "generate"; throws std::runtime_error when malformed
+        static SceneGeneratorSettings parse(const std::string &arguments);
+    };
+
+    void generateSceneObjects(const SceneGeneratorSettings &settings, SceneDescription &scene);
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace YTVK
+{
+    /*
+     * Cold start breakdown. Startup code wraps each step in a StartupReport::Phase and bumps the
+     * counters; App calls finish() once the first frame has been rendered, which freezes the report.
+     * Times are measured from static initialization, i.e. shortly after the process started.
+     */
+    class StartupReport
+    {
+    public:
+        struct PhaseTime
+        {
+            std::string name;
+            double startMs;
+            double durationMs;
+        };
+
+        class Phase
+        {
+        public:
+            explicit Phase(const char *name);
+            ~Phase();
+            Phase(const Phase &) = delete;
+            Phase &operator=(const Phase &) = delete;
+
+        private:
+            const char *name;
+            std::chrono::steady_clock::time_point start;
+        };
+
+        // Totals from the rest of the engine, gathered when the report is finished
+        struct Allocations
+        {
+            uint64_t gpuAllocations = 0;
+            uint64_t gpuBytes = 0;
+            // Zero unless built with YTVK_TRACK_ALLOCATIONS
+            uint64_t heapAllocations = 0;
+        };
+
+        static void addFileRead(uint64_t bytes);
+        static void addBytesParsed(uint64_t bytes);
+        static void addPipelineCompiled();
+
+        // Time to first frame is taken here; later calls are ignored
+        static void finish(const Allocations &allocations);
+        static bool isFinished();
+
+        static void print(std::ostream &out);
+        static void writeJson(const std::string &path);
+
+    private:
+        static std::atomic<uint64_t> filesRead;
+        static std::atomic<uint64_t> bytesRead;
+        static std::atomic<uint64_t> bytesParsed;
+        static std::atomic<uint64_t> pipelinesCompiled;
+    };
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "device.hpp"
+#include "render_target.hpp"
 
 // vulkan headers
 #include <vulkan/vulkan.h>
@@ -13,38 +14,54 @@
 namespace YTVK
 {
 
-  class SwapChain
+  // Chosen at startup; trades throughput (more frames queued) against input latency
+  struct SwapChainSettings
+  {
+    uint32_t framesInFlight = 2;
+    VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
+  };
+
+  // Command line spelling of a present mode, e.g. "fifo-relaxed"
+  const char *presentModeName(VkPresentModeKHR mode);
+
+  class SwapChain : public RenderTarget
   {
   public:
-    static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+    // Upper bound for SwapChainSettings::framesInFlight
+    static constexpr int MAX_FRAMES_IN_FLIGHT = 4;
 
-    SwapChain(Device &deviceRef, VkExtent2D windowExtent);
-    SwapChain(Device &deviceRef, VkExtent2D windowExtent, std::shared_ptr<SwapChain> previous);
+    SwapChain(Device &deviceRef, VkExtent2D windowExtent, const SwapChainSettings &settings);
+    SwapChain(Device &deviceRef, VkExtent2D windowExtent, const SwapChainSettings &settings, std::shared_ptr<SwapChain> previous);
     ~SwapChain();
 
     SwapChain(const SwapChain &) = delete;
     void operator=(const SwapChain &) = delete;
 
-    VkFramebuffer getFrameBuffer(int index) { return swapChainFramebuffers[index]; }
-    VkRenderPass getRenderPass() { return renderPass; }
+    VkFramebuffer getFrameBuffer(int index) override { return swapChainFramebuffers[index]; }
+    VkRenderPass getRenderPass() override { return renderPass; }
     VkImageView getImageView(int index) { return swapChainImageViews[index]; }
     size_t imageCount() { return swapChainImages.size(); }
+    uint32_t framesInFlight() const override { return settings.framesInFlight; }
+    VkPresentModeKHR getPresentMode() const { return presentMode; }
     VkFormat getSwapChainImageFormat() { return swapChainImageFormat; }
     VkExtent2D getSwapChainExtent() { return swapChainExtent; }
+    VkExtent2D getExtent() override { return swapChainExtent; }
     uint32_t width() { return swapChainExtent.width; }
     uint32_t height() { return swapChainExtent.height; }
 
-    float extentAspectRatio()
-    {
-      return static_cast<float>(swapChainExtent.width) / static_cast<float>(swapChainExtent.height);
-    }
     VkFormat findDepthFormat();
 
-    VkResult acquireNextImage(uint32_t *imageIndex);
-    VkResult submitCommandBuffers(const VkCommandBuffer *buffers, uint32_t *imageIndex);
+    VkResult acquireNextImage(uint32_t *imageIndex) override;
+    VkResult submitCommandBuffers(const VkCommandBuffer *buffers, uint32_t *imageIndex) override;
+
+    uint64_t getFrameTimelineValue(size_t frameIndex) const override { return frameTimelineValues[frameIndex]; }
 
     bool compareSwapFormats(const SwapChain &) const;
 
+    // True once every present made through this swap chain has finished with its semaphores and
+    // images; only known with Device::supportsPresentFences()
+    bool presentsComplete();
+
   private:
     void init();
     void createSwapChain();
@@ -61,6 +78,8 @@ namespace YTVK
         const std::vector<VkPresentModeKHR> &availablePresentModes);
     VkExtent2D chooseSwapExtent(const VkSurfaceCapabilitiesKHR &capabilities);
 
+    SwapChainSettings settings;
+    VkPresentModeKHR presentMode;
     VkFormat swapChainImageFormat;
     VkFormat swapChainDepthFormat;
     VkExtent2D swapChainExtent;
@@ -80,10 +99,13 @@ namespace YTVK
     VkSwapchainKHR swapChain;
     std::shared_ptr<SwapChain> oldSwapChain;
 
+    // Binary semaphores are still required by acquire/present; CPU pacing uses the device timeline
     std::vector<VkSemaphore> imageAvailableSemaphores;
     std::vector<VkSemaphore> renderFinishedSemaphores;
-    std::vector<VkFence> inFlightFences;
-    std::vector<VkFence> imagesInFlight;
+    // Per frame slot, signaled by the presentation engine; empty without Device::supportsPresentFences()
+    std::vector<VkFence> presentFences;
+    std::vector<uint64_t> frameTimelineValues;
+    std::vector<uint64_t> imageTimelineValues;
     size_t currentFrame = 0;
   };
 
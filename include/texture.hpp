@@ -0,0 +1,119 @@
+#pragma once
+
+#include "device.hpp"
+#include "upload_batch.hpp"
+#include "bindless.hpp"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace YTVK
+{
+    struct SamplerSettings
+    {
+        VkFilter filter = VK_FILTER_LINEAR;
+        VkSamplerMipmapMode mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+        VkSamplerAddressMode addressMode = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+        // Clamped to the device limit, 1 disables anisotropic filtering
+        float maxAnisotropy = 16.0f;
+
+        bool operator==(const SamplerSettings &other) const;
+    };
+
+    // One VkSampler per distinct SamplerSettings, shared by every texture that asks for it
+    class SamplerCache
+    {
+    public:
+        explicit SamplerCache(Device &device) : device{device} {}
+        ~SamplerCache();
+        SamplerCache(const SamplerCache &) = delete;
+        SamplerCache &operator=(const SamplerCache &) = delete;
+
+        VkSampler getSampler(const SamplerSettings &settings = {});
+
+        size_t size() const { return samplers.size(); }
+
+    private:
+        struct SettingsHash
+        {
+            size_t operator()(const SamplerSettings &settings) const;
+        };
+
+        Device &device;
+        std::unordered_map<SamplerSettings, VkSampler, SettingsHash> samplers;
+    };
+
+    /*
+     * Sampled 2D image with its full mip chain, in SHADER_READ_ONLY_OPTIMAL once the upload batch it
+     * was created with has executed. KTX2 files are uploaded as stored, including BCn/ASTC blocks
+     * and their mip levels; other sources are uploaded at full size and the remaining levels are
+     * blitted on the GPU.
+     */
+    class Texture
+    {
+    public:
+        struct Builder
+        {
+            struct Level
+            {
+                VkDeviceSize offset;
+                VkDeviceSize size;
+            };
+
+            VkFormat format = VK_FORMAT_UNDEFINED;
+            VkExtent2D extent{};
+            // Levels, largest first, each starting on a 16 byte boundary of data
+            std::vector<char> data{};
+            std::vector<Level> levels{};
+            // Fill in the levels below the last one given with vkCmdBlitImage
+            bool generateMipmaps = false;
+
+            // .ktx2, or .ppm (binary P6) as an uncompressed fallback
+            void loadTexture(const std::string &path);
+            void loadKtx2(const std::string &path);
+            void loadPpm(const std::string &path);
+        };
+
+        // baseLevel skips the builder's largest levels, e.g. to upload only the small mips
+        Texture(Device &device, UploadBatch &uploadBatch, const Texture::Builder &builder, VkSampler sampler, uint32_t baseLevel = 0);
+        ~Texture();
+        Texture(const Texture &) = delete;
+        Texture &operator=(const Texture &) = delete;
+
+        static std::unique_ptr<Texture> createTextureFromFile(
+            Device &device, UploadBatch &uploadBatch, SamplerCache &samplerCache, const std::string &path);
+
+        // Index into the bindless texture table, released again when the texture is destroyed
+        uint32_t registerBindless(BindlessSet &bindlessSet);
+        uint32_t getBindlessIndex() const { return bindlessIndex; }
+
+        VkDescriptorImageInfo descriptorInfo() const;
+        VkImage getImage() const { return image; }
+        VkImageView getImageView() const { return imageView; }
+        VkSampler getSampler() const { return sampler; }
+        VkFormat getFormat() const { return format; }
+        VkExtent2D getExtent() const { return extent; }
+        uint32_t getMipLevels() const { return mipLevels; }
+        VkDeviceSize getMemorySize() const { return memorySize; }
+
+    private:
+        void createImage(VkImageUsageFlags usage);
+        void createImageView();
+        void recordUpload(UploadBatch &uploadBatch, const Texture::Builder &builder, uint32_t baseLevel);
+
+        Device &device;
+        VkImage image = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        VkImageView imageView = VK_NULL_HANDLE;
+        VkSampler sampler;
+        VkFormat format;
+        VkExtent2D extent;
+        uint32_t mipLevels;
+        VkDeviceSize memorySize = 0;
+
+        BindlessSet *bindlessSet = nullptr;
+        uint32_t bindlessIndex = BindlessSet::INVALID_INDEX;
+    };
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "texture.hpp"
+#include "camera.hpp"
+#include "game_object.hpp"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace YTVK
+{
+    /*
+     * Keeps textures resident only down to the mip level their objects need. Each texture starts
+     * with its small mips; every update() estimates the wanted level from each object's projected
+     * size and, within the byte budget, re-uploads the texture from that level down. Until the
+     * upload has executed, objects keep sampling the old image, so sampling is clamped to the
+     * levels actually resident. When over budget, textures holding more detail than they need are
+     * shrunk first. The budget is further capped by what MemoryTracker's device local limit has left.
+     * The full mip chain of every texture stays in host memory.
+     */
+    class TextureStreamer
+    {
+    public:
+        // Mips up to this size are resident from the start
+        static constexpr uint32_t INITIAL_MAX_EXTENT = 64;
+        // Caps the upload work started per update
+        static constexpr VkDeviceSize MAX_UPLOAD_BYTES_PER_UPDATE = 16 * 1024 * 1024;
+
+        TextureStreamer(Device &device, BindlessSet &bindlessSet, SamplerCache &samplerCache, VkDeviceSize budgetBytes);
+        ~TextureStreamer();
+        TextureStreamer(const TextureStreamer &) = delete;
+        TextureStreamer &operator=(const TextureStreamer &) = delete;
+
+        // Returns the bindless index to put in GameObject::textureIndex; update() keeps it current
+        uint32_t addTexture(const std::string &path, UploadBatch &uploadBatch);
+
+        void update(const Camera &camera, float viewportHeight, std::vector<GameObject> &gameObjects);
+
+        VkDeviceSize getResidentBytes() const { return residentBytes; }
+        VkDeviceSize getBudgetBytes() const { return budgetBytes; }
+        size_t getTextureCount() const { return textures.size(); }
+
+    private:
+        static constexpr uint32_t NO_TEXTURE = ~0u;
+
+        struct StreamedTexture
+        {
+            Texture::Builder source;
+            uint32_t initialMip;
+            std::unique_ptr<Texture> resident;
+            uint32_t residentMip;
+            // Uploading; swapped in once the device timeline reaches incomingTimelineValue
+            std::unique_ptr<Texture> incoming;
+            uint32_t incomingMip = 0;
+            uint64_t incomingTimelineValue = 0;
+            uint32_t desiredMip;
+        };
+
+        static VkDeviceSize bytesFrom(const StreamedTexture &texture, uint32_t mip);
+        void estimateDesiredMips(const Camera &camera, float viewportHeight, const std::vector<GameObject> &gameObjects);
+        void swapInFinishedUploads(std::vector<GameObject> &gameObjects);
+        void startUploads();
+        // False, with nothing started, if the image does not fit under the device local limit
+        bool startUpload(uint32_t id, uint32_t mip, UploadBatch &uploadBatch);
+
+        Device &device;
+        BindlessSet &bindlessSet;
+        SamplerCache &samplerCache;
+        VkDeviceSize budgetBytes;
+        // Resident plus incoming images
+        VkDeviceSize residentBytes = 0;
+
+        std::vector<StreamedTexture> textures;
+        // Bindless slot -> index into textures, NO_TEXTURE for slots the streamer does not own
+        std::vector<uint32_t> slotOwners;
+
+        // Scratch, kept to avoid per-frame allocations
+        std::vector<std::pair<uint32_t, uint32_t>> movedSlots;
+        std::vector<uint32_t> candidates;
+        std::vector<uint32_t> started;
+    };
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace YTVK
+{
+    class ThreadPool
+    {
+    public:
+        explicit ThreadPool(uint32_t threadCount = std::thread::hardware_concurrency());
+        ~ThreadPool();
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        void submit(std::function<void()> job);
+
+        // Blocks until every submitted job has finished, rethrowing the first job exception
+        void wait();
+
+        // Splits [0, count) into chunks of at least minChunk and runs them across the pool. Once the
+        // queue has grown to the pool size this does not allocate, so it is safe to call every frame.
+        void parallelFor(size_t count, size_t minChunk, const std::function<void(size_t, size_t)> &job);
+
+        uint32_t size() const { return static_cast<uint32_t>(workers.size()); }
+
+    private:
+        void workerLoop();
+
+        std::vector<std::thread> workers;
+        // Runs front to back from nextJob and is cleared, keeping its capacity, once drained
+        std::vector<std::function<void()>> jobs;
+        size_t nextJob = 0;
+        std::mutex mutex;
+        std::condition_variable jobAvailable;
+        std::condition_variable jobsFinished;
+        size_t pendingJobs = 0;
+        bool stopping = false;
+        std::exception_ptr firstError;
+    };
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+/*
+ * Scoped CPU trace zones:
+ *
+ *   YTVK_TRACE_SCOPE("Renderer::beginFrame");
+ *
+ * Each thread records into its own fixed-size ring buffer, so only the most recent zones are kept
+ * and recording never allocates. While tracing is disabled a zone costs one relaxed atomic load;
+ * defining YTVK_DISABLE_TRACING compiles zones out entirely. Zone names must be string literals.
+ */
+
+#define YTVK_TRACE_CONCAT_INNER(a, b) a##b
+#define YTVK_TRACE_CONCAT(a, b) YTVK_TRACE_CONCAT_INNER(a, b)
+
+#ifdef YTVK_DISABLE_TRACING
+#define YTVK_TRACE_SCOPE(name)
+#else
+#define YTVK_TRACE_SCOPE(name) ::YTVK::TraceZone YTVK_TRACE_CONCAT(traceZone, __LINE__){name}
+#endif
+
+namespace YTVK
+{
+    class Trace
+    {
+    public:
+        // Zones kept per thread; older ones are overwritten
+        static constexpr size_t EVENTS_PER_THREAD = 1 << 16;
+
+        static void setEnabled(bool enabled) { enabledFlag.store(enabled, std::memory_order_relaxed); }
+        static bool isEnabled() { return enabledFlag.load(std::memory_order_relaxed); }
+
+        // Nanoseconds on std::chrono::steady_clock
+        static uint64_t now();
+        static void record(const char *name, uint64_t begin, uint64_t end);
+
+        // Shown instead of the numeric thread id in trace viewers
+        static void setThreadName(const std::string &name);
+
+        // Writes every thread's buffered zones as Chrome trace event JSON (chrome://tracing, Perfetto)
+        static void writeChromeJson(const std::string &path);
+
+    private:
+        static std::atomic<bool> enabledFlag;
+    };
+
+    class TraceZone
+    {
+    public:
+        explicit TraceZone(const char *name) : name{name}, begin{Trace::isEnabled() ? Trace::now() : 0} {}
+        ~TraceZone()
+        {
+            if (begin != 0)
+            {
+                Trace::record(name, begin, Trace::now());
+            }
+        }
+        TraceZone(const TraceZone &) = delete;
+        TraceZone &operator=(const TraceZone &) = delete;
+
+    private:
+        const char *name;
+        uint64_t begin;
+    };
+}
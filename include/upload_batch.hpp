@@ -0,0 +1,56 @@
+#pragma once
+
+#include "device.hpp"
+#include "buffer.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace YTVK
+{
+    /*
+     * Records many uploads into one command buffer backed by a few large staging buffers, then
+     * submits them together. submit() does not wait: the staging memory and command buffer are
+     * handed to the deletion queue and released once the returned timeline value completes.
+     * Copies are ordered before later submissions on the graphics queue by their own barriers.
+     */
+    class UploadBatch
+    {
+    public:
+        // Staging is sub-allocated from buffers of this size; larger uploads get their own buffer
+        static constexpr VkDeviceSize STAGING_CHUNK_SIZE = 8 * 1024 * 1024;
+
+        struct Staging
+        {
+            VkBuffer buffer;
+            VkDeviceSize offset;
+            void *data;
+        };
+
+        explicit UploadBatch(Device &device);
+        // Work that was recorded but never submitted is dropped
+        ~UploadBatch();
+        UploadBatch(const UploadBatch &) = delete;
+        UploadBatch &operator=(const UploadBatch &) = delete;
+
+        // Host visible space for the caller to fill and copy from with its own commands
+        Staging stage(VkDeviceSize size, VkDeviceSize alignment = 16);
+        void copyToBuffer(const void *data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset = 0);
+        // Begins recording on first use
+        VkCommandBuffer getCommandBuffer();
+
+        bool empty() const { return commandBuffer == VK_NULL_HANDLE; }
+        VkDeviceSize getStagedBytes() const { return stagedBytes; }
+
+        // Returns the timeline value to wait for before the uploaded data may be read on the host
+        uint64_t submit();
+        void submitAndWait();
+
+    private:
+        Device &device;
+        VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+        std::vector<std::unique_ptr<Buffer>> chunks;
+        VkDeviceSize chunkOffset = 0;
+        VkDeviceSize stagedBytes = 0;
+    };
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <string>
 
 namespace YTVK
 {
@@ -13,4 +14,44 @@ namespace YTVK
         (hashCombine(seed, rest), ...);
     };
 
+    // For the hand-written JSON of benchmark results and traces
+    inline std::string escapeJson(const std::string &value)
+    {
+        static const char HEX[] = "0123456789abcdef";
+        std::string escaped;
+        for (char c : value)
+        {
+            switch (c)
+            {
+            case '"':
+                escaped += "\\\"";
+                break;
+            case '\\':
+                escaped += "\\\\";
+                break;
+            case '\n':
+                escaped += "\\n";
+                break;
+            case '\r':
+                escaped += "\\r";
+                break;
+            case '\t':
+                escaped += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    escaped += "\\u00";
+                    escaped += HEX[c >> 4];
+                    escaped += HEX[c & 0xf];
+                }
+                else
+                {
+                    escaped += c;
+                }
+            }
+        }
+        return escaped;
+    }
+
 }
\ No newline at end of file
@@ -0,0 +1,46 @@
+#ifndef GLOBAL_GLSL
+#define GLOBAL_GLSL
+
+// Set 0, shared by every pass. Must match GlobalUBO in app.cpp, ClusteredLighting and CascadedShadowMaps.
+
+const uint SHADOW_CASCADE_COUNT = 4;
+
+layout(set = 0, binding = 0) uniform GlobalUBO {
+    mat4 projectionViewMatrix;
+    mat4 viewMatrix;
+    vec4 directionToLight;
+    vec4 clusterParams; // near, far, projection[0][0], projection[1][1]
+    uvec4 lightingInfo; // point light count, framebuffer width, framebuffer height
+    mat4 cascadeViewProjection[SHADOW_CASCADE_COUNT];
+    vec4 cascadeSplits; // view depth where each cascade ends
+} ubo;
+
+struct PointLight {
+    vec4 positionRadius; // world space
+    vec4 color; // rgb, w is intensity
+};
+
+layout(std430, set = 0, binding = 1) readonly buffer PointLights {
+    PointLight pointLights[];
+};
+
+const uint CLUSTERS_X = 16;
+const uint CLUSTERS_Y = 9;
+const uint CLUSTERS_Z = 24;
+const uint CLUSTER_COUNT = CLUSTERS_X * CLUSTERS_Y * CLUSTERS_Z;
+const uint MAX_LIGHTS_PER_CLUSTER = 128;
+
+// Written by cluster.comp each frame, which defines CLUSTER_LIGHTS_WRITABLE; read-only everywhere
+// else since graphics stages may not write storage buffers without fragmentStoresAndAtomics
+#ifdef CLUSTER_LIGHTS_WRITABLE
+layout(std430, set = 0, binding = 2) buffer ClusterLights {
+#else
+layout(std430, set = 0, binding = 2) readonly buffer ClusterLights {
+#endif
+    uint clusterLightCounts[CLUSTER_COUNT];
+    uint clusterLightIndices[CLUSTER_COUNT * MAX_LIGHTS_PER_CLUSTER];
+};
+
+layout(set = 0, binding = 3) uniform sampler2DArrayShadow shadowMap;
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef LIGHTING_GLSL
+#define LIGHTING_GLSL
+
+#include "global.glsl"
+
+const float AMBIENT = 0.02;
+
+// Screen tiles in x and y, exponential depth slices between the near and far plane
+uint clusterIndex(vec2 fragCoord, float viewDepth) {
+    vec2 framebufferSize = vec2(ubo.lightingInfo.yz);
+    uvec2 tile = min(uvec2(fragCoord / framebufferSize * vec2(CLUSTERS_X, CLUSTERS_Y)), uvec2(CLUSTERS_X - 1, CLUSTERS_Y - 1));
+    float near = ubo.clusterParams.x;
+    float far = ubo.clusterParams.y;
+    float slice = log(max(viewDepth, near) / near) / log(far / near) * float(CLUSTERS_Z);
+    uint z = min(uint(slice), CLUSTERS_Z - 1);
+    return tile.x + tile.y * CLUSTERS_X + z * CLUSTERS_X * CLUSTERS_Y;
+}
+
+// 1 where the directional light reaches the point, 0 in shadow
+float directionalShadow(vec3 positionWorld, float viewDepth) {
+    if (viewDepth > ubo.cascadeSplits[SHADOW_CASCADE_COUNT - 1]) {
+        return 1.0;
+    }
+    uint cascade = 0;
+    while (cascade < SHADOW_CASCADE_COUNT - 1 && viewDepth > ubo.cascadeSplits[cascade]) {
+        cascade++;
+    }
+    vec4 positionLight = ubo.cascadeViewProjection[cascade] * vec4(positionWorld, 1.0);
+    return texture(shadowMap, vec4(positionLight.xy * 0.5 + 0.5, float(cascade), positionLight.z));
+}
+
+// Shadowed directional light plus every point light binned into this fragment's cluster
+vec3 shade(vec3 albedo, vec3 positionWorld, vec3 normalWorld, vec2 fragCoord) {
+    vec3 normal = normalize(normalWorld);
+    float viewDepth = (ubo.viewMatrix * vec4(positionWorld, 1.0)).z;
+    float directional = max(dot(normal, ubo.directionToLight.xyz), 0.0) * directionalShadow(positionWorld, viewDepth);
+    vec3 light = vec3(directional + AMBIENT);
+
+    uint cluster = clusterIndex(fragCoord, viewDepth);
+    uint count = clusterLightCounts[cluster];
+    for (uint i = 0; i < count; ++i) {
+        PointLight pointLight = pointLights[clusterLightIndices[cluster * MAX_LIGHTS_PER_CLUSTER + i]];
+        vec3 toLight = pointLight.positionRadius.xyz - positionWorld;
+        float distanceSquared = dot(toLight, toLight);
+        float radiusSquared = pointLight.positionRadius.w * pointLight.positionRadius.w;
+        if (distanceSquared >= radiusSquared) {
+            continue;
+        }
+        // Smooth falloff that reaches zero at the radius
+        float falloff = 1.0 - distanceSquared / radiusSquared;
+        float diffuse = max(dot(normal, toLight * inversesqrt(distanceSquared)), 0.0);
+        light += pointLight.color.rgb * pointLight.color.w * diffuse * falloff * falloff;
+    }
+    return albedo * light;
+}
+
+#endif
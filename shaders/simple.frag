@@ -1,13 +1,20 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "lighting.glsl"
+
 layout (location = 0) in vec3 fragColor;
+layout (location = 1) in vec2 fragUv;
+layout (location = 2) in vec3 fragPositionWorld;
+layout (location = 3) in vec3 fragNormalWorld;
 
 layout (location = 0) out vec4 outColor;
 
 layout(push_constant) uniform Push {
-    mat4 transform; // Projection * view * model
+    mat4 transform; // Model matrix
     mat4 normalMatrix;
 } push;
 
 void main() {
-    outColor = vec4(fragColor, 1.0);
-}
\ No newline at end of file
+    outColor = vec4(shade(fragColor, fragPositionWorld, fragNormalWorld, gl_FragCoord.xy), 1.0);
+}
@@ -1,4 +1,7 @@
 #version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "global.glsl"
 
 layout(location = 0) in vec3 position;
 layout(location = 1) in vec3 color;
@@ -6,26 +9,25 @@ layout(location = 2) in vec3 normal;
 layout(location = 3) in vec2 uv;
 
 layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragUv;
+layout(location = 2) out vec3 fragPositionWorld;
+layout(location = 3) out vec3 fragNormalWorld;
 
-layout(set = 0, binding = 0) uniform GlobalUBO {
-    mat4 projectionViewMatrix;
-    vec3 directionToLight;
-} ubo;
+// Must match depth_prepass.vert exactly for its EQUAL depth test
+invariant gl_Position;
 
 layout(push_constant) uniform Push {
     mat4 modelMatrix;
     mat4 normalMatrix;
 } push;
 
-const vec3 DIRECTION_TO_LIGHT = normalize(vec3(1.0, -3.0, -1.0));
-const float AMBIENT = 0.02;
-
 void main() {
-    gl_Position = ubo.projectionViewMatrix * push.modelMatrix * vec4(position, 1.0);
-    
-    vec3 normalWorldSpace = normalize(mat3(push.normalMatrix) * normal);
-
-    float lightIntensity = max(dot(normalWorldSpace, ubo.directionToLight), 0) + AMBIENT;
-
-    fragColor = lightIntensity * color;
-}
\ No newline at end of file
+    vec4 positionWorld = push.modelMatrix * vec4(position, 1.0);
+    gl_Position = ubo.projectionViewMatrix * positionWorld;
+
+    // Lit per pixel in the fragment shader
+    fragColor = color;
+    fragUv = uv;
+    fragPositionWorld = positionWorld.xyz;
+    fragNormalWorld = normalize(mat3(push.normalMatrix) * normal);
+}
@@ -0,0 +1,31 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+#extension GL_GOOGLE_include_directive : require
+
+#include "lighting.glsl"
+
+layout (location = 0) in vec3 fragColor;
+layout (location = 1) in vec2 fragUv;
+layout (location = 2) in vec3 fragPositionWorld;
+layout (location = 3) in vec3 fragNormalWorld;
+
+layout (location = 0) out vec4 outColor;
+
+// BindlessSet::TEXTURE_BINDING
+layout(set = 1, binding = 0) uniform sampler2D textures[];
+
+layout(push_constant) uniform Push {
+    mat4 transform; // Model matrix
+    mat4 normalMatrix; // Only the upper 3x3 is a matrix, [3].x holds the texture index
+} push;
+
+const uint INVALID_INDEX = 0xFFFFFFFFu;
+
+void main() {
+    uint textureIndex = floatBitsToUint(push.normalMatrix[3].x);
+    vec3 color = fragColor;
+    if (textureIndex != INVALID_INDEX) {
+        color *= texture(textures[nonuniformEXT(textureIndex)], fragUv).rgb;
+    }
+    outColor = vec4(shade(color, fragPositionWorld, fragNormalWorld, gl_FragCoord.xy), 1.0);
+}
@@ -0,0 +1,24 @@
+#version 450
+#extension GL_GOOGLE_include_directive : require
+
+#include "lighting.glsl"
+
+layout (location = 0) in vec3 fragColor;
+layout (location = 1) in vec2 fragUv;
+layout (location = 2) in vec3 fragPositionWorld;
+layout (location = 3) in vec3 fragNormalWorld;
+
+layout (location = 0) out vec4 outColor;
+
+// Pushed per draw by RenderSystem on devices without a BindlessSet
+layout(set = 1, binding = 0) uniform sampler2D objectTexture;
+
+layout(push_constant) uniform Push {
+    mat4 transform; // Model matrix
+    mat4 normalMatrix; // Only the upper 3x3 is used
+} push;
+
+void main() {
+    vec3 color = fragColor * texture(objectTexture, fragUv).rgb;
+    outColor = vec4(shade(color, fragPositionWorld, fragNormalWorld, gl_FragCoord.xy), 1.0);
+}
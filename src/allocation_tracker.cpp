@@ -0,0 +1,89 @@
+#include "allocation_tracker.hpp"
+
+#include <atomic>
+
+#ifdef YTVK_TRACK_ALLOCATIONS
+#include <cstdlib>
+#include <new>
+#endif
+
+namespace YTVK
+{
+    namespace
+    {
+        // Constant-initialized, so counting is safe even for allocations made before main
+        thread_local uint64_t threadAllocationCount = 0;
+        thread_local uint64_t threadAllocationBytes = 0;
+        std::atomic<uint64_t> totalAllocationCount{0};
+    }
+
+    bool AllocationTracker::isEnabled()
+    {
+#ifdef YTVK_TRACK_ALLOCATIONS
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    uint64_t AllocationTracker::threadAllocations() { return threadAllocationCount; }
+    uint64_t AllocationTracker::threadBytes() { return threadAllocationBytes; }
+    uint64_t AllocationTracker::totalAllocations() { return totalAllocationCount.load(std::memory_order_relaxed); }
+
+#ifdef YTVK_TRACK_ALLOCATIONS
+    namespace
+    {
+        void *countedAllocate(std::size_t size, std::size_t alignment)
+        {
+            threadAllocationCount++;
+            threadAllocationBytes += size;
+            totalAllocationCount.fetch_add(1, std::memory_order_relaxed);
+
+            if (size == 0)
+            {
+                size = 1;
+            }
+            if (alignment <= alignof(std::max_align_t))
+            {
+                return std::malloc(size);
+            }
+            // aligned_alloc wants a multiple of the alignment
+            return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+        }
+
+        void *countedAllocateOrThrow(std::size_t size, std::size_t alignment)
+        {
+            void *pointer = countedAllocate(size, alignment);
+            if (pointer == nullptr)
+            {
+                throw std::bad_alloc{};
+            }
+            return pointer;
+        }
+    }
+#endif
+}
+
+#ifdef YTVK_TRACK_ALLOCATIONS
+void *operator new(std::size_t size) { return YTVK::countedAllocateOrThrow(size, 0); }
+void *operator new[](std::size_t size) { return YTVK::countedAllocateOrThrow(size, 0); }
+void *operator new(std::size_t size, std::align_val_t alignment) { return YTVK::countedAllocateOrThrow(size, static_cast<std::size_t>(alignment)); }
+void *operator new[](std::size_t size, std::align_val_t alignment) { return YTVK::countedAllocateOrThrow(size, static_cast<std::size_t>(alignment)); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return YTVK::countedAllocate(size, 0); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return YTVK::countedAllocate(size, 0); }
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept { return YTVK::countedAllocate(size, static_cast<std::size_t>(alignment)); }
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept { return YTVK::countedAllocate(size, static_cast<std::size_t>(alignment)); }
+
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete[](void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, std::size_t, std::align_val_t) noexcept { std::free(pointer); }
+void operator delete(void *pointer, const std::nothrow_t &) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::align_val_t, const std::nothrow_t &) noexcept { std::free(pointer); }
+void operator delete[](void *pointer, std::align_val_t, const std::nothrow_t &) noexcept { std::free(pointer); }
+#endif
@@ -1,8 +1,13 @@
 #include "app.hpp"
 #include "render_system.hpp"
+#include "cascaded_shadow_maps.hpp"
 #include "camera.hpp"
 #include "keyboard_movement_controller.hpp"
 #include "buffer.hpp"
+#include "benchmark.hpp"
+#include "trace.hpp"
+#include "allocation_tracker.hpp"
+#include "startup_report.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
@@ -10,30 +15,184 @@
 #include <glm/gtc/constants.hpp>
 
 #include <chrono>
+#include <fstream>
+#include <iostream>
 #include <stdexcept>
+#include <unordered_map>
 
 namespace YTVK
 {
+    // std140, must match shaders/global.glsl
     struct GlobalUBO
     {
         glm::mat4 projectionView{1.0f};
-        glm::vec3 lightDirection = glm::normalize(glm::vec3{1.0f, -3.0f, -1.0f});
+        glm::mat4 view{1.0f};
+        glm::vec4 lightDirection{glm::normalize(glm::vec3{1.0f, -3.0f, -1.0f}), 0.0f};
+        // near, far, projection[0][0], projection[1][1]
+        glm::vec4 clusterParams{};
+        // point light count, framebuffer width, framebuffer height
+        glm::uvec4 lightingInfo{};
+        glm::mat4 cascadeViewProjection[CascadedShadowMaps::CASCADE_COUNT]{};
+        // view depth where each cascade ends
+        glm::vec4 cascadeSplits{};
     };
 
-    App::App() : window(WIDTH, HEIGHT, "Window!"), device{window}, renderer{window, device}, globalPool{}
+    namespace
     {
-        globalPool = DescriptorPool::Builder(device)
-        .setMaxSets(SwapChain::MAX_FRAMES_IN_FLIGHT)
-        .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, SwapChain::MAX_FRAMES_IN_FLIGHT)
+        std::unique_ptr<AssetArchive> openAssetArchive(const char *path)
+        {
+            StartupReport::Phase phase{"asset archive"};
+            if (!std::ifstream(path).good())
+            {
+                return nullptr;
+            }
+
+            auto archive = std::make_unique<AssetArchive>(path);
+            AssetArchive::mount(archive.get());
+            return archive;
+        }
+
+        std::unique_ptr<Window> createWindow(const AppConfig &config)
+        {
+            if (config.headless)
+            {
+                return nullptr;
+            }
+            StartupReport::Phase phase{"window"};
+            return std::make_unique<Window>(static_cast<int>(config.width), static_cast<int>(config.height), "Window!");
+        }
+
+        // "trace.json" -> "trace.spike3.json"
+        std::string spikeTracePath(const std::string &path, uint32_t index)
+        {
+            std::string suffix = ".spike" + std::to_string(index);
+            size_t extension = path.find_last_of('.');
+            if (extension == std::string::npos || extension < path.find_last_of("/\\") + 1)
+            {
+                return path + suffix;
+            }
+            return path.substr(0, extension) + suffix + path.substr(extension);
+        }
+
+        // Averages FrameStats and prints them roughly once per second
+        class FrameStatsReporter
+        {
+        public:
+            void add(const FrameStats &stats, const std::vector<GpuProfiler::Result> &gpuScopes, const std::vector<PipelineStatistics::Result> &pipelineStatistics)
+            {
+                cpuWaitMs += stats.cpuWaitMs;
+                acquireToPresentMs += stats.acquireToPresentMs;
+                if (stats.gpuTimeMs >= 0.0f)
+                {
+                    gpuTimeMs += stats.gpuTimeMs;
+                    gpuSamples++;
+                }
+                frames++;
+
+                auto now = std::chrono::high_resolution_clock::now();
+                if (now - lastReport < std::chrono::seconds(1))
+                {
+                    return;
+                }
+
+                std::cout << "frame " << stats.frameNumber
+                          << ": cpu wait " << cpuWaitMs / frames << " ms"
+                          << ", gpu " << (gpuSamples > 0 ? gpuTimeMs / gpuSamples : 0.0f) << " ms"
+                          << ", acquire to present " << acquireToPresentMs / frames << " ms"
+                          << " (" << frames << " frames)" << std::endl;
+                for (const auto &scope : gpuScopes)
+                {
+                    std::cout << std::string(2 * (scope.depth + 1), ' ') << scope.name << ": " << scope.milliseconds << " ms" << std::endl;
+                }
+                for (const auto &statistics : pipelineStatistics)
+                {
+                    std::cout << "  " << statistics.name << ": " << statistics.inputAssemblyVertices << " ia vertices, "
+                              << statistics.vertexShaderInvocations << " vs invocations, "
+                              << statistics.clippingPrimitives << " clipping primitives, "
+                              << statistics.fragmentShaderInvocations << " fs invocations" << std::endl;
+                }
+
+                *this = FrameStatsReporter{};
+                lastReport = now;
+            }
+
+        private:
+            std::chrono::high_resolution_clock::time_point lastReport = std::chrono::high_resolution_clock::now();
+            float cpuWaitMs = 0.0f;
+            float gpuTimeMs = 0.0f;
+            float acquireToPresentMs = 0.0f;
+            uint32_t gpuSamples = 0;
+            uint32_t frames = 0;
+        };
+    }
+
+    App::App(const AppConfig &config) : config{config}, assetArchive{openAssetArchive(ASSET_ARCHIVE_PATH)}, window{createWindow(config)}, device{window.get()}, renderer{}, descriptorAllocator{}
+    {
+        // Set before anything allocates so the whole instance stays inside its share of the GPU
+        device.memoryTracker().setDeviceLocalLimit(static_cast<VkDeviceSize>(config.vramBudgetMb) * 1024 * 1024);
+
+        {
+            StartupReport::Phase phase{config.headless ? "renderer: offscreen target" : "renderer: swap chain"};
+            if (config.headless)
+            {
+                renderer = std::make_unique<Renderer>(device, VkExtent2D{config.width, config.height}, config.swapChain);
+            }
+            else
+            {
+                renderer = std::make_unique<Renderer>(*window, device, config.swapChain);
+            }
+        }
+
+        renderer->setPipelineStatisticsEnabled(config.pipelineStatistics);
+
+        if (!config.tracePath.empty())
+        {
+            Trace::setEnabled(true);
+            Trace::setThreadName("main");
+        }
+
+        descriptorAllocator = DescriptorAllocator::Builder(device)
+        .setFramesInFlight(renderer->getFramesInFlight())
+        .addPoolSize(VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1.0f)
+        .addPoolSize(VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 2.0f)
+        .addPoolSize(VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f)
         .build();
-        loadGameObjects();
+        layoutCache = std::make_unique<DescriptorLayoutCache>(device);
+        descriptorSetCache = std::make_unique<DescriptorSetCache>(device, *descriptorAllocator);
+        if (device.supportsBindless())
+        {
+            bindlessSet = std::make_unique<BindlessSet>(device);
+        }
+        samplerCache = std::make_unique<SamplerCache>(device);
+        // Streaming swaps bindless slots as mips arrive; loading whole would ignore the requested budget
+        if (config.textureBudgetMb > 0 && !bindlessSet)
+        {
+            throw std::runtime_error("--texture-budget-mb needs descriptor indexing, which this device lacks");
+        }
+        if (config.textureBudgetMb > 0)
+        {
+            textureStreamer = std::make_unique<TextureStreamer>(
+                device, *bindlessSet, *samplerCache, static_cast<VkDeviceSize>(config.textureBudgetMb) * 1024 * 1024);
+        }
+
+        StartupReport::Phase phase{"load scene"};
+        if (config.isBenchmark())
+        {
+            benchmarkScene = std::make_unique<SceneDescription>(SceneDescription::load(config.benchmarkScenePath, config.sceneObjectCount));
+            loadScene(*benchmarkScene);
+        }
+        else
+        {
+            loadGameObjects();
+        }
     }
 
     App::~App() {}
 
     void App::run()
     {
-        std::vector<std::unique_ptr<Buffer>> uboBuffers(SwapChain::MAX_FRAMES_IN_FLIGHT);
+        auto setupPhase = std::make_unique<StartupReport::Phase>("uniform buffers and render systems");
+        std::vector<std::unique_ptr<Buffer>> uboBuffers(renderer->getFramesInFlight());
         for (int i = 0; i < uboBuffers.size(); ++i)
         {
             uboBuffers[i] = std::make_unique<Buffer>(
@@ -46,66 +205,357 @@ namespace YTVK
         }
 
         auto globalSetLayout = DescriptorSetLayout::Builder(device)
-        .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT)
-        .build();
+        .addBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(ClusteredLighting::LIGHTS_BINDING, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(ClusteredLighting::CLUSTERS_BINDING, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, VK_SHADER_STAGE_FRAGMENT_BIT | VK_SHADER_STAGE_COMPUTE_BIT)
+        .addBinding(CascadedShadowMaps::SHADOW_MAP_BINDING, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+        .build(*layoutCache);
+
+        ClusteredLighting clusteredLighting{device, renderer->getFramesInFlight(), globalSetLayout->getDescriptorSetLayout()};
+        CascadedShadowMaps shadowMaps{device};
+        auto shadowMapInfo = shadowMaps.descriptorInfo();
 
-        std::vector<VkDescriptorSet> globalDescriptorSets{SwapChain::MAX_FRAMES_IN_FLIGHT};
+        std::vector<VkDescriptorSet> globalDescriptorSets(renderer->getFramesInFlight());
         for (int i = 0; i < globalDescriptorSets.size(); ++i)
         {
             auto bufferInfo = uboBuffers[i]->descriptorInfo();
-            DescriptorWriter(*globalSetLayout, *globalPool)
+            auto lightsInfo = clusteredLighting.lightsDescriptorInfo(i);
+            auto clustersInfo = clusteredLighting.clustersDescriptorInfo(i);
+            DescriptorWriter(*globalSetLayout, *descriptorAllocator)
             .writeBuffer(0, &bufferInfo)
-            .build(globalDescriptorSets[i]);
+            .writeBuffer(ClusteredLighting::LIGHTS_BINDING, &lightsInfo)
+            .writeBuffer(ClusteredLighting::CLUSTERS_BINDING, &clustersInfo)
+            .writeImage(CascadedShadowMaps::SHADOW_MAP_BINDING, &shadowMapInfo)
+            .build(globalDescriptorSets[i], *descriptorSetCache);
         }
 
-        RenderSystem renderSystem{device, renderer.getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout()};
+        RenderSystem renderSystem{device, renderer->getSwapChainRenderPass(), globalSetLayout->getDescriptorSetLayout(), bindlessSet.get(), config.depthPrepass};
+        if (bindlessSet == nullptr)
+        {
+            std::vector<VkDescriptorImageInfo> textureInfos;
+            for (const auto &texture : textures)
+            {
+                textureInfos.push_back(texture->descriptorInfo());
+            }
+            renderSystem.setTextures(std::move(textureInfos));
+        }
         Camera camera{};
 
         auto viewerObject = GameObject::createGameObject();
         KeyboardMovementController cameraController{};
 
+        FrameStatsReporter statsReporter{};
+        BenchmarkRecorder benchmarkRecorder{config.benchmarkWarmupFrames};
         auto currentTime = std::chrono::high_resolution_clock::now();
 
-        while (!window.shouldClose())
+        uint32_t frameLimit = config.frameCount;
+        if (benchmarkScene && frameLimit == 0)
         {
-            // Check GLFW for events
-            glfwPollEvents();
+            frameLimit = benchmarkScene->frameCount;
+        }
+
+        // Spike traces are capped so a badly stuttering run cannot fill the disk
+        constexpr uint32_t MAX_SPIKE_TRACES = 10;
+        // The first frames include pipeline and swap chain warm-up and are always slow
+        constexpr uint32_t SPIKE_GRACE_FRAMES = 10;
+        uint32_t spikeTraces = 0;
+        bool traceKeyDown = false;
+
+        // Also the depth range of the light clusters
+        constexpr float NEAR_PLANE = 0.1f;
+        constexpr float FAR_PLANE = 10.0f;
+
+        constexpr auto MEMORY_REPORT_INTERVAL = std::chrono::seconds(5);
+        auto lastMemoryReport = currentTime;
+        auto printMemoryStats = [&]()
+        {
+            device.memoryReport().print(std::cout);
+            if (textureStreamer)
+            {
+                std::cout << "  texture streaming: " << textureStreamer->getResidentBytes() / (1024 * 1024) << " of "
+                          << textureStreamer->getBudgetBytes() / (1024 * 1024) << " MiB resident ("
+                          << textureStreamer->getTextureCount() << " textures)" << std::endl;
+            }
+        };
+
+        setupPhase.reset();
+
+        uint32_t framesRendered = 0;
+        // Set by --check-allocations; thrown only once the GPU is done with this function's resources
+        std::string allocationFailure{};
+        auto shouldStop = [&]()
+        {
+            if (frameLimit > 0 && framesRendered >= frameLimit)
+            {
+                return true;
+            }
+            return window != nullptr && window->shouldClose();
+        };
+
+        while (!shouldStop())
+        {
+            YTVK_TRACE_SCOPE("App::run frame");
 
             auto newTime = std::chrono::high_resolution_clock::now();
             float frameTime = std::chrono::duration<float, std::chrono::seconds::period>(newTime - currentTime).count();
             currentTime = newTime;
 
-            cameraController.moveInPlaneXZ(window.getGLFWwindow(), frameTime, viewerObject);
+            // frameTime covers the whole previous iteration, whose zones are all closed by now
+            if (config.traceSpikeMs > 0.0f && framesRendered > SPIKE_GRACE_FRAMES &&
+                frameTime * 1000.0f > config.traceSpikeMs && spikeTraces < MAX_SPIKE_TRACES)
+            {
+                std::string path = spikeTracePath(config.tracePath, spikeTraces++);
+                Trace::writeChromeJson(path);
+                std::cout << "frame took " << frameTime * 1000.0f << " ms, trace written to " << path << std::endl;
+            }
+
+            if (window != nullptr)
+            {
+                // Check GLFW for events
+                glfwPollEvents();
+
+                bool keyDown = glfwGetKey(window->getGLFWwindow(), GLFW_KEY_F12) == GLFW_PRESS;
+                if (keyDown && !traceKeyDown && Trace::isEnabled())
+                {
+                    Trace::writeChromeJson(config.tracePath);
+                    std::cout << "trace written to " << config.tracePath << std::endl;
+                }
+                traceKeyDown = keyDown;
+            }
+
+            if (benchmarkScene)
+            {
+                // Replayed by frame number with a fixed time step so every run sees the same frames
+                frameTime = 1.0f / 60.0f;
+                float t = frameLimit > 1 ? static_cast<float>(framesRendered) / static_cast<float>(frameLimit - 1) : 0.0f;
+                auto key = benchmarkScene->sampleCamera(t);
+                viewerObject.transform.translation = key.translation;
+                viewerObject.transform.rotation = key.rotation;
+            }
+            else if (window != nullptr)
+            {
+                cameraController.moveInPlaneXZ(window->getGLFWwindow(), frameTime, viewerObject);
+            }
+            for (const auto &moving : movingObjects)
+            {
+                gameObjects[moving.index].transform.rotation += moving.spin * frameTime;
+            }
+
             camera.setViewYXZ(viewerObject.transform.translation, viewerObject.transform.rotation);
 
-            float aspect = renderer.getAspectRation();
-            camera.setPerspectiveProjection(glm::radians(50.0f), aspect, 0.1f, 10.0f);
+            float aspect = renderer->getAspectRation();
+            camera.setPerspectiveProjection(glm::radians(50.0f), aspect, NEAR_PLANE, FAR_PLANE);
 
-            if (auto commandBuffer = renderer.beginFrame())
+            // Covers streaming, recording and submission; reporting below may allocate
+            AllocationTracker::Scope frameAllocations{};
+            if (textureStreamer)
             {
-                int frameIndex = renderer.getCurrentFrameIndex();
+                textureStreamer->update(camera, static_cast<float>(renderer->getExtent().height), gameObjects);
+            }
+
+            if (auto commandBuffer = renderer->beginFrame())
+            {
+                int frameIndex = renderer->getCurrentFrameIndex();
+                descriptorAllocator->beginFrame(frameIndex);
                 FrameInfo frameInfo{
                     frameIndex,
                     frameTime,
                     commandBuffer,
                     camera,
-                    globalDescriptorSets[frameIndex]
+                    globalDescriptorSets[frameIndex],
+                    renderer->getProfiler(),
+                    renderer->getPipelineStatistics(),
+                    *descriptorAllocator
                 };
                 GlobalUBO ubo{};
+                shadowMaps.update(camera, NEAR_PLANE, FAR_PLANE, glm::vec3{ubo.lightDirection}, gameObjects);
+                const auto &cascades = shadowMaps.getCascades();
+                for (uint32_t i = 0; i < CascadedShadowMaps::CASCADE_COUNT; ++i)
+                {
+                    ubo.cascadeViewProjection[i] = cascades[i].viewProjection;
+                    ubo.cascadeSplits[i] = cascades[i].splitDepth;
+                }
                 ubo.projectionView = camera.getProjection() * camera.getView();
+                ubo.view = camera.getView();
+                ubo.clusterParams = {NEAR_PLANE, FAR_PLANE, camera.getProjection()[0][0], camera.getProjection()[1][1]};
+                VkExtent2D extent = renderer->getExtent();
+                ubo.lightingInfo = {clusteredLighting.writeLights(frameIndex, pointLights), extent.width, extent.height, 0};
                 uboBuffers[frameIndex]->writeToBuffer(&ubo);
                 uboBuffers[frameIndex]->flush();
 
-                renderer.beginSwapChainRenderPass(commandBuffer);
+                clusteredLighting.cullLights(frameInfo);
+                shadowMaps.render(frameInfo, gameObjects);
+
+                renderSystem.sortDraws(frameInfo, gameObjects);
+                renderer->beginSwapChainRenderPass(commandBuffer);
+                renderSystem.renderDepthPrepass(frameInfo, gameObjects);
+                renderer->beginMainSubpass(commandBuffer);
                 renderSystem.renderGameObjects(frameInfo, gameObjects);
-                renderer.endSwapChainRenderPass(commandBuffer);
-                renderer.endFrame();
+                renderer->endSwapChainRenderPass(commandBuffer);
+                renderer->endFrame();
+                framesRendered++;
+
+                if (framesRendered == 1)
+                {
+                    finishStartupReport();
+                }
+
+                if (config.checkAllocations && framesRendered > config.benchmarkWarmupFrames && frameAllocations.allocations() > 0)
+                {
+                    allocationFailure = "frame " + std::to_string(framesRendered) + " made " + std::to_string(frameAllocations.allocations()) +
+                                        " heap allocations (" + std::to_string(frameAllocations.bytes()) + " bytes) after warm-up";
+                    break;
+                }
+
+                if (config.printFrameStats)
+                {
+                    statsReporter.add(renderer->getFrameStats(), renderer->getProfiler().getResults(), renderer->getPipelineStatistics().getResults());
+                }
+                if (config.printMemoryStats && newTime - lastMemoryReport >= MEMORY_REPORT_INTERVAL)
+                {
+                    printMemoryStats();
+                    lastMemoryReport = newTime;
+                }
+                if (benchmarkScene)
+                {
+                    float cpuFrameMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - newTime).count();
+                    benchmarkRecorder.add(renderer->getFrameStats(), cpuFrameMs);
+                    auto &statistics = renderer->getPipelineStatistics();
+                    benchmarkRecorder.addPipelineStatistics(statistics.getResults(), statistics.getResultsFrameNumber());
+                }
             }
         }
 
+        if (!allocationFailure.empty())
+        {
+            vkDeviceWaitIdle(device.device());
+            throw std::runtime_error(allocationFailure);
+        }
+
+        if (benchmarkScene)
+        {
+            benchmarkRecorder.printSummary();
+            benchmarkRecorder.write(config.benchmarkOutputPath, {
+                {"scene", benchmarkScene->path},
+                {"frames", std::to_string(framesRendered)},
+                {"warmup_frames", std::to_string(config.benchmarkWarmupFrames)},
+                {"objects", std::to_string(gameObjects.size())},
+                {"moving_objects", std::to_string(movingObjects.size())},
+                {"point_lights", std::to_string(pointLights.size())},
+                {"frames_in_flight", std::to_string(renderer->getFramesInFlight())},
+                {"present_mode", config.headless ? "offscreen" : presentModeName(config.swapChain.presentMode)},
+                {"depth_prepass", std::string{AppConfig::depthPrepassModeName(config.depthPrepass)} + (renderSystem.isDepthPrepassActive() ? " (active)" : " (inactive)")},
+                {"extent", std::to_string(config.width) + "x" + std::to_string(config.height)},
+                {"device", device.properties.deviceName},
+            });
+            std::cout << "benchmark results written to " << config.benchmarkOutputPath << std::endl;
+        }
+
+        if (config.printMemoryStats)
+        {
+            printMemoryStats();
+        }
+
+        if (!config.capturePath.empty())
+        {
+            renderer->saveLastFrame(config.capturePath);
+        }
+
+        if (Trace::isEnabled())
+        {
+            Trace::writeChromeJson(config.tracePath);
+            std::cout << "trace written to " << config.tracePath << std::endl;
+        }
+
         vkDeviceWaitIdle(device.device());
     };
 
+    void App::finishStartupReport()
+    {
+        bool reporting = config.printStartupReport || !config.startupReportPath.empty();
+        if (reporting)
+        {
+            // Time to first frame means on screen, not just submitted
+            device.waitForTimelineValue(renderer->getLastFrameTimelineValue());
+        }
+
+        StartupReport::Allocations allocations{};
+        for (const auto &category : device.memoryReport().categories)
+        {
+            allocations.gpuAllocations += category.allocations;
+            allocations.gpuBytes += category.bytes;
+        }
+        allocations.heapAllocations = AllocationTracker::totalAllocations();
+        StartupReport::finish(allocations);
+
+        if (config.printStartupReport)
+        {
+            StartupReport::print(std::cout);
+        }
+        if (!config.startupReportPath.empty())
+        {
+            StartupReport::writeJson(config.startupReportPath);
+            std::cout << "startup report written to " << config.startupReportPath << std::endl;
+        }
+    }
+
+    void App::loadScene(const SceneDescription &scene)
+    {
+        // Objects sharing a model path share the Model
+        std::vector<std::shared_ptr<Model>> models;
+        for (const auto &modelPath : scene.models)
+        {
+            models.push_back(Model::createModelFromFile(device, modelPath));
+        }
+
+        // All textures share one staging submission, which the first frame is ordered after
+        // Without descriptor indexing an object's texture index is its place in textures, see RenderSystem::setTextures
+        std::vector<uint32_t> textureIndices;
+        if (!scene.textures.empty())
+        {
+            UploadBatch uploads{device};
+            for (const auto &texturePath : scene.textures)
+            {
+                if (textureStreamer)
+                {
+                    textureIndices.push_back(textureStreamer->addTexture(texturePath, uploads));
+                    continue;
+                }
+                textures.push_back(Texture::createTextureFromFile(device, uploads, *samplerCache, texturePath));
+                textureIndices.push_back(bindlessSet ? textures.back()->registerBindless(*bindlessSet) : static_cast<uint32_t>(textures.size() - 1));
+            }
+            uploads.submit();
+        }
+
+        gameObjects.reserve(gameObjects.size() + scene.objects.size());
+        for (const auto &object : scene.objects)
+        {
+            auto gameObject = GameObject::createGameObject();
+            gameObject.model = models[object.model];
+            gameObject.transform = object.transform;
+            if (object.texture != SceneDescription::NO_TEXTURE && !textureIndices.empty())
+            {
+                gameObject.textureIndex = textureIndices[object.texture];
+            }
+            if (object.spin != glm::vec3{0.0f})
+            {
+                gameObject.isStatic = false;
+                movingObjects.push_back({gameObjects.size(), object.spin});
+            }
+            gameObjects.push_back(std::move(gameObject));
+        }
+
+        pointLights.reserve(pointLights.size() + scene.lights.size());
+        for (const auto &light : scene.lights)
+        {
+            pointLights.push_back({glm::vec4{light.position, light.radius}, glm::vec4{light.color, 1.0f}});
+        }
+        if (pointLights.size() > ClusteredLighting::MAX_LIGHTS)
+        {
+            std::cout << "scene has " << pointLights.size() << " point lights, only the first " << ClusteredLighting::MAX_LIGHTS << " are used" << std::endl;
+        }
+    }
+
     void App::loadGameObjects()
     {
         std::shared_ptr<Model> flatVaseModel = Model::createModelFromFile(device, "models/flat_vase.obj");
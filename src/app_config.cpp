@@ -0,0 +1,193 @@
+#include "app_config.hpp"
+#include "allocation_tracker.hpp"
+
+#include <cstdint>
+#include <stdexcept>
+
+namespace YTVK
+{
+    namespace
+    {
+        VkPresentModeKHR parsePresentMode(const std::string &name)
+        {
+            if (name == "fifo")
+                return VK_PRESENT_MODE_FIFO_KHR;
+            if (name == "fifo-relaxed")
+                return VK_PRESENT_MODE_FIFO_RELAXED_KHR;
+            if (name == "mailbox")
+                return VK_PRESENT_MODE_MAILBOX_KHR;
+            if (name == "immediate")
+                return VK_PRESENT_MODE_IMMEDIATE_KHR;
+
+            throw std::runtime_error("unknown present mode: " + name);
+        }
+
+        DepthPrepassMode parseDepthPrepassMode(const std::string &name)
+        {
+            if (name == "on")
+                return DepthPrepassMode::On;
+            if (name == "off")
+                return DepthPrepassMode::Off;
+            if (name == "auto")
+                return DepthPrepassMode::Auto;
+
+            throw std::runtime_error("unknown depth prepass mode: " + name);
+        }
+
+        uint32_t parseCount(const std::string &arg, const std::string &value)
+        {
+            size_t parsed = 0;
+            long count = -1;
+            try
+            {
+                count = std::stol(value, &parsed);
+            }
+            catch (const std::exception &)
+            {
+                parsed = 0;
+            }
+
+            if (parsed != value.size() || count < 0 || count > UINT32_MAX)
+            {
+                throw std::runtime_error("invalid value for " + arg + ": " + value);
+            }
+            return static_cast<uint32_t>(count);
+        }
+
+        uint32_t parseFramesInFlight(const std::string &value)
+        {
+            size_t parsed = 0;
+            int frames = 0;
+            try
+            {
+                frames = std::stoi(value, &parsed);
+            }
+            catch (const std::exception &)
+            {
+                parsed = 0;
+            }
+
+            if (parsed != value.size() || frames < 1 || frames > SwapChain::MAX_FRAMES_IN_FLIGHT)
+            {
+                throw std::runtime_error("frames in flight must be between 1 and " + std::to_string(SwapChain::MAX_FRAMES_IN_FLIGHT));
+            }
+            return static_cast<uint32_t>(frames);
+        }
+    }
+
+    AppConfig AppConfig::fromCommandLine(int argc, char **argv)
+    {
+        AppConfig config{};
+
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            auto value = [&]() -> std::string
+            {
+                if (i + 1 >= argc)
+                {
+                    throw std::runtime_error("missing value for " + arg);
+                }
+                return argv[++i];
+            };
+
+            if (arg == "--frames-in-flight")
+                config.swapChain.framesInFlight = parseFramesInFlight(value());
+            else if (arg == "--present-mode")
+                config.swapChain.presentMode = parsePresentMode(value());
+            else if (arg == "--frame-stats")
+                config.printFrameStats = true;
+            else if (arg == "--headless")
+                config.headless = true;
+            else if (arg == "--width")
+                config.width = parseCount(arg, value());
+            else if (arg == "--height")
+                config.height = parseCount(arg, value());
+            else if (arg == "--frames")
+                config.frameCount = parseCount(arg, value());
+            else if (arg == "--capture")
+                config.capturePath = value();
+            else if (arg == "--benchmark")
+                config.benchmarkScenePath = value();
+            else if (arg == "--benchmark-output")
+                config.benchmarkOutputPath = value();
+            else if (arg == "--warmup")
+                config.benchmarkWarmupFrames = parseCount(arg, value());
+            else if (arg == "--scene-objects")
+                config.sceneObjectCount = parseCount(arg, value());
+            else if (arg == "--pipeline-stats")
+                config.pipelineStatistics = true;
+            else if (arg == "--trace")
+                config.tracePath = value();
+            else if (arg == "--trace-spike-ms")
+                config.traceSpikeMs = static_cast<float>(parseCount(arg, value()));
+            else if (arg == "--memory-stats")
+                config.printMemoryStats = true;
+            else if (arg == "--vram-budget-mb")
+                config.vramBudgetMb = parseCount(arg, value());
+            else if (arg == "--texture-budget-mb")
+                config.textureBudgetMb = parseCount(arg, value());
+            else if (arg == "--startup-report")
+                config.printStartupReport = true;
+            else if (arg == "--startup-json")
+                config.startupReportPath = value();
+            else if (arg == "--depth-prepass")
+                config.depthPrepass = parseDepthPrepassMode(value());
+            else if (arg == "--check-allocations")
+                config.checkAllocations = true;
+            else
+                throw std::runtime_error("unknown argument: " + arg + "\n" + usage());
+        }
+
+        if (config.width == 0 || config.height == 0)
+        {
+            throw std::runtime_error("width and height must be greater than zero");
+        }
+        if (!config.capturePath.empty() && !config.headless)
+        {
+            throw std::runtime_error("--capture requires --headless");
+        }
+        if (config.sceneObjectCount > 0 && !config.isBenchmark())
+        {
+            throw std::runtime_error("--scene-objects requires --benchmark");
+        }
+        if (config.traceSpikeMs > 0.0f && config.tracePath.empty())
+        {
+            throw std::runtime_error("--trace-spike-ms requires --trace");
+        }
+        if (config.checkAllocations && !AllocationTracker::isEnabled())
+        {
+            throw std::runtime_error("--check-allocations requires a build with -DYTVK_TRACK_ALLOCATIONS");
+        }
+        // Benchmarks take their length from the scene unless --frames overrides it
+        if (config.headless && config.frameCount == 0 && !config.isBenchmark())
+        {
+            config.frameCount = 1;
+        }
+
+        return config;
+    }
+
+    std::string AppConfig::usage()
+    {
+        return "usage: main [--frames-in-flight 1-4] [--present-mode fifo|fifo-relaxed|mailbox|immediate] [--frame-stats]\n"
+               "            [--width W] [--height H] [--frames N] [--headless [--capture out.ppm]]\n"
+               "            [--benchmark scene [--benchmark-output out.json|out.csv] [--warmup N] [--scene-objects N]]\n"
+               "            [--trace out.json [--trace-spike-ms MS]] [--pipeline-stats]\n"
+               "            [--memory-stats] [--vram-budget-mb MB] [--texture-budget-mb MB] [--check-allocations]\n"
+               "            [--startup-report] [--startup-json out.json] [--depth-prepass on|off|auto]";
+    }
+
+    const char *AppConfig::depthPrepassModeName(DepthPrepassMode mode)
+    {
+        switch (mode)
+        {
+        case DepthPrepassMode::On:
+            return "on";
+        case DepthPrepassMode::Off:
+            return "off";
+        default:
+            return "auto";
+        }
+    }
+}
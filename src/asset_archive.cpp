@@ -0,0 +1,458 @@
+#include "asset_archive.hpp"
+#include "startup_report.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace YTVK
+{
+    namespace
+    {
+        constexpr size_t MIN_MATCH = 4;
+        constexpr size_t MAX_OFFSET = 0xFFFF;
+        constexpr uint32_t HASH_BITS = 14;
+
+        AssetArchive *mountedArchive = nullptr;
+
+        // offset + size <= limit, without the addition overflowing
+        bool rangeFits(uint64_t offset, uint64_t size, uint64_t limit)
+        {
+            return offset <= limit && size <= limit - offset;
+        }
+
+        uint64_t alignUp(uint64_t value, uint64_t alignment)
+        {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+
+        void writeLength(std::vector<char> &out, size_t length)
+        {
+            while (length >= 255)
+            {
+                out.push_back(static_cast<char>(255));
+                length -= 255;
+            }
+            out.push_back(static_cast<char>(length));
+        }
+
+        size_t readLength(const unsigned char *&ip, const unsigned char *end)
+        {
+            size_t length = 0;
+            unsigned char byte = 255;
+            while (byte == 255)
+            {
+                if (ip >= end)
+                {
+                    throw std::runtime_error("corrupt compressed asset");
+                }
+                byte = *ip++;
+                length += byte;
+            }
+            return length;
+        }
+
+        void emitSequence(
+            std::vector<char> &out, const char *literals, size_t literalCount, size_t offset, size_t matchLength)
+        {
+            size_t matchCode = matchLength >= MIN_MATCH ? matchLength - MIN_MATCH : 0;
+            unsigned char token = static_cast<unsigned char>(
+                (std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15));
+            out.push_back(static_cast<char>(token));
+
+            if (literalCount >= 15)
+            {
+                writeLength(out, literalCount - 15);
+            }
+            out.insert(out.end(), literals, literals + literalCount);
+
+            if (matchLength == 0)
+            {
+                return;
+            }
+
+            out.push_back(static_cast<char>(offset & 0xFF));
+            out.push_back(static_cast<char>((offset >> 8) & 0xFF));
+            if (matchCode >= 15)
+            {
+                writeLength(out, matchCode - 15);
+            }
+        }
+    }
+
+    // *************** Archive Writer *********************
+
+    AssetArchive::Writer &AssetArchive::Writer::addFile(
+        const std::string &archivePath, const std::string &sourcePath, bool compress)
+    {
+        return addData(archivePath, readFile(sourcePath), compress);
+    }
+
+    AssetArchive::Writer &AssetArchive::Writer::addData(
+        const std::string &archivePath, std::vector<char> data, bool compress)
+    {
+        entries.push_back({archivePath, std::move(data), compress});
+        return *this;
+    }
+
+    void AssetArchive::Writer::write(const std::string &outputPath) const
+    {
+        std::vector<Entry> directory{};
+        std::string strings{};
+        std::vector<char> blobs{};
+
+        uint64_t cursor = alignUp(sizeof(Header), BLOB_ALIGNMENT);
+
+        for (const auto &pending : entries)
+        {
+            Entry entry{};
+            entry.pathHash = hashPath(pending.path);
+            entry.rawSize = pending.data.size();
+            entry.pathOffset = static_cast<uint32_t>(strings.size());
+            entry.pathLength = static_cast<uint32_t>(pending.path.size());
+            strings += pending.path;
+
+            std::vector<char> compressed{};
+            if (pending.compress)
+            {
+                compressed = compressLZ(pending.data.data(), pending.data.size());
+            }
+
+            // Only keep the compressed form if it actually pays for itself
+            bool useCompressed = pending.compress && compressed.size() < pending.data.size();
+            const std::vector<char> &stored = useCompressed ? compressed : pending.data;
+
+            entry.compression = static_cast<uint32_t>(useCompressed ? Compression::LZ : Compression::None);
+            entry.size = stored.size();
+            entry.offset = cursor;
+
+            blobs.resize(cursor - alignUp(sizeof(Header), BLOB_ALIGNMENT), 0);
+            blobs.insert(blobs.end(), stored.begin(), stored.end());
+            cursor = alignUp(cursor + stored.size(), BLOB_ALIGNMENT);
+
+            directory.push_back(entry);
+        }
+
+        std::sort(directory.begin(), directory.end(), [](const Entry &a, const Entry &b)
+                  { return a.pathHash < b.pathHash; });
+
+        Header header{};
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.entryCount = static_cast<uint32_t>(directory.size());
+        header.directoryOffset = cursor;
+        header.stringsOffset = cursor + directory.size() * sizeof(Entry);
+        header.stringsSize = strings.size();
+
+        std::ofstream file(outputPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("failed to open file " + outputPath);
+        }
+
+        std::vector<char> padding(alignUp(sizeof(Header), BLOB_ALIGNMENT) - sizeof(Header), 0);
+        file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+        file.write(padding.data(), padding.size());
+
+        blobs.resize(cursor - alignUp(sizeof(Header), BLOB_ALIGNMENT), 0);
+        file.write(blobs.data(), blobs.size());
+        file.write(reinterpret_cast<const char *>(directory.data()), directory.size() * sizeof(Entry));
+        file.write(strings.data(), strings.size());
+
+        if (!file)
+        {
+            throw std::runtime_error("failed to write archive " + outputPath);
+        }
+    }
+
+    // *************** Archive *********************
+
+    AssetArchive::AssetArchive(const std::string &path) : path{path}
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::runtime_error("failed to open archive " + path);
+        }
+
+        struct stat fileStat{};
+        if (fstat(fd, &fileStat) != 0 || static_cast<size_t>(fileStat.st_size) < sizeof(Header))
+        {
+            ::close(fd);
+            throw std::runtime_error("invalid archive " + path);
+        }
+
+        mappingSize = static_cast<size_t>(fileStat.st_size);
+        void *mapped = mmap(nullptr, mappingSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+
+        if (mapped == MAP_FAILED)
+        {
+            throw std::runtime_error("failed to map archive " + path);
+        }
+        mapping = static_cast<const char *>(mapped);
+
+        header = reinterpret_cast<const Header *>(mapping);
+        bool valid = header->magic == MAGIC && header->version == VERSION &&
+                     header->entryCount <= mappingSize / sizeof(Entry) &&
+                     header->directoryOffset % alignof(Entry) == 0 &&
+                     rangeFits(header->directoryOffset, uint64_t{header->entryCount} * sizeof(Entry), mappingSize) &&
+                     rangeFits(header->stringsOffset, header->stringsSize, mappingSize);
+
+        // Every entry is checked once here so find(), view() and read() can trust the directory
+        if (valid)
+        {
+            entries = reinterpret_cast<const Entry *>(mapping + header->directoryOffset);
+            strings = mapping + header->stringsOffset;
+            for (uint32_t i = 0; i < header->entryCount && valid; ++i)
+            {
+                const Entry &entry = entries[i];
+                bool stored = entry.compression == static_cast<uint32_t>(Compression::None) ||
+                              entry.compression == static_cast<uint32_t>(Compression::LZ);
+                bool sizes = entry.compression != static_cast<uint32_t>(Compression::None) || entry.size == entry.rawSize;
+                // view() hands blobs out in place, and SPIR-V pCode must be 4-byte aligned
+                valid = stored && sizes && entry.offset % BLOB_ALIGNMENT == 0 &&
+                        rangeFits(entry.offset, entry.size, mappingSize) &&
+                        rangeFits(entry.pathOffset, entry.pathLength, header->stringsSize);
+            }
+        }
+
+        if (!valid)
+        {
+            munmap(const_cast<char *>(mapping), mappingSize);
+            throw std::runtime_error("invalid archive " + path);
+        }
+    }
+
+    AssetArchive::~AssetArchive()
+    {
+        if (mountedArchive == this)
+        {
+            mountedArchive = nullptr;
+        }
+        munmap(const_cast<char *>(mapping), mappingSize);
+    }
+
+    const AssetArchive::Entry *AssetArchive::find(const std::string &path) const
+    {
+        uint64_t hash = hashPath(path);
+        const Entry *end = entries + header->entryCount;
+        const Entry *it = std::lower_bound(entries, end, hash, [](const Entry &entry, uint64_t value)
+                                           { return entry.pathHash < value; });
+
+        // Adjacent entries share a hash only on collision, so compare the stored path too
+        for (; it != end && it->pathHash == hash; ++it)
+        {
+            if (it->pathLength == path.size() &&
+                std::memcmp(strings + it->pathOffset, path.data(), path.size()) == 0)
+            {
+                return it;
+            }
+        }
+        return nullptr;
+    }
+
+    AssetView AssetArchive::view(const std::string &path) const
+    {
+        const Entry *entry = find(path);
+        if (entry == nullptr || entry->compression != static_cast<uint32_t>(Compression::None))
+        {
+            return {};
+        }
+        return {mapping + entry->offset, static_cast<size_t>(entry->size)};
+    }
+
+    std::vector<char> AssetArchive::read(const std::string &path) const
+    {
+        const Entry *entry = find(path);
+        if (entry == nullptr)
+        {
+            throw std::runtime_error("asset not found in archive: " + path);
+        }
+
+        std::vector<char> data(entry->rawSize);
+        if (entry->compression == static_cast<uint32_t>(Compression::LZ))
+        {
+            decompressLZ(mapping + entry->offset, entry->size, data.data(), data.size());
+        }
+        else if (entry->size > 0)
+        {
+            std::memcpy(data.data(), mapping + entry->offset, entry->size);
+        }
+        return data;
+    }
+
+    uint64_t AssetArchive::hashPath(const std::string &path)
+    {
+        return hashBytes(path.data(), path.size());
+    }
+
+    uint64_t AssetArchive::hashBytes(const char *data, size_t size, uint64_t seed)
+    {
+        // 64-bit FNV-1a
+        uint64_t hash = seed;
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= static_cast<unsigned char>(data[i]);
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    void AssetArchive::mount(AssetArchive *archive)
+    {
+        mountedArchive = archive;
+    }
+
+    AssetArchive *AssetArchive::mounted()
+    {
+        return mountedArchive;
+    }
+
+    AssetView AssetArchive::load(const std::string &path, std::vector<char> &storage)
+    {
+        if (mountedArchive != nullptr)
+        {
+            if (AssetView data = mountedArchive->view(path))
+            {
+                StartupReport::addFileRead(data.size);
+                return data;
+            }
+            if (mountedArchive->contains(path))
+            {
+                storage = mountedArchive->read(path);
+                StartupReport::addFileRead(storage.size());
+                return {storage.data(), storage.size()};
+            }
+        }
+
+        storage = readFile(path);
+        StartupReport::addFileRead(storage.size());
+        return {storage.data(), storage.size()};
+    }
+
+    std::vector<char> AssetArchive::readFile(const std::string &path)
+    {
+        std::ifstream file(path, std::ios::ate | std::ios::binary);
+
+        if (!file.is_open())
+        {
+            throw std::runtime_error("failed to open file " + path);
+        }
+
+        std::vector<char> buffer(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(buffer.data(), buffer.size());
+        return buffer;
+    }
+
+    // *************** LZ Codec *********************
+
+    std::vector<char> AssetArchive::compressLZ(const char *data, size_t size)
+    {
+        std::vector<char> out{};
+        out.reserve(size / 2 + 16);
+
+        std::vector<int64_t> table(size_t{1} << HASH_BITS, -1);
+        size_t anchor = 0;
+        size_t i = 0;
+
+        while (i + MIN_MATCH <= size)
+        {
+            uint32_t sequence;
+            std::memcpy(&sequence, data + i, sizeof(sequence));
+            uint32_t slot = (sequence * 2654435761u) >> (32 - HASH_BITS);
+
+            int64_t candidate = table[slot];
+            table[slot] = static_cast<int64_t>(i);
+
+            if (candidate >= 0 && i - candidate <= MAX_OFFSET &&
+                std::memcmp(data + candidate, data + i, MIN_MATCH) == 0)
+            {
+                size_t matchLength = MIN_MATCH;
+                while (i + matchLength < size && data[candidate + matchLength] == data[i + matchLength])
+                {
+                    ++matchLength;
+                }
+
+                emitSequence(out, data + anchor, i - anchor, i - candidate, matchLength);
+                i += matchLength;
+                anchor = i;
+            }
+            else
+            {
+                ++i;
+            }
+        }
+
+        emitSequence(out, data + anchor, size - anchor, 0, 0);
+        return out;
+    }
+
+    void AssetArchive::decompressLZ(const char *data, size_t size, char *out, size_t outSize)
+    {
+        const unsigned char *ip = reinterpret_cast<const unsigned char *>(data);
+        const unsigned char *end = ip + size;
+        size_t op = 0;
+
+        while (ip < end)
+        {
+            unsigned char token = *ip++;
+
+            size_t literalCount = token >> 4;
+            if (literalCount == 15)
+            {
+                literalCount += readLength(ip, end);
+            }
+            if (literalCount > static_cast<size_t>(end - ip) || op + literalCount > outSize)
+            {
+                throw std::runtime_error("corrupt compressed asset");
+            }
+            std::memcpy(out + op, ip, literalCount);
+            ip += literalCount;
+            op += literalCount;
+
+            // The final sequence carries literals only
+            if (ip == end)
+            {
+                break;
+            }
+
+            if (end - ip < 2)
+            {
+                throw std::runtime_error("corrupt compressed asset");
+            }
+            size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+            ip += 2;
+
+            size_t matchLength = token & 0x0F;
+            if (matchLength == 15)
+            {
+                matchLength += readLength(ip, end);
+            }
+            matchLength += MIN_MATCH;
+
+            if (offset == 0 || offset > op || op + matchLength > outSize)
+            {
+                throw std::runtime_error("corrupt compressed asset");
+            }
+
+            // Byte-wise copy on purpose: matches may overlap their own output
+            for (size_t k = 0; k < matchLength; ++k, ++op)
+            {
+                out[op] = out[op - offset];
+            }
+        }
+
+        if (op != outSize)
+        {
+            throw std::runtime_error("corrupt compressed asset");
+        }
+    }
+}
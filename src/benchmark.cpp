@@ -0,0 +1,203 @@
+#include "benchmark.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+
+namespace YTVK
+{
+    namespace
+    {
+        void writeSummaryJson(std::ostream &out, const char *name, const BenchmarkRecorder::Summary &summary)
+        {
+            out << "    \"" << name << "\": {"
+                << "\"count\": " << summary.count
+                << ", \"mean\": " << summary.mean
+                << ", \"p50\": " << summary.p50
+                << ", \"p95\": " << summary.p95
+                << ", \"p99\": " << summary.p99
+                << ", \"max\": " << summary.max << "}";
+        }
+    }
+
+    void BenchmarkRecorder::add(const FrameStats &stats, float frameMs)
+    {
+        if (framesSeen++ < warmupFrames)
+        {
+            return;
+        }
+
+        frames.push_back({stats.frameNumber, frameMs, stats.cpuWaitMs});
+        if (stats.gpuTimeMs < 0.0f)
+        {
+            return;
+        }
+
+        // The result belongs to a frame a few records back, or to a warm-up frame that was not recorded
+        for (auto frame = frames.rbegin(); frame != frames.rend() && frame->frameNumber >= stats.gpuFrameNumber; ++frame)
+        {
+            if (frame->frameNumber == stats.gpuFrameNumber)
+            {
+                frame->gpuTimeMs = stats.gpuTimeMs;
+                break;
+            }
+        }
+    }
+
+    std::vector<float> BenchmarkRecorder::samples(float FrameRecord::*field) const
+    {
+        std::vector<float> values;
+        values.reserve(frames.size());
+        for (const auto &frame : frames)
+        {
+            if (frame.*field >= 0.0f)
+            {
+                values.push_back(frame.*field);
+            }
+        }
+        return values;
+    }
+
+    void BenchmarkRecorder::addPipelineStatistics(const std::vector<PipelineStatistics::Result> &results, uint64_t frameNumber)
+    {
+        if (framesSeen <= warmupFrames || frameNumber == lastStatisticsFrame)
+        {
+            return;
+        }
+        lastStatisticsFrame = frameNumber;
+
+        for (const auto &result : results)
+        {
+            auto &totals = pipelineStatistics[result.name];
+            totals.frames++;
+            totals.inputAssemblyVertices += result.inputAssemblyVertices;
+            totals.vertexShaderInvocations += result.vertexShaderInvocations;
+            totals.clippingPrimitives += result.clippingPrimitives;
+            totals.fragmentShaderInvocations += result.fragmentShaderInvocations;
+        }
+    }
+
+    BenchmarkRecorder::Summary BenchmarkRecorder::summarize(std::vector<float> samples)
+    {
+        Summary summary{};
+        if (samples.empty())
+        {
+            return summary;
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        // Nearest-rank percentiles, so every reported value is an actual sample
+        auto percentile = [&](float p)
+        {
+            size_t rank = static_cast<size_t>(std::ceil(p / 100.0f * static_cast<float>(samples.size())));
+            return samples[std::clamp<size_t>(rank, 1, samples.size()) - 1];
+        };
+
+        summary.count = static_cast<uint32_t>(samples.size());
+        summary.mean = std::accumulate(samples.begin(), samples.end(), 0.0f) / static_cast<float>(samples.size());
+        summary.p50 = percentile(50.0f);
+        summary.p95 = percentile(95.0f);
+        summary.p99 = percentile(99.0f);
+        summary.max = samples.back();
+        return summary;
+    }
+
+    void BenchmarkRecorder::write(const std::string &path, const Metadata &metadata) const
+    {
+        bool csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+        if (csv)
+        {
+            writeCsv(path);
+        }
+        else
+        {
+            writeJson(path, metadata);
+        }
+    }
+
+    void BenchmarkRecorder::writeJson(const std::string &path, const Metadata &metadata) const
+    {
+        std::ofstream out{path};
+        if (!out.is_open())
+        {
+            throw std::runtime_error("failed to open file: " + path);
+        }
+
+        out << "{\n  \"metadata\": {";
+        for (size_t i = 0; i < metadata.size(); ++i)
+        {
+            out << (i == 0 ? "\n" : ",\n")
+                << "    \"" << escapeJson(metadata[i].first) << "\": \"" << escapeJson(metadata[i].second) << "\"";
+        }
+        out << "\n  },\n  \"summary_ms\": {\n";
+        writeSummaryJson(out, "cpu_frame", summarize(samples(&FrameRecord::cpuFrameMs)));
+        out << ",\n";
+        writeSummaryJson(out, "gpu", summarize(samples(&FrameRecord::gpuTimeMs)));
+        out << ",\n";
+        writeSummaryJson(out, "cpu_wait", summarize(samples(&FrameRecord::cpuWaitMs)));
+        out << "\n  }";
+
+        if (!pipelineStatistics.empty())
+        {
+            // Per-frame averages
+            out << ",\n  \"pipeline_statistics\": {";
+            bool first = true;
+            for (const auto &[name, totals] : pipelineStatistics)
+            {
+                auto average = [&](uint64_t total)
+                { return static_cast<double>(total) / static_cast<double>(totals.frames); };
+
+                out << (first ? "\n" : ",\n")
+                    << "    \"" << escapeJson(name) << "\": {"
+                    << "\"frames\": " << totals.frames
+                    << ", \"input_assembly_vertices\": " << average(totals.inputAssemblyVertices)
+                    << ", \"vertex_shader_invocations\": " << average(totals.vertexShaderInvocations)
+                    << ", \"clipping_primitives\": " << average(totals.clippingPrimitives)
+                    << ", \"fragment_shader_invocations\": " << average(totals.fragmentShaderInvocations) << "}";
+                first = false;
+            }
+            out << "\n  }";
+        }
+        out << "\n}\n";
+    }
+
+    void BenchmarkRecorder::writeCsv(const std::string &path) const
+    {
+        std::ofstream out{path};
+        if (!out.is_open())
+        {
+            throw std::runtime_error("failed to open file: " + path);
+        }
+
+        // Frames whose GPU query never resolved (or was still in flight at the end) leave gpu_ms empty
+        out << "frame,cpu_frame_ms,cpu_wait_ms,gpu_ms\n";
+        for (const auto &frame : frames)
+        {
+            out << frame.frameNumber << "," << frame.cpuFrameMs << "," << frame.cpuWaitMs << ",";
+            if (frame.gpuTimeMs >= 0.0f)
+            {
+                out << frame.gpuTimeMs;
+            }
+            out << "\n";
+        }
+    }
+
+    void BenchmarkRecorder::printSummary() const
+    {
+        auto print = [](const char *name, const Summary &summary)
+        {
+            std::cout << name << ": p50 " << summary.p50 << " ms, p95 " << summary.p95
+                      << " ms, p99 " << summary.p99 << " ms, max " << summary.max
+                      << " ms (" << summary.count << " frames)" << std::endl;
+        };
+
+        print("cpu frame", summarize(samples(&FrameRecord::cpuFrameMs)));
+        print("gpu      ", summarize(samples(&FrameRecord::gpuTimeMs)));
+        print("cpu wait ", summarize(samples(&FrameRecord::cpuWaitMs)));
+    }
+}
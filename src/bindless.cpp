@@ -0,0 +1,181 @@
+#include "bindless.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <stdexcept>
+#include <string>
+
+namespace YTVK
+{
+    BindlessSet::BindlessSet(Device &device)
+        : device{device}, textures{std::make_shared<Slots>()}, storageBuffers{std::make_shared<Slots>()}
+    {
+        if (!device.supportsBindless())
+        {
+            throw std::runtime_error("device does not support descriptor indexing");
+        }
+
+        // Combined image samplers count against both the sampler and the sampled image limits
+        const auto &limits = device.vulkan12Properties;
+        textures->capacity = std::min({MAX_TEXTURES,
+                                       limits.maxDescriptorSetUpdateAfterBindSampledImages,
+                                       limits.maxDescriptorSetUpdateAfterBindSamplers,
+                                       limits.maxPerStageDescriptorUpdateAfterBindSampledImages,
+                                       limits.maxPerStageDescriptorUpdateAfterBindSamplers});
+        storageBuffers->capacity = std::min({MAX_STORAGE_BUFFERS,
+                                             limits.maxDescriptorSetUpdateAfterBindStorageBuffers,
+                                             limits.maxPerStageDescriptorUpdateAfterBindStorageBuffers});
+        uint32_t perStageResources = limits.maxPerStageUpdateAfterBindResources;
+        if (textures->capacity + storageBuffers->capacity > perStageResources)
+        {
+            storageBuffers->capacity = std::min(storageBuffers->capacity, perStageResources / 4);
+            textures->capacity = std::min(textures->capacity, perStageResources - storageBuffers->capacity);
+        }
+
+        std::array<VkDescriptorSetLayoutBinding, 2> bindings{};
+        bindings[0].binding = TEXTURE_BINDING;
+        bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        bindings[0].descriptorCount = textures->capacity;
+        bindings[0].stageFlags = VK_SHADER_STAGE_ALL;
+        bindings[1].binding = STORAGE_BUFFER_BINDING;
+        bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        bindings[1].descriptorCount = storageBuffers->capacity;
+        bindings[1].stageFlags = VK_SHADER_STAGE_ALL;
+
+        // Unused slots may hold anything, and slots may be written while earlier frames are in flight
+        std::array<VkDescriptorBindingFlags, 2> bindingFlags{};
+        bindingFlags.fill(VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                          VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+                          VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT);
+
+        VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+        bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+        bindingFlagsInfo.bindingCount = static_cast<uint32_t>(bindingFlags.size());
+        bindingFlagsInfo.pBindingFlags = bindingFlags.data();
+
+        VkDescriptorSetLayoutCreateInfo layoutInfo{};
+        layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        layoutInfo.pNext = &bindingFlagsInfo;
+        layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+        layoutInfo.bindingCount = static_cast<uint32_t>(bindings.size());
+        layoutInfo.pBindings = bindings.data();
+
+        if (vkCreateDescriptorSetLayout(device.device(), &layoutInfo, nullptr, &layout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create bindless descriptor set layout");
+        }
+
+        std::array<VkDescriptorPoolSize, 2> poolSizes{{
+            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, textures->capacity},
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, storageBuffers->capacity},
+        }};
+
+        VkDescriptorPoolCreateInfo poolInfo{};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+        poolInfo.maxSets = 1;
+        poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
+        poolInfo.pPoolSizes = poolSizes.data();
+
+        if (vkCreateDescriptorPool(device.device(), &poolInfo, nullptr, &pool) != VK_SUCCESS)
+        {
+            vkDestroyDescriptorSetLayout(device.device(), layout, nullptr);
+            throw std::runtime_error("failed to create bindless descriptor pool");
+        }
+
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.descriptorPool = pool;
+        allocInfo.descriptorSetCount = 1;
+        allocInfo.pSetLayouts = &layout;
+
+        if (vkAllocateDescriptorSets(device.device(), &allocInfo, &set) != VK_SUCCESS)
+        {
+            vkDestroyDescriptorPool(device.device(), pool, nullptr);
+            vkDestroyDescriptorSetLayout(device.device(), layout, nullptr);
+            throw std::runtime_error("failed to allocate bindless descriptor set");
+        }
+    }
+
+    BindlessSet::~BindlessSet()
+    {
+        // Frees the set with it
+        vkDestroyDescriptorPool(device.device(), pool, nullptr);
+        vkDestroyDescriptorSetLayout(device.device(), layout, nullptr);
+    }
+
+    uint32_t BindlessSet::addTexture(VkImageView imageView, VkSampler sampler, VkImageLayout imageLayout)
+    {
+        uint32_t index = acquireSlot(*textures, "texture");
+
+        VkDescriptorImageInfo imageInfo{sampler, imageView, imageLayout};
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = set;
+        write.dstBinding = TEXTURE_BINDING;
+        write.dstArrayElement = index;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+        write.pImageInfo = &imageInfo;
+        vkUpdateDescriptorSets(device.device(), 1, &write, 0, nullptr);
+        return index;
+    }
+
+    uint32_t BindlessSet::addStorageBuffer(const VkDescriptorBufferInfo &bufferInfo)
+    {
+        uint32_t index = acquireSlot(*storageBuffers, "storage buffer");
+
+        VkWriteDescriptorSet write{};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.dstSet = set;
+        write.dstBinding = STORAGE_BUFFER_BINDING;
+        write.dstArrayElement = index;
+        write.descriptorCount = 1;
+        write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+        write.pBufferInfo = &bufferInfo;
+        vkUpdateDescriptorSets(device.device(), 1, &write, 0, nullptr);
+        return index;
+    }
+
+    void BindlessSet::removeTexture(uint32_t index)
+    {
+        releaseSlot(textures, index);
+    }
+
+    void BindlessSet::removeStorageBuffer(uint32_t index)
+    {
+        releaseSlot(storageBuffers, index);
+    }
+
+    uint32_t BindlessSet::acquireSlot(Slots &slots, const char *table)
+    {
+        if (!slots.available.empty())
+        {
+            uint32_t index = slots.available.back();
+            slots.available.pop_back();
+            return index;
+        }
+        if (slots.next == slots.capacity)
+        {
+            throw std::runtime_error(std::string("bindless ") + table + " table is full");
+        }
+        return slots.next++;
+    }
+
+    void BindlessSet::releaseSlot(const std::shared_ptr<Slots> &slots, uint32_t index)
+    {
+        assert(index < slots->next && "Bindless index was never handed out");
+
+        // Partially bound, so the stale descriptor can stay until the slot is written again
+        std::weak_ptr<Slots> weak = slots;
+        device.deletionQueue().push(
+            [weak, index]()
+            {
+                if (auto owner = weak.lock())
+                {
+                    owner->available.push_back(index);
+                }
+            });
+    }
+}
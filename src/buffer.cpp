@@ -53,8 +53,9 @@ namespace YTVK
     Buffer::~Buffer()
     {
         unmap();
+        device.notifyResourceDestroyed(Device::handleKey(buffer));
         vkDestroyBuffer(device.device(), buffer, nullptr);
-        vkFreeMemory(device.device(), memory, nullptr);
+        device.freeMemory(memory);
     }
 
     /**
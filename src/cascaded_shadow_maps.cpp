@@ -0,0 +1,529 @@
+#include "cascaded_shadow_maps.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+namespace YTVK
+{
+    namespace
+    {
+        struct ShadowPushConstantData
+        {
+            glm::mat4 lightModelViewProjection{1.0f};
+        };
+
+        // Pipeline statistics queries cannot span the copies and barriers between passes, so each
+        // caster pass gets its own scope
+        constexpr std::array<const char *, CascadedShadowMaps::CASCADE_COUNT> STATIC_SCOPES{
+            "CascadedShadowMaps static 0", "CascadedShadowMaps static 1",
+            "CascadedShadowMaps static 2", "CascadedShadowMaps static 3"};
+        constexpr std::array<const char *, CascadedShadowMaps::CASCADE_COUNT> DYNAMIC_SCOPES{
+            "CascadedShadowMaps dynamic 0", "CascadedShadowMaps dynamic 1",
+            "CascadedShadowMaps dynamic 2", "CascadedShadowMaps dynamic 3"};
+
+        // World space bounding sphere moved into light view space; w < 0 for objects without a model
+        glm::vec4 casterSphere(GameObject &object, const glm::mat4 &lightView)
+        {
+            if (!object.model)
+            {
+                return glm::vec4{-1.0f};
+            }
+            glm::vec3 scale = glm::abs(object.transform.scale);
+            glm::vec4 center = lightView * object.transform.mat4() * glm::vec4{object.model->getBoundsCenter(), 1.0f};
+            return {glm::vec3{center}, object.model->getBoundsRadius() * std::max({scale.x, scale.y, scale.z})};
+        }
+
+        bool overlaps(const glm::vec4 &sphere, const glm::vec3 &boundsMin, const glm::vec3 &boundsMax)
+        {
+            return sphere.w >= 0.0f &&
+                   sphere.x + sphere.w >= boundsMin.x && sphere.x - sphere.w <= boundsMax.x &&
+                   sphere.y + sphere.w >= boundsMin.y && sphere.y - sphere.w <= boundsMax.y &&
+                   sphere.z + sphere.w >= boundsMin.z && sphere.z - sphere.w <= boundsMax.z;
+        }
+    }
+
+    CascadedShadowMaps::CascadedShadowMaps(Device &device) : device{device}
+    {
+        depthFormat = device.findSupportedFormat(
+            {VK_FORMAT_D16_UNORM, VK_FORMAT_D32_SFLOAT},
+            VK_IMAGE_TILING_OPTIMAL,
+            VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT |
+                VK_FORMAT_FEATURE_TRANSFER_SRC_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT);
+
+        createImages();
+        createRenderPasses();
+        createFramebuffers();
+        createSampler();
+        createPipelineLayout();
+        createPipeline();
+    }
+
+    CascadedShadowMaps::~CascadedShadowMaps()
+    {
+        pipeline.reset();
+        vkDestroyPipelineLayout(device.device(), pipelineLayout, nullptr);
+        vkDestroySampler(device.device(), sampler, nullptr);
+
+        for (uint32_t i = 0; i < CASCADE_COUNT; ++i)
+        {
+            vkDestroyFramebuffer(device.device(), staticFramebuffers[i], nullptr);
+            vkDestroyFramebuffer(device.device(), sampledFramebuffers[i], nullptr);
+            vkDestroyImageView(device.device(), staticLayerViews[i], nullptr);
+            vkDestroyImageView(device.device(), sampledLayerViews[i], nullptr);
+        }
+        vkDestroyImageView(device.device(), sampledArrayView, nullptr);
+
+        vkDestroyImage(device.device(), staticImage, nullptr);
+        device.freeMemory(staticImageMemory);
+        vkDestroyImage(device.device(), sampledImage, nullptr);
+        device.freeMemory(sampledImageMemory);
+
+        vkDestroyRenderPass(device.device(), clearPass, nullptr);
+        vkDestroyRenderPass(device.device(), loadPass, nullptr);
+    }
+
+    void CascadedShadowMaps::createImages()
+    {
+        auto createImage = [&](VkImageUsageFlags usage, VkImage &image, VkDeviceMemory &memory)
+        {
+            VkImageCreateInfo imageInfo{};
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.extent = {RESOLUTION, RESOLUTION, 1};
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = CASCADE_COUNT;
+            imageInfo.format = depthFormat;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            imageInfo.usage = usage;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+            device.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, memory);
+        };
+
+        auto createView = [&](VkImage image, VkImageViewType type, uint32_t baseLayer, uint32_t layerCount)
+        {
+            VkImageViewCreateInfo viewInfo{};
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image = image;
+            viewInfo.viewType = type;
+            viewInfo.format = depthFormat;
+            viewInfo.subresourceRange = {VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, baseLayer, layerCount};
+
+            VkImageView view;
+            if (vkCreateImageView(device.device(), &viewInfo, nullptr, &view) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to create shadow map image view");
+            }
+            return view;
+        };
+
+        createImage(VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT, staticImage, staticImageMemory);
+        createImage(
+            VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
+            sampledImage, sampledImageMemory);
+
+        for (uint32_t i = 0; i < CASCADE_COUNT; ++i)
+        {
+            staticLayerViews[i] = createView(staticImage, VK_IMAGE_VIEW_TYPE_2D, i, 1);
+            sampledLayerViews[i] = createView(sampledImage, VK_IMAGE_VIEW_TYPE_2D, i, 1);
+        }
+        sampledArrayView = createView(sampledImage, VK_IMAGE_VIEW_TYPE_2D_ARRAY, 0, CASCADE_COUNT);
+    }
+
+    void CascadedShadowMaps::createRenderPasses()
+    {
+        // Layout transitions and synchronization are explicit barriers around the passes, see render()
+        auto createPass = [&](VkAttachmentLoadOp loadOp)
+        {
+            VkAttachmentDescription depthAttachment{};
+            depthAttachment.format = depthFormat;
+            depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+            depthAttachment.loadOp = loadOp;
+            depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+            depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+            depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+            depthAttachment.initialLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+            depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+            VkAttachmentReference depthAttachmentRef{};
+            depthAttachmentRef.attachment = 0;
+            depthAttachmentRef.layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+            VkSubpassDescription subpass{};
+            subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+            subpass.colorAttachmentCount = 0;
+            subpass.pDepthStencilAttachment = &depthAttachmentRef;
+
+            VkRenderPassCreateInfo renderPassInfo{};
+            renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+            renderPassInfo.attachmentCount = 1;
+            renderPassInfo.pAttachments = &depthAttachment;
+            renderPassInfo.subpassCount = 1;
+            renderPassInfo.pSubpasses = &subpass;
+
+            VkRenderPass renderPass;
+            if (vkCreateRenderPass(device.device(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to create shadow render pass");
+            }
+            return renderPass;
+        };
+
+        clearPass = createPass(VK_ATTACHMENT_LOAD_OP_CLEAR);
+        loadPass = createPass(VK_ATTACHMENT_LOAD_OP_LOAD);
+    }
+
+    void CascadedShadowMaps::createFramebuffers()
+    {
+        auto createFramebuffer = [&](VkRenderPass renderPass, VkImageView view)
+        {
+            VkFramebufferCreateInfo framebufferInfo{};
+            framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            framebufferInfo.renderPass = renderPass;
+            framebufferInfo.attachmentCount = 1;
+            framebufferInfo.pAttachments = &view;
+            framebufferInfo.width = RESOLUTION;
+            framebufferInfo.height = RESOLUTION;
+            framebufferInfo.layers = 1;
+
+            VkFramebuffer framebuffer;
+            if (vkCreateFramebuffer(device.device(), &framebufferInfo, nullptr, &framebuffer) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to create shadow framebuffer");
+            }
+            return framebuffer;
+        };
+
+        for (uint32_t i = 0; i < CASCADE_COUNT; ++i)
+        {
+            staticFramebuffers[i] = createFramebuffer(clearPass, staticLayerViews[i]);
+            sampledFramebuffers[i] = createFramebuffer(loadPass, sampledLayerViews[i]);
+        }
+    }
+
+    void CascadedShadowMaps::createSampler()
+    {
+        // Hardware depth comparison; bilinear filtering gives 2x2 PCF where the format allows it
+        bool linear = (device.getFormatProperties(depthFormat).optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) != 0;
+
+        VkSamplerCreateInfo samplerInfo{};
+        samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter = linear ? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+        samplerInfo.minFilter = samplerInfo.magFilter;
+        samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST;
+        // Outside every cascade is lit
+        samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+        samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+        samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_BORDER;
+        samplerInfo.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE;
+        samplerInfo.compareEnable = VK_TRUE;
+        samplerInfo.compareOp = VK_COMPARE_OP_LESS_OR_EQUAL;
+        samplerInfo.maxLod = 0.0f;
+
+        if (vkCreateSampler(device.device(), &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create shadow sampler");
+        }
+    }
+
+    void CascadedShadowMaps::createPipelineLayout()
+    {
+        VkPushConstantRange pushConstantRange{};
+        pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+        pushConstantRange.offset = 0;
+        pushConstantRange.size = sizeof(ShadowPushConstantData);
+
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
+
+        if (vkCreatePipelineLayout(device.device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create pipeline layout");
+        }
+    }
+
+    void CascadedShadowMaps::createPipeline()
+    {
+        PipelineConfigInfo pipelineConfig = {};
+        Pipeline::defaultPipelineConfigInfo(pipelineConfig);
+        pipelineConfig.renderPass = clearPass;
+        pipelineConfig.pipelineLayout = pipelineLayout;
+        pipelineConfig.colorBlendInfo.attachmentCount = 0;
+        pipelineConfig.bindingDescriptions = Model::Vertex::getPositionBindDescriptions();
+        pipelineConfig.attributeDescriptions = Model::Vertex::getPositionAttributeDescriptions();
+        // Keeps lit surfaces from shadowing themselves
+        pipelineConfig.rasterizationInfo.depthBiasEnable = VK_TRUE;
+        pipelineConfig.rasterizationInfo.depthBiasConstantFactor = 1.25f;
+        pipelineConfig.rasterizationInfo.depthBiasSlopeFactor = 1.75f;
+
+        pipeline = std::make_unique<Pipeline>(device, pipelineConfig, "shaders/shadow.vert.spv", "");
+    }
+
+    VkDescriptorImageInfo CascadedShadowMaps::descriptorInfo() const
+    {
+        return {sampler, sampledArrayView, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL};
+    }
+
+    void CascadedShadowMaps::fitCascades(const Camera &camera, float near, float far, const glm::vec3 &directionToLight)
+    {
+        // Rotation only, so the cascade boxes below live in a frame that does not follow the camera
+        glm::vec3 direction = -glm::normalize(directionToLight);
+        glm::vec3 up = std::abs(direction.y) > 0.99f ? glm::vec3{1.0f, 0.0f, 0.0f} : glm::vec3{0.0f, -1.0f, 0.0f};
+        Camera lightCamera{};
+        lightCamera.setViewDirection(glm::vec3{0.0f}, direction, up);
+        if (lightCamera.getView() != lightView)
+        {
+            lightView = lightCamera.getView();
+            staticCastersChanged = true;
+        }
+
+        const glm::mat4 &projection = camera.getProjection();
+        // Half diagonal of a frustum slice per unit of view depth
+        float diagonal = std::sqrt(1.0f / (projection[0][0] * projection[0][0]) + 1.0f / (projection[1][1] * projection[1][1]));
+        glm::mat4 viewToLight = lightView * glm::inverse(camera.getView());
+
+        float sliceNear = near;
+        for (uint32_t i = 0; i < CASCADE_COUNT; ++i)
+        {
+            float fraction = static_cast<float>(i + 1) / static_cast<float>(CASCADE_COUNT);
+            float uniformSplit = near + (far - near) * fraction;
+            float logSplit = near * std::pow(far / near, fraction);
+            float sliceFar = SPLIT_LAMBDA * logSplit + (1.0f - SPLIT_LAMBDA) * uniformSplit;
+
+            // Smallest sphere on the view axis through both the near and the far corners of the slice
+            float nearHalf = sliceNear * diagonal;
+            float farHalf = sliceFar * diagonal;
+            float centerDepth = std::min(
+                sliceFar,
+                (sliceFar * sliceFar + farHalf * farHalf - sliceNear * sliceNear - nearHalf * nearHalf) / (2.0f * (sliceFar - sliceNear)));
+            float radius = std::sqrt((sliceFar - centerDepth) * (sliceFar - centerDepth) + farHalf * farHalf);
+
+            // The padding absorbs the snapping, and the snap step is a whole number of texels
+            float halfExtent = radius * (1.0f + 2.0f * SNAP_FRACTION);
+            float texel = 2.0f * halfExtent / static_cast<float>(RESOLUTION);
+            float step = texel * std::max(1.0f, std::floor(2.0f * radius * SNAP_FRACTION / texel));
+            glm::vec3 center{viewToLight * glm::vec4{0.0f, 0.0f, centerDepth, 1.0f}};
+            center = glm::round(center / step) * step;
+
+            auto &state = states[i];
+            state.boundsMin = center - glm::vec3{halfExtent};
+            state.boundsMax = center + glm::vec3{halfExtent};
+            state.boundsMin.z -= CASTER_DISTANCE;
+
+            Camera box{};
+            box.setOrthographicProjection(
+                state.boundsMin.x, state.boundsMax.x,
+                state.boundsMin.y, state.boundsMax.y,
+                state.boundsMin.z, state.boundsMax.z);
+            cascades[i].viewProjection = box.getProjection() * lightView;
+            cascades[i].splitDepth = sliceFar;
+
+            sliceNear = sliceFar;
+        }
+    }
+
+    void CascadedShadowMaps::update(const Camera &camera, float near, float far, const glm::vec3 &directionToLight, std::vector<GameObject> &gameObjects)
+    {
+        YTVK_TRACE_SCOPE("CascadedShadowMaps::update");
+
+        if (gameObjects.size() != objectCount)
+        {
+            objectCount = gameObjects.size();
+            casterSpheres.resize(objectCount);
+            staticCastersChanged = true;
+        }
+
+        fitCascades(camera, near, far, directionToLight);
+
+        for (size_t i = 0; i < gameObjects.size(); ++i)
+        {
+            if (staticCastersChanged || !gameObjects[i].isStatic)
+            {
+                casterSpheres[i] = casterSphere(gameObjects[i], lightView);
+            }
+        }
+
+        for (uint32_t c = 0; c < CASCADE_COUNT; ++c)
+        {
+            auto &state = states[c];
+            if (staticCastersChanged || cascades[c].viewProjection != state.cachedViewProjection)
+            {
+                state.staticOutOfDate = true;
+                state.staticCasters.clear();
+                for (uint32_t i = 0; i < gameObjects.size(); ++i)
+                {
+                    if (gameObjects[i].isStatic && overlaps(casterSpheres[i], state.boundsMin, state.boundsMax))
+                    {
+                        state.staticCasters.push_back(i);
+                    }
+                }
+            }
+
+            state.dynamicCasters.clear();
+            for (uint32_t i = 0; i < gameObjects.size(); ++i)
+            {
+                if (!gameObjects[i].isStatic && overlaps(casterSpheres[i], state.boundsMin, state.boundsMax))
+                {
+                    state.dynamicCasters.push_back(i);
+                }
+            }
+        }
+        staticCastersChanged = false;
+    }
+
+    void CascadedShadowMaps::render(FrameInfo &frameInfo, std::vector<GameObject> &gameObjects)
+    {
+        YTVK_TRACE_SCOPE("CascadedShadowMaps::render");
+        GpuProfiler::Scope profileScope{frameInfo.profiler, frameInfo.commandBuffer, "CascadedShadowMaps"};
+        VkCommandBuffer commandBuffer = frameInfo.commandBuffer;
+
+        for (uint32_t c = 0; c < CASCADE_COUNT; ++c)
+        {
+            auto &state = states[c];
+            if (state.staticOutOfDate)
+            {
+                // Earlier copies out of this layer only need to have executed
+                transition(commandBuffer, staticImage, c,
+                           VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                           VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+                           VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+                           VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+                beginPass(commandBuffer, clearPass, staticFramebuffers[c]);
+                drawCasters(frameInfo, gameObjects, state.staticCasters, cascades[c].viewProjection, STATIC_SCOPES[c]);
+                vkCmdEndRenderPass(commandBuffer);
+                transition(commandBuffer, staticImage, c,
+                           VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                           VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+                           VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+
+                state.cachedViewProjection = cascades[c].viewProjection;
+                state.staticOutOfDate = false;
+                state.sampledMatchesStatic = false;
+            }
+
+            bool hasDynamicCasters = !state.dynamicCasters.empty();
+            if (!hasDynamicCasters && state.sampledMatchesStatic)
+            {
+                continue;
+            }
+
+            transition(commandBuffer, sampledImage, c,
+                       sampledImageInitialized ? VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL : VK_IMAGE_LAYOUT_UNDEFINED,
+                       VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                       VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+                       VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+            VkImageCopy region{};
+            region.srcSubresource = {VK_IMAGE_ASPECT_DEPTH_BIT, 0, c, 1};
+            region.dstSubresource = {VK_IMAGE_ASPECT_DEPTH_BIT, 0, c, 1};
+            region.extent = {RESOLUTION, RESOLUTION, 1};
+            vkCmdCopyImage(
+                commandBuffer,
+                staticImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                sampledImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                1, &region);
+
+            VkImageLayout layout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            VkPipelineStageFlags stage = VK_PIPELINE_STAGE_TRANSFER_BIT;
+            VkAccessFlags access = VK_ACCESS_TRANSFER_WRITE_BIT;
+            if (hasDynamicCasters)
+            {
+                transition(commandBuffer, sampledImage, c,
+                           layout, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+                           stage, access,
+                           VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT,
+                           VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
+                beginPass(commandBuffer, loadPass, sampledFramebuffers[c]);
+                drawCasters(frameInfo, gameObjects, state.dynamicCasters, cascades[c].viewProjection, DYNAMIC_SCOPES[c]);
+                vkCmdEndRenderPass(commandBuffer);
+
+                layout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+                stage = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+                access = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+            }
+            transition(commandBuffer, sampledImage, c,
+                       layout, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL,
+                       stage, access,
+                       VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+
+            state.sampledMatchesStatic = !hasDynamicCasters;
+        }
+        // The first render redraws and copies every cascade
+        sampledImageInitialized = true;
+    }
+
+    void CascadedShadowMaps::drawCasters(FrameInfo &frameInfo, std::vector<GameObject> &gameObjects, const std::vector<uint32_t> &casters, const glm::mat4 &viewProjection, const char *statisticsName)
+    {
+        VkCommandBuffer commandBuffer = frameInfo.commandBuffer;
+        PipelineStatistics::Scope statisticsScope{frameInfo.pipelineStatistics, commandBuffer, statisticsName};
+        pipeline->bind(commandBuffer);
+
+        for (uint32_t index : casters)
+        {
+            auto &object = gameObjects[index];
+            ShadowPushConstantData push{};
+            push.lightModelViewProjection = viewProjection * object.transform.mat4();
+
+            vkCmdPushConstants(
+                commandBuffer,
+                pipelineLayout,
+                VK_SHADER_STAGE_VERTEX_BIT,
+                0,
+                sizeof(ShadowPushConstantData),
+                &push);
+            object.model->bindPositions(commandBuffer);
+            object.model->draw(commandBuffer);
+        }
+    }
+
+    void CascadedShadowMaps::beginPass(VkCommandBuffer commandBuffer, VkRenderPass renderPass, VkFramebuffer framebuffer)
+    {
+        VkClearValue clearValue{};
+        clearValue.depthStencil = {1.0f, 0};
+
+        VkRenderPassBeginInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+        renderPassInfo.renderPass = renderPass;
+        renderPassInfo.framebuffer = framebuffer;
+        renderPassInfo.renderArea.offset = {0, 0};
+        renderPassInfo.renderArea.extent = {RESOLUTION, RESOLUTION};
+        renderPassInfo.clearValueCount = 1;
+        renderPassInfo.pClearValues = &clearValue;
+        vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+
+        VkViewport viewport{};
+        viewport.x = 0.0f;
+        viewport.y = 0.0f;
+        viewport.width = static_cast<float>(RESOLUTION);
+        viewport.height = static_cast<float>(RESOLUTION);
+        viewport.minDepth = 0.0f;
+        viewport.maxDepth = 1.0f;
+        VkRect2D scissor{{0, 0}, {RESOLUTION, RESOLUTION}};
+        vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+        vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+    }
+
+    void CascadedShadowMaps::transition(VkCommandBuffer commandBuffer, VkImage image, uint32_t layer, VkImageLayout oldLayout, VkImageLayout newLayout,
+                                        VkPipelineStageFlags srcStage, VkAccessFlags srcAccess, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess)
+    {
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = srcAccess;
+        barrier.dstAccessMask = dstAccess;
+        barrier.oldLayout = oldLayout;
+        barrier.newLayout = newLayout;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = image;
+        barrier.subresourceRange = {VK_IMAGE_ASPECT_DEPTH_BIT, 0, 1, layer, 1};
+
+        vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+    }
+}
@@ -0,0 +1,106 @@
+#include "clustered_lighting.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace YTVK
+{
+    namespace
+    {
+        // local_size_x of shaders/cluster.comp
+        constexpr uint32_t WORKGROUP_SIZE = 64;
+    }
+
+    ClusteredLighting::ClusteredLighting(Device &device, uint32_t framesInFlight, VkDescriptorSetLayout globalSetLayout)
+        : device{device}
+    {
+        for (uint32_t i = 0; i < framesInFlight; ++i)
+        {
+            // Rewritten by the host every frame
+            lightBuffers.push_back(std::make_unique<Buffer>(
+                device,
+                sizeof(PointLight),
+                MAX_LIGHTS,
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT));
+            lightBuffers.back()->map();
+
+            // Per cluster light counts followed by MAX_LIGHTS_PER_CLUSTER indices per cluster
+            clusterBuffers.push_back(std::make_unique<Buffer>(
+                device,
+                sizeof(uint32_t),
+                CLUSTER_COUNT * (1 + MAX_LIGHTS_PER_CLUSTER),
+                VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+                VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+        }
+
+        createPipelineLayout(globalSetLayout);
+        pipeline = std::make_unique<ComputePipeline>(device, pipelineLayout, "shaders/cluster.comp.spv");
+    }
+
+    ClusteredLighting::~ClusteredLighting()
+    {
+        vkDestroyPipelineLayout(device.device(), pipelineLayout, nullptr);
+    }
+
+    void ClusteredLighting::createPipelineLayout(VkDescriptorSetLayout globalSetLayout)
+    {
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &globalSetLayout;
+
+        if (vkCreatePipelineLayout(device.device(), &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create pipeline layout");
+        }
+    }
+
+    uint32_t ClusteredLighting::writeLights(int frameIndex, const std::vector<PointLight> &lights)
+    {
+        uint32_t count = static_cast<uint32_t>(std::min<size_t>(lights.size(), MAX_LIGHTS));
+        if (count > 0)
+        {
+            std::memcpy(lightBuffers[frameIndex]->getMappedMemory(), lights.data(), count * sizeof(PointLight));
+        }
+        return count;
+    }
+
+    void ClusteredLighting::cullLights(FrameInfo &frameInfo)
+    {
+        YTVK_TRACE_SCOPE("ClusteredLighting::cullLights");
+        GpuProfiler::Scope profileScope{frameInfo.profiler, frameInfo.commandBuffer, "ClusteredLighting"};
+
+        pipeline->bind(frameInfo.commandBuffer);
+        vkCmdBindDescriptorSets(
+            frameInfo.commandBuffer,
+            VK_PIPELINE_BIND_POINT_COMPUTE,
+            pipelineLayout,
+            0, 1,
+            &frameInfo.globalDescriptorSet,
+            0,
+            nullptr);
+        vkCmdDispatch(frameInfo.commandBuffer, (CLUSTER_COUNT + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+        // The lists are read by the fragment shaders of this frame's passes
+        VkBufferMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.buffer = clusterBuffers[frameInfo.frameIndex]->getBuffer();
+        barrier.offset = 0;
+        barrier.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(
+            frameInfo.commandBuffer,
+            VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT,
+            VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+            0,
+            0, nullptr,
+            1, &barrier,
+            0, nullptr);
+    }
+}
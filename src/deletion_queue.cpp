@@ -0,0 +1,63 @@
+#include "deletion_queue.hpp"
+
+#include <algorithm>
+
+namespace YTVK
+{
+    DeletionQueue::~DeletionQueue()
+    {
+        flush();
+    }
+
+    void DeletionQueue::push(std::function<void()> destroy)
+    {
+        pending.push_back(std::move(destroy));
+    }
+
+    void DeletionQueue::push(uint64_t timelineValue, std::function<void()> destroy)
+    {
+        // Keep the queue sorted so collect() only ever looks at the front
+        auto position = std::upper_bound(
+            retiring.begin(), retiring.end(), timelineValue,
+            [](uint64_t value, const Retiring &entry)
+            { return value < entry.timelineValue; });
+        retiring.insert(position, {timelineValue, std::move(destroy)});
+    }
+
+    void DeletionQueue::seal(uint64_t timelineValue)
+    {
+        for (auto &destroy : pending)
+        {
+            push(timelineValue, std::move(destroy));
+        }
+        pending.clear();
+    }
+
+    void DeletionQueue::collect(uint64_t completedTimelineValue)
+    {
+        while (!retiring.empty() && retiring.front().timelineValue <= completedTimelineValue)
+        {
+            auto destroy = std::move(retiring.front().destroy);
+            retiring.pop_front();
+            destroy();
+        }
+    }
+
+    void DeletionQueue::flush()
+    {
+        // Only valid once the device is idle
+        auto unsealed = std::move(pending);
+        pending.clear();
+        for (auto &destroy : unsealed)
+        {
+            destroy();
+        }
+
+        while (!retiring.empty())
+        {
+            auto destroy = std::move(retiring.front().destroy);
+            retiring.pop_front();
+            destroy();
+        }
+    }
+}
@@ -1,7 +1,10 @@
 #include "descriptors.hpp"
+#include "utils.hpp"
 
 // std
+#include <algorithm>
 #include <cassert>
+#include <cmath>
 #include <stdexcept>
 
 namespace YTVK
@@ -25,16 +28,32 @@ namespace YTVK
         return *this;
     }
 
+    DescriptorSetLayout::Builder &DescriptorSetLayout::Builder::setPushDescriptor()
+    {
+        if (device.supportsPushDescriptors())
+        {
+            flags |= VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR;
+        }
+        return *this;
+    }
+
     std::unique_ptr<DescriptorSetLayout> DescriptorSetLayout::Builder::build() const
     {
-        return std::make_unique<DescriptorSetLayout>(device, bindings);
+        return std::make_unique<DescriptorSetLayout>(device, bindings, flags);
+    }
+
+    std::shared_ptr<DescriptorSetLayout> DescriptorSetLayout::Builder::build(DescriptorLayoutCache &cache) const
+    {
+        return cache.getLayout(bindings, flags);
     }
 
     // *************** Descriptor Set Layout *********************
 
     DescriptorSetLayout::DescriptorSetLayout(
-        Device &device, std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings)
-        : device{device}, bindings{bindings}
+        Device &device,
+        std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> bindings,
+        VkDescriptorSetLayoutCreateFlags flags)
+        : device{device}, bindings{bindings}, flags{flags}
     {
         std::vector<VkDescriptorSetLayoutBinding> setLayoutBindings{};
         for (auto kv : bindings)
@@ -44,6 +63,7 @@ namespace YTVK
 
         VkDescriptorSetLayoutCreateInfo descriptorSetLayoutInfo{};
         descriptorSetLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        descriptorSetLayoutInfo.flags = flags;
         descriptorSetLayoutInfo.bindingCount = static_cast<uint32_t>(setLayoutBindings.size());
         descriptorSetLayoutInfo.pBindings = setLayoutBindings.data();
 
@@ -62,6 +82,45 @@ namespace YTVK
         vkDestroyDescriptorSetLayout(device.device(), descriptorSetLayout, nullptr);
     }
 
+    // *************** Descriptor Layout Cache *********************
+
+    bool DescriptorLayoutCache::Binding::operator==(const Binding &other) const
+    {
+        return binding == other.binding && descriptorType == other.descriptorType &&
+               descriptorCount == other.descriptorCount && stageFlags == other.stageFlags;
+    }
+
+    size_t DescriptorLayoutCache::KeyHash::operator()(const Key &key) const
+    {
+        size_t seed = 0;
+        hashCombine(seed, key.flags);
+        for (const auto &binding : key.bindings)
+        {
+            hashCombine(seed, binding.binding, binding.descriptorType, binding.descriptorCount, binding.stageFlags);
+        }
+        return seed;
+    }
+
+    std::shared_ptr<DescriptorSetLayout> DescriptorLayoutCache::getLayout(
+        const std::unordered_map<uint32_t, VkDescriptorSetLayoutBinding> &bindings,
+        VkDescriptorSetLayoutCreateFlags flags)
+    {
+        Key key{flags, {}};
+        for (const auto &[index, binding] : bindings)
+        {
+            key.bindings.push_back({binding.binding, binding.descriptorType, binding.descriptorCount, binding.stageFlags});
+        }
+        std::sort(key.bindings.begin(), key.bindings.end(), [](const Binding &a, const Binding &b)
+                  { return a.binding < b.binding; });
+
+        auto &layout = layouts[key];
+        if (!layout)
+        {
+            layout = std::make_shared<DescriptorSetLayout>(device, bindings, flags);
+        }
+        return layout;
+    }
+
     // *************** Descriptor Pool Builder *********************
 
     DescriptorPool::Builder &DescriptorPool::Builder::addPoolSize(
@@ -125,8 +184,7 @@ namespace YTVK
         allocInfo.pSetLayouts = &descriptorSetLayout;
         allocInfo.descriptorSetCount = 1;
 
-        // Might want to create a "DescriptorPoolManager" class that handles this case, and builds
-        // a new pool whenever an old pool fills up. But this is beyond our current scope
+        // Fixed-size pool; DescriptorAllocator chains new pools instead of failing here
         if (vkAllocateDescriptorSets(device.device(), &allocInfo, &descriptor) != VK_SUCCESS)
         {
             return false;
@@ -148,10 +206,276 @@ namespace YTVK
         vkResetDescriptorPool(device.device(), descriptorPool, 0);
     }
 
+    // *************** Descriptor Allocator Builder *********************
+
+    DescriptorAllocator::Builder &DescriptorAllocator::Builder::addPoolSize(
+        VkDescriptorType descriptorType, float descriptorsPerSet)
+    {
+        poolSizes.push_back({descriptorType, descriptorsPerSet});
+        return *this;
+    }
+
+    DescriptorAllocator::Builder &DescriptorAllocator::Builder::setSetsPerPool(uint32_t count)
+    {
+        setsPerPool = count;
+        return *this;
+    }
+
+    DescriptorAllocator::Builder &DescriptorAllocator::Builder::setFramesInFlight(uint32_t count)
+    {
+        framesInFlight = count;
+        return *this;
+    }
+
+    std::unique_ptr<DescriptorAllocator> DescriptorAllocator::Builder::build() const
+    {
+        return std::make_unique<DescriptorAllocator>(device, setsPerPool, framesInFlight, poolSizes);
+    }
+
+    // *************** Descriptor Allocator *********************
+
+    DescriptorAllocator::DescriptorAllocator(
+        Device &device,
+        uint32_t setsPerPool,
+        uint32_t framesInFlight,
+        const std::vector<std::pair<VkDescriptorType, float>> &poolSizes)
+        : device{device}, setsPerPool{std::clamp(setsPerPool, 1u, MAX_SETS_PER_POOL)}, poolSizes{poolSizes}, frameChains(framesInFlight)
+    {
+        assert(framesInFlight > 0 && "Descriptor allocator needs at least one frame");
+    }
+
+    DescriptorAllocator::~DescriptorAllocator()
+    {
+        for (VkDescriptorPool pool : staticChain.pools)
+        {
+            vkDestroyDescriptorPool(device.device(), pool, nullptr);
+        }
+        for (auto &chain : frameChains)
+        {
+            for (VkDescriptorPool pool : chain.pools)
+            {
+                vkDestroyDescriptorPool(device.device(), pool, nullptr);
+            }
+        }
+    }
+
+    void DescriptorAllocator::beginFrame(uint32_t frameIndex)
+    {
+        currentFrameIndex = frameIndex;
+
+        // Pools are kept for the next time this slot comes around, so steady state creates none
+        PoolChain &chain = frameChains[frameIndex];
+        for (size_t i = 0; i < chain.pools.size() && i <= chain.current; ++i)
+        {
+            vkResetDescriptorPool(device.device(), chain.pools[i], 0);
+        }
+        chain.current = 0;
+    }
+
+    bool DescriptorAllocator::allocate(
+        VkDescriptorSetLayout descriptorSetLayout, VkDescriptorSet &descriptor, Lifetime lifetime)
+    {
+        PoolChain &chain = lifetime == Lifetime::Static ? staticChain : frameChains[currentFrameIndex];
+        return allocateFromChain(chain, descriptorSetLayout, descriptor);
+    }
+
+    size_t DescriptorAllocator::poolCount() const
+    {
+        size_t count = staticChain.pools.size();
+        for (const auto &chain : frameChains)
+        {
+            count += chain.pools.size();
+        }
+        return count;
+    }
+
+    VkDescriptorPool DescriptorAllocator::createPool(uint32_t maxSets)
+    {
+        std::vector<VkDescriptorPoolSize> sizes{};
+        for (const auto &[type, descriptorsPerSet] : poolSizes)
+        {
+            sizes.push_back({type, std::max(1u, static_cast<uint32_t>(std::ceil(descriptorsPerSet * maxSets)))});
+        }
+
+        VkDescriptorPoolCreateInfo descriptorPoolInfo{};
+        descriptorPoolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        descriptorPoolInfo.poolSizeCount = static_cast<uint32_t>(sizes.size());
+        descriptorPoolInfo.pPoolSizes = sizes.data();
+        descriptorPoolInfo.maxSets = maxSets;
+
+        VkDescriptorPool pool;
+        if (vkCreateDescriptorPool(device.device(), &descriptorPoolInfo, nullptr, &pool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create descriptor pool!");
+        }
+        return pool;
+    }
+
+    bool DescriptorAllocator::allocateFromChain(
+        PoolChain &chain, VkDescriptorSetLayout descriptorSetLayout, VkDescriptorSet &descriptor)
+    {
+        VkDescriptorSetAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        allocInfo.pSetLayouts = &descriptorSetLayout;
+        allocInfo.descriptorSetCount = 1;
+
+        while (true)
+        {
+            bool freshPool = chain.current == chain.pools.size();
+            if (freshPool)
+            {
+                uint32_t maxSets = std::min(setsPerPool << std::min<size_t>(chain.pools.size(), 12), MAX_SETS_PER_POOL);
+                chain.pools.push_back(createPool(maxSets));
+            }
+
+            allocInfo.descriptorPool = chain.pools[chain.current];
+            VkResult result = vkAllocateDescriptorSets(device.device(), &allocInfo, &descriptor);
+            if (result == VK_SUCCESS)
+            {
+                return true;
+            }
+            if (result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+            {
+                return false;
+            }
+
+            // A brand new pool that cannot fit one set never will
+            if (freshPool)
+            {
+                return false;
+            }
+            chain.current++;
+        }
+    }
+
+    // *************** Descriptor Set Cache *********************
+
+    bool DescriptorSetCache::Resource::operator==(const Resource &other) const
+    {
+        return binding == other.binding && arrayElement == other.arrayElement && descriptorType == other.descriptorType &&
+               handle == other.handle && sampler == other.sampler && offset == other.offset && range == other.range &&
+               imageLayout == other.imageLayout;
+    }
+
+    size_t DescriptorSetCache::KeyHash::operator()(const Key &key) const
+    {
+        size_t seed = 0;
+        hashCombine(seed, Device::handleKey(key.layout));
+        for (const auto &resource : key.resources)
+        {
+            hashCombine(seed, resource.binding, resource.arrayElement, resource.handle, resource.sampler, resource.offset, resource.range);
+        }
+        return seed;
+    }
+
+    DescriptorSetCache::DescriptorSetCache(Device &device, DescriptorAllocator &allocator)
+        : device{device}, allocator{allocator}, recycled{std::make_shared<RecycledSets>()}
+    {
+        listenerId = device.addResourceListener(
+            [this](uint64_t handle)
+            { invalidate(handle); });
+    }
+
+    DescriptorSetCache::~DescriptorSetCache()
+    {
+        device.removeResourceListener(listenerId);
+    }
+
+    void DescriptorSetCache::invalidate(uint64_t resourceHandle)
+    {
+        for (auto it = sets.begin(); it != sets.end();)
+        {
+            const auto &resources = it->first.resources;
+            bool referenced = std::any_of(resources.begin(), resources.end(), [&](const Resource &resource)
+                                          { return resource.handle == resourceHandle || resource.sampler == resourceHandle; });
+            if (!referenced)
+            {
+                ++it;
+                continue;
+            }
+
+            // The set may still be in flight; it becomes reusable once the current frame retires
+            std::weak_ptr<RecycledSets> recycledSets = recycled;
+            VkDescriptorSetLayout layout = it->first.layout;
+            VkDescriptorSet set = it->second;
+            device.deletionQueue().push(
+                [recycledSets, layout, set]()
+                {
+                    if (auto available = recycledSets.lock())
+                    {
+                        (*available)[layout].push_back(set);
+                    }
+                });
+            it = sets.erase(it);
+        }
+    }
+
+    bool DescriptorSetCache::find(
+        VkDescriptorSetLayout layout, const std::vector<VkWriteDescriptorSet> &writes, VkDescriptorSet &set)
+    {
+        lookupKey.layout = layout;
+        lookupKey.resources.clear();
+        for (const auto &write : writes)
+        {
+            for (uint32_t i = 0; i < write.descriptorCount; ++i)
+            {
+                Resource resource{write.dstBinding, write.dstArrayElement + i, write.descriptorType, 0, 0, 0, 0, VK_IMAGE_LAYOUT_UNDEFINED};
+                if (write.pBufferInfo != nullptr)
+                {
+                    resource.handle = Device::handleKey(write.pBufferInfo[i].buffer);
+                    resource.offset = write.pBufferInfo[i].offset;
+                    resource.range = write.pBufferInfo[i].range;
+                }
+                else if (write.pImageInfo != nullptr)
+                {
+                    resource.handle = Device::handleKey(write.pImageInfo[i].imageView);
+                    resource.sampler = Device::handleKey(write.pImageInfo[i].sampler);
+                    resource.imageLayout = write.pImageInfo[i].imageLayout;
+                }
+                lookupKey.resources.push_back(resource);
+            }
+        }
+        std::sort(lookupKey.resources.begin(), lookupKey.resources.end(), [](const Resource &a, const Resource &b)
+                  { return a.binding != b.binding ? a.binding < b.binding : a.arrayElement < b.arrayElement; });
+
+        auto it = sets.find(lookupKey);
+        if (it == sets.end())
+        {
+            misses++;
+            return false;
+        }
+        hits++;
+        set = it->second;
+        return true;
+    }
+
+    bool DescriptorSetCache::acquire(VkDescriptorSetLayout layout, VkDescriptorSet &set)
+    {
+        auto &available = (*recycled)[layout];
+        if (!available.empty())
+        {
+            set = available.back();
+            available.pop_back();
+            return true;
+        }
+        return allocator.allocate(layout, set, DescriptorAllocator::Lifetime::Static);
+    }
+
+    void DescriptorSetCache::insert(VkDescriptorSet set)
+    {
+        sets.emplace(lookupKey, set);
+    }
+
     // *************** Descriptor Writer *********************
 
     DescriptorWriter::DescriptorWriter(DescriptorSetLayout &setLayout, DescriptorPool &pool)
-        : setLayout{setLayout}, pool{pool} {}
+        : setLayout{setLayout}, pool{&pool} {}
+
+    DescriptorWriter::DescriptorWriter(
+        DescriptorSetLayout &setLayout,
+        DescriptorAllocator &allocator,
+        DescriptorAllocator::Lifetime lifetime)
+        : setLayout{setLayout}, allocator{&allocator}, lifetime{lifetime} {}
 
     DescriptorWriter &DescriptorWriter::writeBuffer(
         uint32_t binding, VkDescriptorBufferInfo *bufferInfo)
@@ -199,7 +523,9 @@ namespace YTVK
 
     bool DescriptorWriter::build(VkDescriptorSet &set)
     {
-        bool success = pool.allocateDescriptor(setLayout.getDescriptorSetLayout(), set);
+        bool success = pool != nullptr
+                           ? pool->allocateDescriptor(setLayout.getDescriptorSetLayout(), set)
+                           : allocator->allocate(setLayout.getDescriptorSetLayout(), set, lifetime);
         if (!success)
         {
             return false;
@@ -208,13 +534,95 @@ namespace YTVK
         return true;
     }
 
+    bool DescriptorWriter::build(VkDescriptorSet &set, DescriptorSetCache &cache)
+    {
+        VkDescriptorSetLayout layout = setLayout.getDescriptorSetLayout();
+        if (cache.find(layout, writes, set))
+        {
+            return true;
+        }
+        if (!cache.acquire(layout, set))
+        {
+            return false;
+        }
+        overwrite(set);
+        cache.insert(set);
+        return true;
+    }
+
     void DescriptorWriter::overwrite(VkDescriptorSet &set)
     {
         for (auto &write : writes)
         {
             write.dstSet = set;
         }
-        vkUpdateDescriptorSets(pool.device.device(), writes.size(), writes.data(), 0, nullptr);
+        vkUpdateDescriptorSets(setLayout.device.device(), writes.size(), writes.data(), 0, nullptr);
+    }
+
+    // *************** Push Descriptor Writer *********************
+
+    PushDescriptorWriter::PushDescriptorWriter(DescriptorSetLayout &setLayout, DescriptorAllocator &allocator)
+        : setLayout{setLayout}, allocator{allocator} {}
+
+    VkWriteDescriptorSet &PushDescriptorWriter::addWrite(uint32_t binding)
+    {
+        assert(setLayout.bindings.count(binding) == 1 && "Layout does not contain specified binding");
+        assert(writeCount < MAX_WRITES && "Too many push descriptor writes");
+
+        auto &bindingDescription = setLayout.bindings[binding];
+
+        assert(
+            bindingDescription.descriptorCount == 1 &&
+            "Binding single descriptor info, but binding expects multiple");
+
+        VkWriteDescriptorSet &write = writes[writeCount++];
+        write = {};
+        write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+        write.descriptorType = bindingDescription.descriptorType;
+        write.dstBinding = binding;
+        write.descriptorCount = 1;
+        return write;
+    }
+
+    PushDescriptorWriter &PushDescriptorWriter::writeBuffer(
+        uint32_t binding, VkDescriptorBufferInfo *bufferInfo)
+    {
+        addWrite(binding).pBufferInfo = bufferInfo;
+        return *this;
+    }
+
+    PushDescriptorWriter &PushDescriptorWriter::writeImage(
+        uint32_t binding, VkDescriptorImageInfo *imageInfo)
+    {
+        addWrite(binding).pImageInfo = imageInfo;
+        return *this;
+    }
+
+    bool PushDescriptorWriter::push(
+        VkCommandBuffer commandBuffer,
+        VkPipelineBindPoint bindPoint,
+        VkPipelineLayout pipelineLayout,
+        uint32_t set)
+    {
+        Device &device = setLayout.device;
+        if (setLayout.isPushDescriptor())
+        {
+            device.cmdPushDescriptorSet(commandBuffer, bindPoint, pipelineLayout, set, writeCount, writes.data());
+            return true;
+        }
+
+        VkDescriptorSet descriptorSet;
+        if (!allocator.allocate(setLayout.getDescriptorSetLayout(), descriptorSet, DescriptorAllocator::Lifetime::Frame))
+        {
+            return false;
+        }
+        for (uint32_t i = 0; i < writeCount; ++i)
+        {
+            writes[i].dstSet = descriptorSet;
+        }
+        vkUpdateDescriptorSets(device.device(), writeCount, writes.data(), 0, nullptr);
+        vkCmdBindDescriptorSets(commandBuffer, bindPoint, pipelineLayout, set, 1, &descriptorSet, 0, nullptr);
+        return true;
     }
 
 } // namespace lve
\ No newline at end of file
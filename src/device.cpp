@@ -1,8 +1,11 @@
 #include "device.hpp"
+#include "startup_report.hpp"
 
 // std headers
+#include <algorithm>
 #include <cstring>
 #include <iostream>
+#include <limits>
 #include <set>
 #include <unordered_set>
 
@@ -55,18 +58,37 @@ namespace YTVK
   }
 
   // class member functions
-  Device::Device(Window &window) : window{window}
+  Device::Device(Window *window) : window{window}
   {
-    createInstance();
-    setupDebugMessenger();
-    createSurface();
-    pickPhysicalDevice();
-    createLogicalDevice();
-    createCommandPool();
+    if (window != nullptr)
+    {
+      deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+    }
+
+    {
+      StartupReport::Phase phase{"device: create instance"};
+      createInstance();
+      setupDebugMessenger();
+    }
+    {
+      StartupReport::Phase phase{"device: surface and physical device"};
+      createSurface();
+      pickPhysicalDevice();
+    }
+    {
+      StartupReport::Phase phase{"device: logical device"};
+      createLogicalDevice();
+      createCommandPool();
+      createTimelineSemaphore();
+    }
   }
 
   Device::~Device()
   {
+    vkDeviceWaitIdle(device_);
+    deletionQueue_.flush();
+
+    vkDestroySemaphore(device_, timelineSemaphore_, nullptr);
     vkDestroyCommandPool(device_, commandPool, nullptr);
     vkDestroyDevice(device_, nullptr);
 
@@ -75,7 +97,10 @@ namespace YTVK
       DestroyDebugUtilsMessengerEXT(instance, debugMessenger, nullptr);
     }
 
-    vkDestroySurfaceKHR(instance, surface_, nullptr);
+    if (surface_ != VK_NULL_HANDLE)
+    {
+      vkDestroySurfaceKHR(instance, surface_, nullptr);
+    }
     vkDestroyInstance(instance, nullptr);
   }
 
@@ -92,13 +117,22 @@ namespace YTVK
     appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
     appInfo.pEngineName = "No Engine";
     appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    appInfo.apiVersion = VK_API_VERSION_1_2;
 
     VkInstanceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     createInfo.pApplicationInfo = &appInfo;
 
     auto extensions = getRequiredExtensions();
+    // Optional: needed by VK_EXT_swapchain_maintenance1 on the device
+    surfaceMaintenance_ = window != nullptr &&
+                          checkOptionalInstanceExtension(VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME) &&
+                          checkOptionalInstanceExtension(VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME);
+    if (surfaceMaintenance_)
+    {
+      extensions.push_back(VK_KHR_GET_SURFACE_CAPABILITIES_2_EXTENSION_NAME);
+      extensions.push_back(VK_EXT_SURFACE_MAINTENANCE_1_EXTENSION_NAME);
+    }
     createInfo.enabledExtensionCount = static_cast<uint32_t>(extensions.size());
     createInfo.ppEnabledExtensionNames = extensions.data();
 
@@ -152,6 +186,13 @@ namespace YTVK
     }
 
     vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+    vulkan12Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+    VkPhysicalDeviceProperties2 properties2{};
+    properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties2.pNext = &vulkan12Properties;
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties2);
+
     std::cout << "physical device: " << properties.deviceName << std::endl;
   }
 
@@ -173,11 +214,81 @@ namespace YTVK
       queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(physicalDevice, &supportedFeatures);
+    pipelineStatisticsQuery_ = supportedFeatures.pipelineStatisticsQuery == VK_TRUE;
+
+    // Optional: lets the memory report cross-check our totals against the driver's
+    bool memoryBudget = checkOptionalDeviceExtension(physicalDevice, VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    if (memoryBudget)
+    {
+      deviceExtensions.push_back(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+    }
+    memoryTracker_.init(physicalDevice, memoryBudget);
+
+    // Optional: transient bindings are pushed into the command buffer instead of allocated
+    bool pushDescriptors = checkOptionalDeviceExtension(physicalDevice, VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+    if (pushDescriptors)
+    {
+      deviceExtensions.push_back(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME);
+    }
+
     VkPhysicalDeviceFeatures deviceFeatures = {};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
+    deviceFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+    // Pre-compressed KTX2 textures; Texture checks per format support before using them
+    deviceFeatures.textureCompressionBC = supportedFeatures.textureCompressionBC;
+    deviceFeatures.textureCompressionASTC_LDR = supportedFeatures.textureCompressionASTC_LDR;
+
+    // Optional: a replaced swap chain is released once its presents signal their fences
+    bool swapchainMaintenance = surfaceMaintenance_ && checkOptionalDeviceExtension(physicalDevice, VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME);
+    VkPhysicalDeviceSwapchainMaintenance1FeaturesEXT supportedMaintenance1 = {};
+    supportedMaintenance1.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SWAPCHAIN_MAINTENANCE_1_FEATURES_EXT;
+
+    VkPhysicalDeviceVulkan12Features supported12Features = {};
+    supported12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    supported12Features.pNext = swapchainMaintenance ? &supportedMaintenance1 : nullptr;
+    VkPhysicalDeviceFeatures2 supportedFeatures2 = {};
+    supportedFeatures2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supportedFeatures2.pNext = &supported12Features;
+    vkGetPhysicalDeviceFeatures2(physicalDevice, &supportedFeatures2);
+
+    // Everything BindlessSet relies on; the renderer falls back to per-draw binding without it
+    bindless_ = supported12Features.descriptorIndexing &&
+                supported12Features.runtimeDescriptorArray &&
+                supported12Features.descriptorBindingPartiallyBound &&
+                supported12Features.descriptorBindingSampledImageUpdateAfterBind &&
+                supported12Features.descriptorBindingStorageBufferUpdateAfterBind &&
+                supported12Features.descriptorBindingUpdateUnusedWhilePending &&
+                supported12Features.shaderSampledImageArrayNonUniformIndexing;
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features = {};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12Features.timelineSemaphore = VK_TRUE;
+    if (bindless_)
+    {
+      vulkan12Features.descriptorIndexing = VK_TRUE;
+      vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+      vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+      vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+      vulkan12Features.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+      vulkan12Features.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+      vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+    }
+
+    presentFences_ = swapchainMaintenance && supportedMaintenance1.swapchainMaintenance1;
+    VkPhysicalDeviceSwapchainMaintenance1FeaturesEXT maintenance1Features = {};
+    maintenance1Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SWAPCHAIN_MAINTENANCE_1_FEATURES_EXT;
+    maintenance1Features.swapchainMaintenance1 = VK_TRUE;
+    if (presentFences_)
+    {
+      deviceExtensions.push_back(VK_EXT_SWAPCHAIN_MAINTENANCE_1_EXTENSION_NAME);
+      vulkan12Features.pNext = &maintenance1Features;
+    }
 
     VkDeviceCreateInfo createInfo = {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &vulkan12Features;
 
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
@@ -203,6 +314,11 @@ namespace YTVK
       throw std::runtime_error("failed to create logical device!");
     }
 
+    if (pushDescriptors)
+    {
+      cmdPushDescriptorSet_ = (PFN_vkCmdPushDescriptorSetKHR)vkGetDeviceProcAddr(device_, "vkCmdPushDescriptorSetKHR");
+    }
+
     vkGetDeviceQueue(device_, indices.graphicsFamily, 0, &graphicsQueue_);
     vkGetDeviceQueue(device_, indices.presentFamily, 0, &presentQueue_);
   }
@@ -223,7 +339,67 @@ namespace YTVK
     }
   }
 
-  void Device::createSurface() { window.createWindowSurface(instance, &surface_); }
+  void Device::createTimelineSemaphore()
+  {
+    VkSemaphoreTypeCreateInfo typeInfo = {};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo = {};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+
+    if (vkCreateSemaphore(device_, &semaphoreInfo, nullptr, &timelineSemaphore_) != VK_SUCCESS)
+    {
+      throw std::runtime_error("failed to create timeline semaphore!");
+    }
+  }
+
+  uint64_t Device::completedTimelineValue()
+  {
+    uint64_t value = 0;
+    if (vkGetSemaphoreCounterValue(device_, timelineSemaphore_, &value) != VK_SUCCESS)
+    {
+      throw std::runtime_error("failed to query timeline semaphore!");
+    }
+    completedTimelineValue_ = std::max(completedTimelineValue_, value);
+    return completedTimelineValue_;
+  }
+
+  bool Device::isTimelineValueComplete(uint64_t value)
+  {
+    // Cached first so repeated queries for old values never touch the driver
+    return value <= completedTimelineValue_ || value <= completedTimelineValue();
+  }
+
+  void Device::waitForTimelineValue(uint64_t value)
+  {
+    if (isTimelineValueComplete(value))
+    {
+      return;
+    }
+
+    VkSemaphoreWaitInfo waitInfo = {};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &timelineSemaphore_;
+    waitInfo.pValues = &value;
+
+    if (vkWaitSemaphores(device_, &waitInfo, std::numeric_limits<uint64_t>::max()) != VK_SUCCESS)
+    {
+      throw std::runtime_error("failed to wait for timeline semaphore!");
+    }
+    completedTimelineValue_ = std::max(completedTimelineValue_, value);
+  }
+
+  void Device::createSurface()
+  {
+    if (window != nullptr)
+    {
+      window->createWindowSurface(instance, &surface_);
+    }
+  }
 
   bool Device::isDeviceSuitable(VkPhysicalDevice device)
   {
@@ -231,18 +407,28 @@ namespace YTVK
 
     bool extensionsSupported = checkDeviceExtensionSupport(device);
 
-    bool swapChainAdequate = false;
-    if (extensionsSupported)
+    bool swapChainAdequate = isHeadless();
+    if (extensionsSupported && !isHeadless())
     {
       SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
       swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
     }
 
-    VkPhysicalDeviceFeatures supportedFeatures;
-    vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
+    VkPhysicalDeviceVulkan12Features supportedVulkan12Features = {};
+    supportedVulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+
+    VkPhysicalDeviceFeatures2 supportedFeatures = {};
+    supportedFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    supportedFeatures.pNext = &supportedVulkan12Features;
+    vkGetPhysicalDeviceFeatures2(device, &supportedFeatures);
+
+    VkPhysicalDeviceProperties deviceProperties;
+    vkGetPhysicalDeviceProperties(device, &deviceProperties);
 
     return indices.isComplete() && extensionsSupported && swapChainAdequate &&
-           supportedFeatures.samplerAnisotropy;
+           deviceProperties.apiVersion >= VK_API_VERSION_1_2 &&
+           supportedFeatures.features.samplerAnisotropy &&
+           supportedVulkan12Features.timelineSemaphore;
   }
 
   void Device::populateDebugMessengerCreateInfo(
@@ -303,11 +489,16 @@ namespace YTVK
 
   std::vector<const char *> Device::getRequiredExtensions()
   {
-    uint32_t glfwExtensionCount = 0;
-    const char **glfwExtensions;
-    glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+    std::vector<const char *> extensions;
 
-    std::vector<const char *> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    // Headless devices must not touch GLFW, which may have no display to initialize against
+    if (window != nullptr)
+    {
+      uint32_t glfwExtensionCount = 0;
+      const char **glfwExtensions;
+      glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+      extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+    }
 
     if (enableValidationLayers)
     {
@@ -366,6 +557,45 @@ namespace YTVK
     return requiredExtensions.empty();
   }
 
+  bool Device::checkOptionalInstanceExtension(const char *name)
+  {
+    uint32_t extensionCount = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, availableExtensions.data());
+
+    for (const auto &extension : availableExtensions)
+    {
+      if (strcmp(extension.extensionName, name) == 0)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool Device::checkOptionalDeviceExtension(VkPhysicalDevice device, const char *name)
+  {
+    uint32_t extensionCount;
+    vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+    std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+    vkEnumerateDeviceExtensionProperties(
+        device,
+        nullptr,
+        &extensionCount,
+        availableExtensions.data());
+
+    for (const auto &extension : availableExtensions)
+    {
+      if (strcmp(extension.extensionName, name) == 0)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
   QueueFamilyIndices Device::findQueueFamilies(VkPhysicalDevice device)
   {
     QueueFamilyIndices indices;
@@ -385,7 +615,15 @@ namespace YTVK
         indices.graphicsFamilyHasValue = true;
       }
       VkBool32 presentSupport = false;
-      vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &presentSupport);
+      if (isHeadless())
+      {
+        // Nothing is presented, the graphics queue stands in for the present queue
+        presentSupport = indices.graphicsFamilyHasValue && indices.graphicsFamily == static_cast<uint32_t>(i);
+      }
+      else
+      {
+        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface_, &presentSupport);
+      }
       if (queueFamily.queueCount > 0 && presentSupport)
       {
         indices.presentFamily = i;
@@ -452,6 +690,13 @@ namespace YTVK
     throw std::runtime_error("failed to find supported format!");
   }
 
+  VkFormatProperties Device::getFormatProperties(VkFormat format)
+  {
+    VkFormatProperties props;
+    vkGetPhysicalDeviceFormatProperties(physicalDevice, format, &props);
+    return props;
+  }
+
   uint32_t Device::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
   {
     VkPhysicalDeviceMemoryProperties memProperties;
@@ -494,10 +739,18 @@ namespace YTVK
     allocInfo.allocationSize = memRequirements.size;
     allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
 
+    if (!memoryTracker_.tryReserve(allocInfo.allocationSize, allocInfo.memoryTypeIndex))
+    {
+      vkDestroyBuffer(device_, buffer, nullptr);
+      throw MemoryBudgetExceeded("gpu memory budget exceeded allocating " + std::to_string(allocInfo.allocationSize) + " byte buffer");
+    }
+
     if (vkAllocateMemory(device_, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS)
     {
+      memoryTracker_.release(allocInfo.allocationSize, allocInfo.memoryTypeIndex);
       throw std::runtime_error("failed to allocate vertex buffer memory!");
     }
+    memoryTracker_.track(bufferMemory, allocInfo.allocationSize, allocInfo.memoryTypeIndex, MemoryTracker::categorize(usage, properties));
 
     vkBindBufferMemory(device_, buffer, bufferMemory, 0);
   }
@@ -522,18 +775,45 @@ namespace YTVK
   }
 
   void Device::endSingleTimeCommands(VkCommandBuffer commandBuffer)
+  {
+    // Wait on our own timeline value instead of draining the whole queue
+    waitForTimelineValue(submitCommands(commandBuffer));
+
+    vkFreeCommandBuffers(device_, commandPool, 1, &commandBuffer);
+  }
+
+  uint64_t Device::submitSingleTimeCommands(VkCommandBuffer commandBuffer)
+  {
+    uint64_t signalValue = submitCommands(commandBuffer);
+    deletionQueue_.push(signalValue, [this, commandBuffer]()
+                        { vkFreeCommandBuffers(device_, commandPool, 1, &commandBuffer); });
+    return signalValue;
+  }
+
+  uint64_t Device::submitCommands(VkCommandBuffer commandBuffer)
   {
     vkEndCommandBuffer(commandBuffer);
 
+    uint64_t signalValue = nextTimelineValue();
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues = &signalValue;
+
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &timelineSemaphore_;
 
-    vkQueueSubmit(graphicsQueue_, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(graphicsQueue_);
-
-    vkFreeCommandBuffers(device_, commandPool, 1, &commandBuffer);
+    if (vkQueueSubmit(graphicsQueue_, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+    {
+      throw std::runtime_error("failed to submit single time commands!");
+    }
+    return signalValue;
   }
 
   void Device::copyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
@@ -577,6 +857,34 @@ namespace YTVK
     endSingleTimeCommands(commandBuffer);
   }
 
+  uint32_t Device::addResourceListener(ResourceListener listener)
+  {
+    resourceListeners_.push_back({nextResourceListenerId_, std::move(listener)});
+    return nextResourceListenerId_++;
+  }
+
+  void Device::removeResourceListener(uint32_t id)
+  {
+    resourceListeners_.erase(
+        std::remove_if(resourceListeners_.begin(), resourceListeners_.end(), [id](const auto &entry)
+                       { return entry.first == id; }),
+        resourceListeners_.end());
+  }
+
+  void Device::notifyResourceDestroyed(uint64_t handle)
+  {
+    for (auto &entry : resourceListeners_)
+    {
+      entry.second(handle);
+    }
+  }
+
+  void Device::freeMemory(VkDeviceMemory memory)
+  {
+    memoryTracker_.untrack(memory);
+    vkFreeMemory(device_, memory, nullptr);
+  }
+
   void Device::createImageWithInfo(
       const VkImageCreateInfo &imageInfo,
       VkMemoryPropertyFlags properties,
@@ -596,10 +904,18 @@ namespace YTVK
     allocInfo.allocationSize = memRequirements.size;
     allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, properties);
 
+    if (!memoryTracker_.tryReserve(allocInfo.allocationSize, allocInfo.memoryTypeIndex))
+    {
+      vkDestroyImage(device_, image, nullptr);
+      throw MemoryBudgetExceeded("gpu memory budget exceeded allocating " + std::to_string(allocInfo.allocationSize) + " byte image");
+    }
+
     if (vkAllocateMemory(device_, &allocInfo, nullptr, &imageMemory) != VK_SUCCESS)
     {
+      memoryTracker_.release(allocInfo.allocationSize, allocInfo.memoryTypeIndex);
       throw std::runtime_error("failed to allocate image memory!");
     }
+    memoryTracker_.track(imageMemory, allocInfo.allocationSize, allocInfo.memoryTypeIndex, MemoryTracker::categorize(imageInfo.usage));
 
     if (vkBindImageMemory(device_, image, imageMemory, 0) != VK_SUCCESS)
     {
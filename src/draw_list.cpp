@@ -0,0 +1,172 @@
+#include "draw_list.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+namespace YTVK
+{
+    namespace
+    {
+        static_assert(1 + DrawList::PIPELINE_BITS + DrawList::MODEL_BITS + DrawList::MATERIAL_BITS + DrawList::DEPTH_BITS == 64,
+                      "sort key fields must fill 64 bits");
+
+        enum SortStep : uint32_t
+        {
+            FIND_DIFFERENCES,
+            COUNT_DIGITS,
+            SCATTER
+        };
+
+        uint64_t field(uint32_t value, uint32_t bits)
+        {
+            return value & ((1u << bits) - 1u);
+        }
+
+        // Positive floats order like their bit patterns, so the top bits are a depth with relative precision
+        uint64_t quantizeDepth(float viewDepth)
+        {
+            if (!(viewDepth > 0.0f))
+            {
+                return 0;
+            }
+            uint32_t bits = 0;
+            std::memcpy(&bits, &viewDepth, sizeof(bits));
+            return bits >> (31 - DrawList::DEPTH_BITS);
+        }
+    }
+
+    uint64_t DrawList::opaqueKey(uint32_t pipeline, uint32_t model, uint32_t material, float viewDepth)
+    {
+        return field(pipeline, PIPELINE_BITS) << (MODEL_BITS + MATERIAL_BITS + DEPTH_BITS) |
+               field(model, MODEL_BITS) << (MATERIAL_BITS + DEPTH_BITS) |
+               field(material, MATERIAL_BITS) << DEPTH_BITS |
+               quantizeDepth(viewDepth);
+    }
+
+    uint64_t DrawList::translucentKey(uint32_t pipeline, uint32_t model, uint32_t material, float viewDepth)
+    {
+        uint64_t farToNear = ((1u << DEPTH_BITS) - 1u) - quantizeDepth(viewDepth);
+        return uint64_t{1} << 63 |
+               farToNear << (PIPELINE_BITS + MODEL_BITS + MATERIAL_BITS) |
+               field(pipeline, PIPELINE_BITS) << (MODEL_BITS + MATERIAL_BITS) |
+               field(model, MODEL_BITS) << MATERIAL_BITS |
+               field(material, MATERIAL_BITS);
+    }
+
+    DrawList::DrawList(uint32_t threadCount)
+        : pool{std::max(1u, std::min(threadCount, std::thread::hardware_concurrency()))}
+    {
+    }
+
+    void DrawList::sort()
+    {
+        size_t count = draws.size();
+        if (count < 2)
+        {
+            return;
+        }
+
+        chunkCount = std::clamp<size_t>(count / MIN_DRAWS_PER_THREAD, 1, pool.size());
+        chunkSize = (count + chunkCount - 1) / chunkCount;
+        chunkDifferences.resize(chunkCount);
+        chunkOffsets.resize(chunkCount);
+        scratch.resize(count);
+
+        // Captures only this, so building the std::function does not allocate either
+        auto job = [this](size_t firstChunk, size_t lastChunk)
+        { sortChunks(firstChunk, lastChunk); };
+
+        source = draws.data();
+        destination = scratch.data();
+        step = FIND_DIFFERENCES;
+        pool.parallelFor(chunkCount, 1, job);
+
+        uint64_t differences = 0;
+        for (uint64_t chunkDifference : chunkDifferences)
+        {
+            differences |= chunkDifference;
+        }
+
+        for (shift = 0; shift < 64; shift += 8)
+        {
+            // Every key has the same digit here, e.g. the pipeline bits while there is one pipeline
+            if ((differences >> shift & 0xFF) == 0)
+            {
+                continue;
+            }
+
+            step = COUNT_DIGITS;
+            pool.parallelFor(chunkCount, 1, job);
+
+            // Each chunk scatters into its own run of every digit's range, which keeps the sort stable
+            uint32_t offset = 0;
+            for (uint32_t digit = 0; digit < 256; ++digit)
+            {
+                for (auto &offsets : chunkOffsets)
+                {
+                    uint32_t digitCount = offsets[digit];
+                    offsets[digit] = offset;
+                    offset += digitCount;
+                }
+            }
+
+            step = SCATTER;
+            pool.parallelFor(chunkCount, 1, job);
+            std::swap(source, destination);
+        }
+
+        if (source != draws.data())
+        {
+            draws.swap(scratch);
+        }
+    }
+
+    void DrawList::sortChunks(size_t firstChunk, size_t lastChunk)
+    {
+        // Locals, since stores through destination could otherwise alias the members
+        const Draw *in = source;
+        Draw *out = destination;
+        uint32_t digitShift = shift;
+
+        for (size_t chunk = firstChunk; chunk < lastChunk; ++chunk)
+        {
+            size_t begin = chunk * chunkSize;
+            size_t end = std::min(begin + chunkSize, draws.size());
+
+            switch (step)
+            {
+            case FIND_DIFFERENCES:
+            {
+                uint64_t first = in[0].key;
+                uint64_t difference = 0;
+                for (size_t i = begin; i < end; ++i)
+                {
+                    difference |= in[i].key ^ first;
+                }
+                chunkDifferences[chunk] = difference;
+                break;
+            }
+            case COUNT_DIGITS:
+            {
+                Histogram counts{};
+                for (size_t i = begin; i < end; ++i)
+                {
+                    counts[in[i].key >> digitShift & 0xFF]++;
+                }
+                chunkOffsets[chunk] = counts;
+                break;
+            }
+            default:
+            {
+                Histogram offsets = chunkOffsets[chunk];
+                for (size_t i = begin; i < end; ++i)
+                {
+                    out[offsets[in[i].key >> digitShift & 0xFF]++] = in[i];
+                }
+                break;
+            }
+            }
+        }
+    }
+}
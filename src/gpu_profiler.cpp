@@ -0,0 +1,142 @@
+#include "gpu_profiler.hpp"
+
+#include <stdexcept>
+
+namespace YTVK
+{
+    GpuProfiler::Scope::Scope(GpuProfiler &profiler, VkCommandBuffer commandBuffer, const char *name)
+        : profiler{profiler}, commandBuffer{commandBuffer}, index{profiler.beginScope(commandBuffer, name)}
+    {
+    }
+
+    GpuProfiler::Scope::~Scope()
+    {
+        profiler.endScope(commandBuffer, index);
+    }
+
+    GpuProfiler::GpuProfiler(Device &device, uint32_t framesInFlight) : device{device}, frames(framesInFlight)
+    {
+        // Guarantees timestamp support on every graphics queue, so no per-family check is needed
+        if (!device.properties.limits.timestampComputeAndGraphics)
+        {
+            return;
+        }
+
+        VkQueryPoolCreateInfo queryPoolInfo{};
+        queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+        queryPoolInfo.queryCount = framesInFlight * MAX_SCOPES_PER_FRAME * 2;
+
+        if (vkCreateQueryPool(device.device(), &queryPoolInfo, nullptr, &queryPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create timestamp query pool");
+        }
+
+        timestampPeriod = device.properties.limits.timestampPeriod;
+        for (auto &frame : frames)
+        {
+            frame.names.reserve(MAX_SCOPES_PER_FRAME);
+            frame.depths.reserve(MAX_SCOPES_PER_FRAME);
+        }
+        results.reserve(MAX_SCOPES_PER_FRAME);
+    }
+
+    GpuProfiler::~GpuProfiler()
+    {
+        if (queryPool != VK_NULL_HANDLE)
+        {
+            vkDestroyQueryPool(device.device(), queryPool, nullptr);
+        }
+    }
+
+    void GpuProfiler::beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+    {
+        currentFrameIndex = frameIndex;
+        currentDepth = 0;
+        frameNumber++;
+
+        if (!isEnabled())
+        {
+            return;
+        }
+
+        FrameQueries &frame = frames[frameIndex];
+        if (frame.submitted && device.isTimelineValueComplete(frame.timelineValue))
+        {
+            collect(frame, frameIndex);
+        }
+
+        frame.names.clear();
+        frame.depths.clear();
+        frame.submitted = false;
+        frame.frameNumber = frameNumber;
+        vkCmdResetQueryPool(commandBuffer, queryPool, firstQuery(frameIndex), MAX_SCOPES_PER_FRAME * 2);
+    }
+
+    void GpuProfiler::endFrame(uint64_t timelineValue)
+    {
+        FrameQueries &frame = frames[currentFrameIndex];
+        frame.timelineValue = timelineValue;
+        frame.submitted = !frame.names.empty();
+    }
+
+    uint32_t GpuProfiler::beginScope(VkCommandBuffer commandBuffer, const char *name)
+    {
+        FrameQueries &frame = frames[currentFrameIndex];
+        if (!isEnabled() || frame.names.size() >= MAX_SCOPES_PER_FRAME)
+        {
+            return INVALID_SCOPE;
+        }
+
+        uint32_t index = static_cast<uint32_t>(frame.names.size());
+        frame.names.push_back(name);
+        frame.depths.push_back(currentDepth++);
+
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, queryPool, firstQuery(currentFrameIndex) + 2 * index);
+        return index;
+    }
+
+    void GpuProfiler::endScope(VkCommandBuffer commandBuffer, uint32_t index)
+    {
+        if (index == INVALID_SCOPE)
+        {
+            return;
+        }
+
+        currentDepth--;
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, queryPool, firstQuery(currentFrameIndex) + 2 * index + 1);
+    }
+
+    void GpuProfiler::collect(FrameQueries &frame, uint32_t frameIndex)
+    {
+        uint32_t queryCount = static_cast<uint32_t>(frame.names.size()) * 2;
+
+        // Value plus availability word per query; never blocks, a missing result skips the frame
+        // Lives in the profiler so steady-state frames never allocate
+        auto &data = queryData;
+        VkResult result = vkGetQueryPoolResults(
+            device.device(),
+            queryPool,
+            firstQuery(frameIndex),
+            queryCount,
+            queryCount * 2 * sizeof(uint64_t),
+            data.data(),
+            2 * sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+        if (result != VK_SUCCESS)
+        {
+            return;
+        }
+
+        results.clear();
+        for (size_t i = 0; i < frame.names.size(); ++i)
+        {
+            uint64_t begin = data[4 * i];
+            uint64_t end = data[4 * i + 2];
+            bool available = data[4 * i + 1] != 0 && data[4 * i + 3] != 0;
+            float nanoseconds = available && end >= begin ? static_cast<float>(end - begin) * timestampPeriod : 0.0f;
+            results.push_back({frame.names[i], frame.depths[i], nanoseconds / 1e6f});
+        }
+        resultsFrameNumber = frame.frameNumber;
+    }
+}
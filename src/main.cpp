@@ -3,11 +3,11 @@
 #include <iostream>
 #include <stdexcept>
 
-int main()
+int main(int argc, char **argv)
 {
-    YTVK::App app{};
     try
     {
+        YTVK::App app{YTVK::AppConfig::fromCommandLine(argc, argv)};
         app.run();
     }
     catch (const std::exception &e)
@@ -0,0 +1,234 @@
+#include "memory_tracker.hpp"
+
+#include <iomanip>
+#include <limits>
+
+namespace YTVK
+{
+    namespace
+    {
+        double toMiB(VkDeviceSize bytes)
+        {
+            return static_cast<double>(bytes) / (1024.0 * 1024.0);
+        }
+    }
+
+    const char *memoryCategoryName(MemoryCategory category)
+    {
+        switch (category)
+        {
+        case MemoryCategory::Vertex:
+            return "vertex";
+        case MemoryCategory::Index:
+            return "index";
+        case MemoryCategory::Uniform:
+            return "uniform";
+        case MemoryCategory::Depth:
+            return "depth";
+        case MemoryCategory::Staging:
+            return "staging";
+        case MemoryCategory::Texture:
+            return "texture";
+        case MemoryCategory::RenderTarget:
+            return "render target";
+        default:
+            return "other";
+        }
+    }
+
+    bool MemoryHeapReport::divergesFromDriver() const
+    {
+        return driverUsage < tracked.bytes || driverUsage - tracked.bytes > UNTRACKED_SLACK;
+    }
+
+    void MemoryReport::print(std::ostream &out) const
+    {
+        out << std::fixed << std::setprecision(1);
+        out << "gpu memory: " << toMiB(deviceLocalBytes) << " MiB device local";
+        if (deviceLocalLimit > 0)
+        {
+            out << " of " << toMiB(deviceLocalLimit) << " MiB budget";
+        }
+        out << std::endl;
+
+        for (size_t i = 0; i < heaps.size(); ++i)
+        {
+            const auto &heap = heaps[i];
+            out << "  heap " << i << ((heap.flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) ? " (device local)" : "")
+                << ": " << toMiB(heap.tracked.bytes) << " MiB in " << heap.tracked.allocations << " allocations";
+            if (hasDriverBudget)
+            {
+                out << ", driver reports " << toMiB(heap.driverUsage) << " MiB used of " << toMiB(heap.driverBudget) << " MiB budget";
+            }
+            out << ", heap size " << toMiB(heap.size) << " MiB" << std::endl;
+        }
+
+        for (size_t i = 0; hasDriverBudget && i < heaps.size(); ++i)
+        {
+            if (heaps[i].divergesFromDriver())
+            {
+                out << "  warning: heap " << i << " tracks " << toMiB(heaps[i].tracked.bytes) << " MiB but the driver reports "
+                    << toMiB(heaps[i].driverUsage) << " MiB in use" << std::endl;
+            }
+        }
+
+        for (size_t i = 0; i < categories.size(); ++i)
+        {
+            if (categories[i].allocations > 0)
+            {
+                out << "  " << memoryCategoryName(static_cast<MemoryCategory>(i)) << ": "
+                    << toMiB(categories[i].bytes) << " MiB in " << categories[i].allocations << " allocations" << std::endl;
+            }
+        }
+        out << std::defaultfloat;
+    }
+
+    void MemoryTracker::init(VkPhysicalDevice physicalDevice, bool hasMemoryBudget)
+    {
+        this->physicalDevice = physicalDevice;
+        this->hasMemoryBudget = hasMemoryBudget;
+        vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+    }
+
+    MemoryCategory MemoryTracker::categorize(VkBufferUsageFlags usage, VkMemoryPropertyFlags properties)
+    {
+        if (usage & VK_BUFFER_USAGE_VERTEX_BUFFER_BIT)
+            return MemoryCategory::Vertex;
+        if (usage & VK_BUFFER_USAGE_INDEX_BUFFER_BIT)
+            return MemoryCategory::Index;
+        if (usage & VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT)
+            return MemoryCategory::Uniform;
+
+        // Host visible and only ever copied from or into: upload and readback buffers
+        const VkBufferUsageFlags transfer = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+        if ((properties & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) && (usage & transfer) && !(usage & ~transfer))
+            return MemoryCategory::Staging;
+
+        return MemoryCategory::Other;
+    }
+
+    MemoryCategory MemoryTracker::categorize(VkImageUsageFlags usage)
+    {
+        if (usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)
+            return MemoryCategory::Depth;
+        if (usage & VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT)
+            return MemoryCategory::RenderTarget;
+        if (usage & VK_IMAGE_USAGE_SAMPLED_BIT)
+            return MemoryCategory::Texture;
+
+        return MemoryCategory::Other;
+    }
+
+    bool MemoryTracker::isDeviceLocal(uint32_t heapIndex) const
+    {
+        return (memoryProperties.memoryHeaps[heapIndex].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0;
+    }
+
+    VkDeviceSize MemoryTracker::deviceLocalBytes() const
+    {
+        VkDeviceSize bytes = 0;
+        for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; ++i)
+        {
+            if (isDeviceLocal(i))
+            {
+                bytes += heaps[i].bytes + reservedBytes[i];
+            }
+        }
+        return bytes;
+    }
+
+    VkDeviceSize MemoryTracker::getDeviceLocalHeadroom()
+    {
+        if (deviceLocalLimit == 0)
+        {
+            return std::numeric_limits<VkDeviceSize>::max();
+        }
+
+        std::lock_guard<std::mutex> lock{mutex};
+        VkDeviceSize used = deviceLocalBytes();
+        return used < deviceLocalLimit ? deviceLocalLimit - used : 0;
+    }
+
+    bool MemoryTracker::tryReserve(VkDeviceSize size, uint32_t memoryTypeIndex)
+    {
+        uint32_t heapIndex = memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+
+        std::lock_guard<std::mutex> lock{mutex};
+        if (deviceLocalLimit != 0 && isDeviceLocal(heapIndex) && deviceLocalBytes() + size > deviceLocalLimit)
+        {
+            return false;
+        }
+        reservedBytes[heapIndex] += size;
+        return true;
+    }
+
+    void MemoryTracker::release(VkDeviceSize size, uint32_t memoryTypeIndex)
+    {
+        uint32_t heapIndex = memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+
+        std::lock_guard<std::mutex> lock{mutex};
+        reservedBytes[heapIndex] -= size;
+    }
+
+    void MemoryTracker::track(VkDeviceMemory memory, VkDeviceSize size, uint32_t memoryTypeIndex, MemoryCategory category)
+    {
+        uint32_t heapIndex = memoryProperties.memoryTypes[memoryTypeIndex].heapIndex;
+
+        std::lock_guard<std::mutex> lock{mutex};
+        allocations[memory] = {size, heapIndex, category};
+
+        reservedBytes[heapIndex] -= size;
+        heaps[heapIndex].bytes += size;
+        heaps[heapIndex].allocations++;
+        categories[static_cast<size_t>(category)].bytes += size;
+        categories[static_cast<size_t>(category)].allocations++;
+    }
+
+    void MemoryTracker::untrack(VkDeviceMemory memory)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        auto it = allocations.find(memory);
+        if (it == allocations.end())
+        {
+            return;
+        }
+
+        const Allocation &allocation = it->second;
+        heaps[allocation.heapIndex].bytes -= allocation.size;
+        heaps[allocation.heapIndex].allocations--;
+        categories[static_cast<size_t>(allocation.category)].bytes -= allocation.size;
+        categories[static_cast<size_t>(allocation.category)].allocations--;
+        allocations.erase(it);
+    }
+
+    MemoryReport MemoryTracker::report()
+    {
+        VkPhysicalDeviceMemoryBudgetPropertiesEXT budget{};
+        budget.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_BUDGET_PROPERTIES_EXT;
+        if (hasMemoryBudget)
+        {
+            VkPhysicalDeviceMemoryProperties2 properties{};
+            properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MEMORY_PROPERTIES_2;
+            properties.pNext = &budget;
+            vkGetPhysicalDeviceMemoryProperties2(physicalDevice, &properties);
+        }
+
+        std::lock_guard<std::mutex> lock{mutex};
+        MemoryReport report{};
+        report.hasDriverBudget = hasMemoryBudget;
+        report.categories = categories;
+        report.deviceLocalBytes = deviceLocalBytes();
+        report.deviceLocalLimit = deviceLocalLimit;
+        for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; ++i)
+        {
+            MemoryHeapReport heap{};
+            heap.size = memoryProperties.memoryHeaps[i].size;
+            heap.flags = memoryProperties.memoryHeaps[i].flags;
+            heap.tracked = heaps[i];
+            heap.driverUsage = budget.heapUsage[i];
+            heap.driverBudget = budget.heapBudget[i];
+            report.heaps.push_back(heap);
+        }
+        return report;
+    }
+}
@@ -0,0 +1,574 @@
+#include "mesh_processing.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace YTVK
+{
+    namespace
+    {
+        // Tom Forsyth, "Linear-Speed Vertex Cache Optimisation"
+        float forsythScore(int32_t cachePosition, uint32_t remainingValence, uint32_t cacheSize)
+        {
+            if (remainingValence == 0)
+            {
+                return -1.0f;
+            }
+
+            float score = 0.0f;
+            if (cachePosition >= 0)
+            {
+                if (cachePosition < 3)
+                {
+                    // The last triangle's vertices get a fixed score so strips aren't favoured
+                    score = 0.75f;
+                }
+                else
+                {
+                    float scaler = 1.0f / static_cast<float>(cacheSize - 3);
+                    score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scaler, 1.5f);
+                }
+            }
+
+            return score + 2.0f * std::pow(static_cast<float>(remainingValence), -0.5f);
+        }
+
+        uint16_t quantizeUnorm16(float value, float min, float extent)
+        {
+            if (extent <= 0.0f)
+            {
+                return 0;
+            }
+            float normalized = std::min(std::max((value - min) / extent, 0.0f), 1.0f);
+            return static_cast<uint16_t>(std::lround(normalized * 65535.0f));
+        }
+
+        float dequantizeUnorm16(uint16_t value, float min, float extent)
+        {
+            return min + (static_cast<float>(value) / 65535.0f) * extent;
+        }
+
+        uint8_t quantizeUnorm8(float value)
+        {
+            return static_cast<uint8_t>(std::lround(std::min(std::max(value, 0.0f), 1.0f) * 255.0f));
+        }
+
+        int8_t quantizeSnorm8(float value)
+        {
+            return static_cast<int8_t>(std::lround(std::min(std::max(value, -1.0f), 1.0f) * 127.0f));
+        }
+
+        uint64_t alignUp(uint64_t value, uint64_t alignment)
+        {
+            return (value + alignment - 1) & ~(alignment - 1);
+        }
+    }
+
+    void deduplicateVertices(Model::Builder &builder)
+    {
+        std::vector<Model::Vertex> uniqueVertices{};
+        std::vector<uint32_t> remappedIndices{};
+        std::unordered_map<Model::Vertex, uint32_t> lookup{};
+
+        auto remap = [&](const Model::Vertex &vertex)
+        {
+            auto result = lookup.emplace(vertex, static_cast<uint32_t>(uniqueVertices.size()));
+            if (result.second)
+            {
+                uniqueVertices.push_back(vertex);
+            }
+            remappedIndices.push_back(result.first->second);
+        };
+
+        if (builder.indices.empty())
+        {
+            for (const auto &vertex : builder.vertices)
+            {
+                remap(vertex);
+            }
+        }
+        else
+        {
+            for (uint32_t index : builder.indices)
+            {
+                remap(builder.vertices[index]);
+            }
+        }
+
+        builder.vertices.swap(uniqueVertices);
+        builder.indices.swap(remappedIndices);
+    }
+
+    void optimizeVertexCache(Model::Builder &builder, uint32_t cacheSize)
+    {
+        auto &indices = builder.indices;
+        const size_t vertexCount = builder.vertices.size();
+        const size_t triangleCount = indices.size() / 3;
+
+        if (triangleCount == 0 || cacheSize <= 3)
+        {
+            return;
+        }
+
+        // Vertex -> triangle adjacency in compressed rows; each row shrinks as triangles are emitted
+        std::vector<uint32_t> valence(vertexCount, 0);
+        for (uint32_t index : indices)
+        {
+            valence[index]++;
+        }
+
+        std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            adjacencyOffset[v + 1] = adjacencyOffset[v] + valence[v];
+        }
+
+        std::vector<uint32_t> adjacency(indices.size());
+        std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            for (size_t k = 0; k < 3; ++k)
+            {
+                adjacency[fill[indices[3 * t + k]]++] = static_cast<uint32_t>(t);
+            }
+        }
+
+        std::vector<int32_t> cachePosition(vertexCount, -1);
+        std::vector<float> vertexScore(vertexCount);
+        for (size_t v = 0; v < vertexCount; ++v)
+        {
+            vertexScore[v] = forsythScore(-1, valence[v], cacheSize);
+        }
+
+        std::vector<float> triangleScore(triangleCount);
+        for (size_t t = 0; t < triangleCount; ++t)
+        {
+            triangleScore[t] = vertexScore[indices[3 * t]] + vertexScore[indices[3 * t + 1]] + vertexScore[indices[3 * t + 2]];
+        }
+
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<uint32_t> cache{};
+        std::vector<uint32_t> nextCache{};
+        std::vector<uint32_t> output{};
+        output.reserve(indices.size());
+        cache.reserve(cacheSize + 3);
+        nextCache.reserve(cacheSize + 3);
+
+        size_t scanCursor = 0;
+        int64_t bestTriangle = -1;
+
+        for (size_t emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+        {
+            if (bestTriangle < 0)
+            {
+                // Nothing adjacent to the cache is left, restart from the next unused triangle
+                while (emitted[scanCursor])
+                {
+                    ++scanCursor;
+                }
+                bestTriangle = static_cast<int64_t>(scanCursor);
+            }
+
+            const uint32_t triangle = static_cast<uint32_t>(bestTriangle);
+            const uint32_t triangleVertices[3] = {indices[3 * triangle], indices[3 * triangle + 1], indices[3 * triangle + 2]};
+            emitted[triangle] = true;
+            output.insert(output.end(), triangleVertices, triangleVertices + 3);
+
+            nextCache.clear();
+            for (uint32_t v : triangleVertices)
+            {
+                uint32_t *row = adjacency.data() + adjacencyOffset[v];
+                uint32_t *rowEnd = row + valence[v];
+                uint32_t *found = std::find(row, rowEnd, triangle);
+                if (found != rowEnd)
+                {
+                    std::swap(*found, *(rowEnd - 1));
+                    valence[v]--;
+                }
+
+                if (std::find(nextCache.begin(), nextCache.end(), v) == nextCache.end())
+                {
+                    nextCache.push_back(v);
+                }
+            }
+
+            for (uint32_t v : cache)
+            {
+                if (std::find(nextCache.begin(), nextCache.end(), v) == nextCache.end())
+                {
+                    nextCache.push_back(v);
+                }
+            }
+
+            // Rescore everything that moved, including vertices that just fell out of the cache
+            for (size_t i = 0; i < nextCache.size(); ++i)
+            {
+                uint32_t v = nextCache[i];
+                cachePosition[v] = i < cacheSize ? static_cast<int32_t>(i) : -1;
+                vertexScore[v] = forsythScore(cachePosition[v], valence[v], cacheSize);
+            }
+
+            for (uint32_t v : nextCache)
+            {
+                for (uint32_t i = 0; i < valence[v]; ++i)
+                {
+                    uint32_t t = adjacency[adjacencyOffset[v] + i];
+                    triangleScore[t] = vertexScore[indices[3 * t]] + vertexScore[indices[3 * t + 1]] + vertexScore[indices[3 * t + 2]];
+                }
+            }
+
+            if (nextCache.size() > cacheSize)
+            {
+                nextCache.resize(cacheSize);
+            }
+            cache.swap(nextCache);
+
+            bestTriangle = -1;
+            float bestScore = -1.0f;
+            for (uint32_t v : cache)
+            {
+                for (uint32_t i = 0; i < valence[v]; ++i)
+                {
+                    uint32_t t = adjacency[adjacencyOffset[v] + i];
+                    if (triangleScore[t] > bestScore)
+                    {
+                        bestScore = triangleScore[t];
+                        bestTriangle = t;
+                    }
+                }
+            }
+        }
+
+        indices.swap(output);
+    }
+
+    void optimizeVertexFetch(Model::Builder &builder)
+    {
+        // Lay vertices out in first-use order; unreferenced vertices are dropped
+        std::vector<uint32_t> remap(builder.vertices.size(), std::numeric_limits<uint32_t>::max());
+        std::vector<Model::Vertex> reordered{};
+        reordered.reserve(builder.vertices.size());
+
+        for (auto &index : builder.indices)
+        {
+            if (remap[index] == std::numeric_limits<uint32_t>::max())
+            {
+                remap[index] = static_cast<uint32_t>(reordered.size());
+                reordered.push_back(builder.vertices[index]);
+            }
+            index = remap[index];
+        }
+
+        builder.vertices.swap(reordered);
+    }
+
+    Model::Builder generateLod(const Model::Builder &builder, uint32_t gridResolution)
+    {
+        // Vertex clustering: collapse every vertex within a grid cell to the cell average
+        if (builder.vertices.empty() || gridResolution < 1)
+        {
+            return builder;
+        }
+
+        glm::vec3 min{std::numeric_limits<float>::max()};
+        glm::vec3 max{std::numeric_limits<float>::lowest()};
+        for (const auto &vertex : builder.vertices)
+        {
+            min = glm::min(min, vertex.position);
+            max = glm::max(max, vertex.position);
+        }
+
+        glm::vec3 extent = max - min;
+        float cellSize = std::max(extent.x, std::max(extent.y, extent.z)) / static_cast<float>(gridResolution);
+        if (cellSize <= 0.0f)
+        {
+            return builder;
+        }
+
+        auto cellCoordinate = [&](float value, float origin)
+        {
+            return std::min<uint64_t>(static_cast<uint64_t>((value - origin) / cellSize), gridResolution - 1);
+        };
+
+        std::unordered_map<uint64_t, uint32_t> cellLookup{};
+        std::vector<uint32_t> vertexCell(builder.vertices.size());
+        std::vector<Model::Vertex> sums{};
+        std::vector<uint32_t> counts{};
+
+        for (size_t i = 0; i < builder.vertices.size(); ++i)
+        {
+            const auto &vertex = builder.vertices[i];
+            uint64_t key = cellCoordinate(vertex.position.x, min.x) |
+                           (cellCoordinate(vertex.position.y, min.y) << 21) |
+                           (cellCoordinate(vertex.position.z, min.z) << 42);
+
+            auto result = cellLookup.emplace(key, static_cast<uint32_t>(sums.size()));
+            if (result.second)
+            {
+                sums.push_back(Model::Vertex{});
+                counts.push_back(0);
+            }
+
+            uint32_t cell = result.first->second;
+            vertexCell[i] = cell;
+            sums[cell].position += vertex.position;
+            sums[cell].color += vertex.color;
+            sums[cell].normal += vertex.normal;
+            sums[cell].uv += vertex.uv;
+            counts[cell]++;
+        }
+
+        Model::Builder lod{};
+        lod.vertices.reserve(sums.size());
+        for (size_t cell = 0; cell < sums.size(); ++cell)
+        {
+            float weight = 1.0f / static_cast<float>(counts[cell]);
+            Model::Vertex vertex = sums[cell];
+            vertex.position *= weight;
+            vertex.color *= weight;
+            vertex.uv *= weight;
+            float normalLength = glm::length(vertex.normal);
+            vertex.normal = normalLength > 0.0f ? vertex.normal / normalLength : glm::vec3{0.0f};
+            lod.vertices.push_back(vertex);
+        }
+
+        for (size_t i = 0; i + 2 < builder.indices.size(); i += 3)
+        {
+            uint32_t a = vertexCell[builder.indices[i]];
+            uint32_t b = vertexCell[builder.indices[i + 1]];
+            uint32_t c = vertexCell[builder.indices[i + 2]];
+
+            // Triangles that collapsed into an edge or a point carry no area
+            if (a == b || b == c || a == c)
+            {
+                continue;
+            }
+
+            lod.indices.push_back(a);
+            lod.indices.push_back(b);
+            lod.indices.push_back(c);
+        }
+
+        return lod;
+    }
+
+    float averageCacheMissRatio(const Model::Builder &builder, uint32_t cacheSize)
+    {
+        size_t triangleCount = builder.indices.size() / 3;
+        if (triangleCount == 0)
+        {
+            return 0.0f;
+        }
+
+        std::vector<uint32_t> fifo(cacheSize, std::numeric_limits<uint32_t>::max());
+        size_t head = 0;
+        size_t misses = 0;
+
+        for (uint32_t index : builder.indices)
+        {
+            if (std::find(fifo.begin(), fifo.end(), index) == fifo.end())
+            {
+                fifo[head] = index;
+                head = (head + 1) % cacheSize;
+                misses++;
+            }
+        }
+
+        return static_cast<float>(misses) / static_cast<float>(triangleCount);
+    }
+
+    // *************** Cooked Mesh *********************
+
+    void CookedMesh::write(const std::string &path) const
+    {
+        if (lods.empty() || lods[0].vertices.empty())
+        {
+            throw std::runtime_error("cannot write empty cooked mesh " + path);
+        }
+
+        glm::vec3 positionMin{std::numeric_limits<float>::max()};
+        glm::vec3 positionMax{std::numeric_limits<float>::lowest()};
+        glm::vec2 uvMin{std::numeric_limits<float>::max()};
+        glm::vec2 uvMax{std::numeric_limits<float>::lowest()};
+        for (const auto &lod : lods)
+        {
+            for (const auto &vertex : lod.vertices)
+            {
+                positionMin = glm::min(positionMin, vertex.position);
+                positionMax = glm::max(positionMax, vertex.position);
+                uvMin = glm::min(uvMin, vertex.uv);
+                uvMax = glm::max(uvMax, vertex.uv);
+            }
+        }
+
+        Header header{};
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.sourceHash = sourceHash;
+        header.lodCount = static_cast<uint32_t>(lods.size());
+        for (int i = 0; i < 3; ++i)
+        {
+            header.positionMin[i] = positionMin[i];
+            header.positionExtent[i] = positionMax[i] - positionMin[i];
+        }
+        for (int i = 0; i < 2; ++i)
+        {
+            header.uvMin[i] = uvMin[i];
+            header.uvExtent[i] = uvMax[i] - uvMin[i];
+        }
+
+        std::vector<LodHeader> lodHeaders(lods.size());
+        std::vector<char> payload{};
+        uint64_t payloadStart = sizeof(Header) + sizeof(LodHeader) * lods.size();
+
+        for (size_t l = 0; l < lods.size(); ++l)
+        {
+            const auto &lod = lods[l];
+            auto &lodHeader = lodHeaders[l];
+            lodHeader.vertexCount = static_cast<uint32_t>(lod.vertices.size());
+            lodHeader.indexCount = static_cast<uint32_t>(lod.indices.size());
+            lodHeader.indexSize = lod.vertices.size() <= 0xFFFF ? sizeof(uint16_t) : sizeof(uint32_t);
+
+            payload.resize(alignUp(payloadStart + payload.size(), 16) - payloadStart, 0);
+            lodHeader.vertexOffset = payloadStart + payload.size();
+            for (const auto &vertex : lod.vertices)
+            {
+                PackedVertex packed{};
+                for (int i = 0; i < 3; ++i)
+                {
+                    packed.position[i] = quantizeUnorm16(vertex.position[i], header.positionMin[i], header.positionExtent[i]);
+                    packed.color[i] = quantizeUnorm8(vertex.color[i]);
+                    packed.normal[i] = quantizeSnorm8(vertex.normal[i]);
+                }
+                for (int i = 0; i < 2; ++i)
+                {
+                    packed.uv[i] = quantizeUnorm16(vertex.uv[i], header.uvMin[i], header.uvExtent[i]);
+                }
+
+                const char *bytes = reinterpret_cast<const char *>(&packed);
+                payload.insert(payload.end(), bytes, bytes + sizeof(PackedVertex));
+            }
+
+            payload.resize(alignUp(payloadStart + payload.size(), 4) - payloadStart, 0);
+            lodHeader.indexOffset = payloadStart + payload.size();
+            for (uint32_t index : lod.indices)
+            {
+                if (lodHeader.indexSize == sizeof(uint16_t))
+                {
+                    uint16_t narrow = static_cast<uint16_t>(index);
+                    const char *bytes = reinterpret_cast<const char *>(&narrow);
+                    payload.insert(payload.end(), bytes, bytes + sizeof(narrow));
+                }
+                else
+                {
+                    const char *bytes = reinterpret_cast<const char *>(&index);
+                    payload.insert(payload.end(), bytes, bytes + sizeof(index));
+                }
+            }
+        }
+
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            throw std::runtime_error("failed to open file " + path);
+        }
+
+        file.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+        file.write(reinterpret_cast<const char *>(lodHeaders.data()), sizeof(LodHeader) * lodHeaders.size());
+        file.write(payload.data(), payload.size());
+
+        if (!file)
+        {
+            throw std::runtime_error("failed to write cooked mesh " + path);
+        }
+    }
+
+    Model::Builder CookedMesh::read(AssetView data, uint32_t lod)
+    {
+        Header header;
+        if (data.size < sizeof(Header))
+        {
+            throw std::runtime_error("invalid cooked mesh");
+        }
+        std::memcpy(&header, data.data, sizeof(Header));
+
+        if (header.magic != MAGIC || header.version != VERSION || lod >= header.lodCount ||
+            data.size < sizeof(Header) + sizeof(LodHeader) * header.lodCount)
+        {
+            throw std::runtime_error("invalid cooked mesh");
+        }
+
+        LodHeader lodHeader;
+        std::memcpy(&lodHeader, data.data + sizeof(Header) + sizeof(LodHeader) * lod, sizeof(LodHeader));
+
+        // Offsets are compared before adding so a corrupt one cannot wrap around the size
+        if ((lodHeader.indexSize != sizeof(uint16_t) && lodHeader.indexSize != sizeof(uint32_t)) ||
+            lodHeader.vertexOffset > data.size ||
+            uint64_t{lodHeader.vertexCount} * sizeof(PackedVertex) > data.size - lodHeader.vertexOffset ||
+            lodHeader.indexOffset > data.size ||
+            uint64_t{lodHeader.indexCount} * lodHeader.indexSize > data.size - lodHeader.indexOffset)
+        {
+            throw std::runtime_error("invalid cooked mesh");
+        }
+
+        Model::Builder builder{};
+        builder.vertices.resize(lodHeader.vertexCount);
+        builder.indices.resize(lodHeader.indexCount);
+
+        for (uint32_t v = 0; v < lodHeader.vertexCount; ++v)
+        {
+            PackedVertex packed;
+            std::memcpy(&packed, data.data + lodHeader.vertexOffset + v * sizeof(PackedVertex), sizeof(PackedVertex));
+
+            auto &vertex = builder.vertices[v];
+            for (int i = 0; i < 3; ++i)
+            {
+                vertex.position[i] = dequantizeUnorm16(packed.position[i], header.positionMin[i], header.positionExtent[i]);
+                vertex.color[i] = static_cast<float>(packed.color[i]) / 255.0f;
+                vertex.normal[i] = std::max(static_cast<float>(packed.normal[i]) / 127.0f, -1.0f);
+            }
+            for (int i = 0; i < 2; ++i)
+            {
+                vertex.uv[i] = dequantizeUnorm16(packed.uv[i], header.uvMin[i], header.uvExtent[i]);
+            }
+        }
+
+        const char *indexData = data.data + lodHeader.indexOffset;
+        for (uint32_t i = 0; i < lodHeader.indexCount; ++i)
+        {
+            if (lodHeader.indexSize == sizeof(uint16_t))
+            {
+                uint16_t narrow;
+                std::memcpy(&narrow, indexData + i * sizeof(uint16_t), sizeof(uint16_t));
+                builder.indices[i] = narrow;
+            }
+            else
+            {
+                std::memcpy(&builder.indices[i], indexData + i * sizeof(uint32_t), sizeof(uint32_t));
+            }
+            if (builder.indices[i] >= lodHeader.vertexCount)
+            {
+                throw std::runtime_error("invalid cooked mesh");
+            }
+        }
+
+        return builder;
+    }
+
+    uint64_t CookedMesh::readSourceHash(const std::string &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        Header header{};
+        if (!file.read(reinterpret_cast<char *>(&header), sizeof(Header)) ||
+            header.magic != MAGIC || header.version != VERSION)
+        {
+            return 0;
+        }
+        return header.sourceHash;
+    }
+}
@@ -1,37 +1,45 @@
 #include "model.hpp"
-#include "utils.hpp"
+#include "asset_archive.hpp"
+#include "mesh_processing.hpp"
+#include "trace.hpp"
+#include "startup_report.hpp"
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include <tiny_obj_loader.h>
 
-#define GLM_ENABLE_EXPERIMENTAL
-#include <glm/gtx/hash.hpp>
-
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstring>
 #include <iostream>
+#include <istream>
+#include <streambuf>
 #include <unordered_map>
 
-namespace std
+namespace YTVK
 {
-    template <>
-    struct hash<YTVK::Model::Vertex>
+    namespace
     {
-        size_t operator()(YTVK::Model::Vertex const &vertex) const
+        // Lets tinyobj parse directly out of archive memory without an intermediate copy
+        struct MemoryStreamBuffer : std::streambuf
         {
-            size_t seed = 0;
-            YTVK::hashCombine(seed, vertex.position, vertex.color, vertex.normal, vertex.uv);
-            return seed;
-        }
-    };
-}
+            MemoryStreamBuffer(const char *data, size_t size)
+            {
+                char *begin = const_cast<char *>(data);
+                setg(begin, begin, begin + size);
+            }
+        };
+    }
 
-namespace YTVK
-{
     Model::Model(Device &device, const Model::Builder &builder) : device{device}, hasIndexBuffer{false}
     {
+        static std::atomic<uint32_t> nextSortId{0};
+        sortId = nextSortId.fetch_add(1, std::memory_order_relaxed);
+
         createVertexBuffers(builder.vertices);
+        createPositionBuffer(builder.vertices);
         createIndexBuffers(builder.indices);
+        computeBounds(builder.vertices);
     }
 
     Model::~Model() {}
@@ -64,6 +72,55 @@ namespace YTVK
         device.copyBuffer(stagingBuffer.getBuffer(), vertexBuffer->getBuffer(), bufferSize);
     }
 
+    void Model::createPositionBuffer(const std::vector<Vertex> &vertices)
+    {
+        std::vector<glm::vec3> positions(vertices.size());
+        for (size_t i = 0; i < vertices.size(); ++i)
+        {
+            positions[i] = vertices[i].position;
+        }
+        VkDeviceSize bufferSize = sizeof(positions[0]) * vertexCount;
+        uint32_t positionSize = sizeof(positions[0]);
+
+        Buffer stagingBuffer =
+            {
+                device,
+                positionSize,
+                vertexCount,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
+
+        stagingBuffer.map();
+        stagingBuffer.writeToBuffer((void *)positions.data());
+
+        positionBuffer = std::make_unique<Buffer>(
+            device,
+            positionSize,
+            vertexCount,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+        device.copyBuffer(stagingBuffer.getBuffer(), positionBuffer->getBuffer(), bufferSize);
+    }
+
+    void Model::computeBounds(const std::vector<Vertex> &vertices)
+    {
+        glm::vec3 min{vertices[0].position};
+        glm::vec3 max{vertices[0].position};
+        for (const auto &vertex : vertices)
+        {
+            min = glm::min(min, vertex.position);
+            max = glm::max(max, vertex.position);
+        }
+
+        boundsCenter = 0.5f * (min + max);
+        boundsRadius = 0.0f;
+        for (const auto &vertex : vertices)
+        {
+            boundsRadius = std::max(boundsRadius, glm::length(vertex.position - boundsCenter));
+        }
+    }
+
     void Model::createIndexBuffers(const std::vector<uint32_t> &indices)
     {
         indexCount = static_cast<uint32_t>(indices.size());
@@ -108,6 +165,18 @@ namespace YTVK
         }
     }
 
+    void Model::bindPositions(VkCommandBuffer commandBuffer)
+    {
+        VkBuffer buffers[] = {positionBuffer->getBuffer()};
+        VkDeviceSize offsets[] = {0};
+        vkCmdBindVertexBuffers(commandBuffer, 0, 1, buffers, offsets);
+
+        if (hasIndexBuffer)
+        {
+            vkCmdBindIndexBuffer(commandBuffer, indexBuffer->getBuffer(), 0, VK_INDEX_TYPE_UINT32);
+        }
+    }
+
     void Model::draw(VkCommandBuffer commandBuffer)
     {
         if (hasIndexBuffer)
@@ -146,10 +215,46 @@ namespace YTVK
         return attributeDescriptions;
     }
 
+    std::vector<VkVertexInputBindingDescription> Model::Vertex::getPositionBindDescriptions()
+    {
+        std::vector<VkVertexInputBindingDescription> bindingDescriptions(1);
+        bindingDescriptions[0].binding = 0;
+        bindingDescriptions[0].stride = sizeof(glm::vec3);
+        bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        return bindingDescriptions;
+    }
+
+    std::vector<VkVertexInputAttributeDescription> Model::Vertex::getPositionAttributeDescriptions()
+    {
+        return {{0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0}};
+    }
+
     std::unique_ptr<Model> Model::createModelFromFile(Device &device, const std::string &path)
     {
         Model::Builder builder{};
-        builder.loadModel(path);
+        const std::string cookedExtension = ".ymesh";
+        const std::string objExtension = ".obj";
+        auto hasExtension = [&path](const std::string &extension)
+        {
+            return path.size() > extension.size() &&
+                   path.compare(path.size() - extension.size(), extension.size(), extension) == 0;
+        };
+
+        // ytvk-cook packs models/a.obj as models/a.ymesh, so scenes keep naming the source files
+        AssetArchive *archive = AssetArchive::mounted();
+        std::string cookedPath = hasExtension(objExtension) ? path.substr(0, path.size() - objExtension.size()) + cookedExtension : std::string{};
+        if (hasExtension(cookedExtension))
+        {
+            builder.loadCookedMesh(path);
+        }
+        else if (archive != nullptr && !cookedPath.empty() && archive->contains(cookedPath))
+        {
+            builder.loadCookedMesh(cookedPath);
+        }
+        else
+        {
+            builder.loadModel(path);
+        }
 
         std::cout << "Vertex Count: " << builder.vertices.size() << std::endl;
 
@@ -158,13 +263,23 @@ namespace YTVK
 
     void Model::Builder::loadModel(const std::string &path)
     {
+        YTVK_TRACE_SCOPE("Model::Builder::loadModel");
         tinyobj::attrib_t attrib;
         std::vector<tinyobj::shape_t> shapes;
         std::vector<tinyobj::material_t> materials;
         std::string warn;
         std::string error;
 
-        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &warn, path.c_str()))
+        // Parse out of the resolved bytes so archive entries need no temporary file or copy
+        std::vector<char> storage;
+        AssetView data = AssetArchive::load(path, storage);
+        StartupReport::addBytesParsed(data.size);
+        MemoryStreamBuffer streamBuffer{data.data, data.size};
+        std::istream stream{&streamBuffer};
+        // mtllib names are relative to the model, as when tinyobj opens the file itself
+        tinyobj::MaterialFileReader materialReader{path.substr(0, path.find_last_of('/') + 1)};
+
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &error, &stream, &materialReader))
         {
             throw std::runtime_error(warn + error);
         }
@@ -215,14 +330,26 @@ namespace YTVK
                         };
                 }
 
-                if (uniqueVertices.count(vertex) == 0)
-                {
-                    uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-                    vertices.push_back(vertex);
-                }
-
-                indices.push_back(uniqueVertices[vertex]);
+                addVertex(vertex, uniqueVertices);
             }
         }
     }
+
+    void Model::Builder::addVertex(const Vertex &vertex, std::unordered_map<Vertex, uint32_t> &uniqueVertices)
+    {
+        auto [it, inserted] = uniqueVertices.try_emplace(vertex, static_cast<uint32_t>(vertices.size()));
+        if (inserted)
+        {
+            vertices.push_back(vertex);
+        }
+        indices.push_back(it->second);
+    }
+
+    void Model::Builder::loadCookedMesh(const std::string &path, uint32_t lod)
+    {
+        std::vector<char> storage;
+        AssetView data = AssetArchive::load(path, storage);
+        StartupReport::addBytesParsed(data.size);
+        *this = CookedMesh::read(data, lod);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,306 @@
+#include "offscreen_target.hpp"
+#include "buffer.hpp"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace YTVK
+{
+    OffscreenTarget::OffscreenTarget(Device &device, VkExtent2D extent, uint32_t framesInFlight) : device{device}, extent{extent}
+    {
+        if (framesInFlight < 1)
+        {
+            throw std::runtime_error("offscreen target needs at least one frame in flight");
+        }
+
+        frameTimelineValues.resize(framesInFlight, 0);
+        depthFormat = device.findSupportedFormat(
+            {VK_FORMAT_D32_SFLOAT, VK_FORMAT_D32_SFLOAT_S8_UINT, VK_FORMAT_D24_UNORM_S8_UINT},
+            VK_IMAGE_TILING_OPTIMAL,
+            VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT);
+
+        createRenderPass();
+        createImages();
+        createFramebuffers();
+    }
+
+    OffscreenTarget::~OffscreenTarget()
+    {
+        for (auto framebuffer : framebuffers)
+        {
+            vkDestroyFramebuffer(device.device(), framebuffer, nullptr);
+        }
+
+        for (size_t i = 0; i < colorImages.size(); ++i)
+        {
+            vkDestroyImageView(device.device(), colorImageViews[i], nullptr);
+            vkDestroyImage(device.device(), colorImages[i], nullptr);
+            device.freeMemory(colorImageMemorys[i]);
+            vkDestroyImageView(device.device(), depthImageViews[i], nullptr);
+            vkDestroyImage(device.device(), depthImages[i], nullptr);
+            device.freeMemory(depthImageMemorys[i]);
+        }
+
+        vkDestroyRenderPass(device.device(), renderPass, nullptr);
+    }
+
+    VkResult OffscreenTarget::acquireNextImage(uint32_t *imageIndex)
+    {
+        device.waitForTimelineValue(frameTimelineValues[currentFrame]);
+        *imageIndex = static_cast<uint32_t>(currentFrame);
+        return VK_SUCCESS;
+    }
+
+    VkResult OffscreenTarget::submitCommandBuffers(const VkCommandBuffer *buffers, uint32_t *imageIndex)
+    {
+        uint64_t signalValue = device.nextTimelineValue();
+        frameTimelineValues[currentFrame] = signalValue;
+
+        VkSemaphore signalSemaphore = device.timelineSemaphore();
+
+        VkTimelineSemaphoreSubmitInfo timelineInfo{};
+        timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+        timelineInfo.signalSemaphoreValueCount = 1;
+        timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+        VkSubmitInfo submitInfo{};
+        submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+        submitInfo.pNext = &timelineInfo;
+        submitInfo.commandBufferCount = 1;
+        submitInfo.pCommandBuffers = buffers;
+        submitInfo.signalSemaphoreCount = 1;
+        submitInfo.pSignalSemaphores = &signalSemaphore;
+
+        if (vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to submit offscreen command buffer");
+        }
+
+        currentFrame = (currentFrame + 1) % frameTimelineValues.size();
+        return VK_SUCCESS;
+    }
+
+    std::vector<uint8_t> OffscreenTarget::readPixels(uint32_t imageIndex)
+    {
+        // Image index and frame slot are the same thing here
+        device.waitForTimelineValue(frameTimelineValues[imageIndex]);
+
+        Buffer stagingBuffer{
+            device,
+            4,
+            extent.width * extent.height,
+            VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
+
+        VkCommandBuffer commandBuffer = device.beginSingleTimeCommands();
+
+        // The render pass already left the image in TRANSFER_SRC, only the writes need to be made visible
+        VkImageMemoryBarrier barrier{};
+        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+        barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+        barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        barrier.image = colorImages[imageIndex];
+        barrier.subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1};
+
+        vkCmdPipelineBarrier(
+            commandBuffer,
+            VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+            VK_PIPELINE_STAGE_TRANSFER_BIT,
+            0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+        VkBufferImageCopy region{};
+        region.imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
+        region.imageExtent = {extent.width, extent.height, 1};
+
+        vkCmdCopyImageToBuffer(
+            commandBuffer,
+            colorImages[imageIndex],
+            VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+            stagingBuffer.getBuffer(),
+            1,
+            &region);
+
+        device.endSingleTimeCommands(commandBuffer);
+
+        std::vector<uint8_t> pixels(stagingBuffer.getBufferSize());
+        stagingBuffer.map();
+        std::memcpy(pixels.data(), stagingBuffer.getMappedMemory(), pixels.size());
+        return pixels;
+    }
+
+    void OffscreenTarget::saveImage(uint32_t imageIndex, const std::string &path)
+    {
+        std::vector<uint8_t> pixels = readPixels(imageIndex);
+
+        std::ofstream file{path, std::ios::binary};
+        if (!file.is_open())
+        {
+            throw std::runtime_error("failed to open file: " + path);
+        }
+
+        file << "P6\n"
+             << extent.width << " " << extent.height << "\n255\n";
+        for (size_t i = 0; i < pixels.size(); i += 4)
+        {
+            file.write(reinterpret_cast<const char *>(&pixels[i]), 3);
+        }
+    }
+
+    void OffscreenTarget::createRenderPass()
+    {
+        VkAttachmentDescription colorAttachment{};
+        colorAttachment.format = COLOR_FORMAT;
+        colorAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+        colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        colorAttachment.finalLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+
+        VkAttachmentDescription depthAttachment{};
+        depthAttachment.format = depthFormat;
+        depthAttachment.samples = VK_SAMPLE_COUNT_1_BIT;
+        depthAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+        depthAttachment.storeOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+        depthAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+        depthAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        depthAttachment.finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+
+        VkAttachmentReference colorAttachmentRef{0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+        VkAttachmentReference depthAttachmentRef{1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+
+        std::array<VkSubpassDescription, 2> subpasses{};
+        subpasses[DEPTH_PREPASS_SUBPASS].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpasses[DEPTH_PREPASS_SUBPASS].pDepthStencilAttachment = &depthAttachmentRef;
+        subpasses[MAIN_SUBPASS].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+        subpasses[MAIN_SUBPASS].colorAttachmentCount = 1;
+        subpasses[MAIN_SUBPASS].pColorAttachments = &colorAttachmentRef;
+        subpasses[MAIN_SUBPASS].pDepthStencilAttachment = &depthAttachmentRef;
+
+        // Same dependencies as the swap chain pass, so pipelines built for either are interchangeable
+        std::array<VkSubpassDependency, 3> dependencies{};
+        dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[0].srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependencies[0].srcAccessMask = 0;
+        dependencies[0].dstSubpass = DEPTH_PREPASS_SUBPASS;
+        dependencies[0].dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+        dependencies[0].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+        dependencies[1].srcSubpass = VK_SUBPASS_EXTERNAL;
+        dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependencies[1].srcAccessMask = 0;
+        dependencies[1].dstSubpass = MAIN_SUBPASS;
+        dependencies[1].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+        dependencies[1].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+        // Pre-pass depth is tested (and without a pre-pass, written) by the main subpass
+        dependencies[2].srcSubpass = DEPTH_PREPASS_SUBPASS;
+        dependencies[2].srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependencies[2].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependencies[2].dstSubpass = MAIN_SUBPASS;
+        dependencies[2].dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+        dependencies[2].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+        dependencies[2].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+        std::array<VkAttachmentDescription, 2> attachments = {colorAttachment, depthAttachment};
+        VkRenderPassCreateInfo renderPassInfo{};
+        renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+        renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+        renderPassInfo.pAttachments = attachments.data();
+        renderPassInfo.subpassCount = static_cast<uint32_t>(subpasses.size());
+        renderPassInfo.pSubpasses = subpasses.data();
+        renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+        renderPassInfo.pDependencies = dependencies.data();
+
+        if (vkCreateRenderPass(device.device(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create offscreen render pass");
+        }
+    }
+
+    void OffscreenTarget::createImages()
+    {
+        size_t imageCount = frameTimelineValues.size();
+        colorImages.resize(imageCount);
+        colorImageMemorys.resize(imageCount);
+        colorImageViews.resize(imageCount);
+        depthImages.resize(imageCount);
+        depthImageMemorys.resize(imageCount);
+        depthImageViews.resize(imageCount);
+
+        auto createAttachment = [&](VkFormat format, VkImageUsageFlags usage, VkImageAspectFlags aspect, VkImage &image, VkDeviceMemory &memory, VkImageView &view)
+        {
+            VkImageCreateInfo imageInfo{};
+            imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+            imageInfo.imageType = VK_IMAGE_TYPE_2D;
+            imageInfo.extent = {extent.width, extent.height, 1};
+            imageInfo.mipLevels = 1;
+            imageInfo.arrayLayers = 1;
+            imageInfo.format = format;
+            imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+            imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+            imageInfo.usage = usage;
+            imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+            imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+            device.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, memory);
+
+            VkImageViewCreateInfo viewInfo{};
+            viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+            viewInfo.image = image;
+            viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+            viewInfo.format = format;
+            viewInfo.subresourceRange = {aspect, 0, 1, 0, 1};
+
+            if (vkCreateImageView(device.device(), &viewInfo, nullptr, &view) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to create offscreen image view");
+            }
+        };
+
+        for (size_t i = 0; i < imageCount; ++i)
+        {
+            createAttachment(
+                COLOR_FORMAT,
+                VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+                VK_IMAGE_ASPECT_COLOR_BIT,
+                colorImages[i], colorImageMemorys[i], colorImageViews[i]);
+            createAttachment(
+                depthFormat,
+                VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT,
+                VK_IMAGE_ASPECT_DEPTH_BIT,
+                depthImages[i], depthImageMemorys[i], depthImageViews[i]);
+        }
+    }
+
+    void OffscreenTarget::createFramebuffers()
+    {
+        framebuffers.resize(colorImages.size());
+        for (size_t i = 0; i < framebuffers.size(); ++i)
+        {
+            std::array<VkImageView, 2> attachments = {colorImageViews[i], depthImageViews[i]};
+
+            VkFramebufferCreateInfo framebufferInfo{};
+            framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+            framebufferInfo.renderPass = renderPass;
+            framebufferInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
+            framebufferInfo.pAttachments = attachments.data();
+            framebufferInfo.width = extent.width;
+            framebufferInfo.height = extent.height;
+            framebufferInfo.layers = 1;
+
+            if (vkCreateFramebuffer(device.device(), &framebufferInfo, nullptr, &framebuffers[i]) != VK_SUCCESS)
+            {
+                throw std::runtime_error("failed to create offscreen framebuffer");
+            }
+        }
+    }
+}
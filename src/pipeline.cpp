@@ -1,7 +1,7 @@
 #include "pipeline.hpp"
 #include "model.hpp"
+#include "startup_report.hpp"
 
-#include <fstream>
 #include <iostream>
 #include <stdexcept>
 #include <cassert>
@@ -24,26 +24,6 @@ namespace YTVK
         vkDestroyPipeline(device.device(), graphicsPipeline, nullptr);
     }
 
-    std::vector<char> Pipeline::readFile(const std::string &filePath)
-    {
-
-        std::ifstream file(filePath, std::ios::ate | std::ios::binary);
-
-        if (!file.is_open())
-        {
-            throw std::runtime_error("failed to open file" + filePath);
-        }
-
-        size_t fileSize = static_cast<size_t>(file.tellg());
-        std::vector<char> buffer(fileSize);
-
-        file.seekg(0);
-        file.read(buffer.data(), fileSize);
-
-        file.close();
-        return buffer;
-    };
-
     void Pipeline::bind(VkCommandBuffer commandBuffer)
     {
         vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, graphicsPipeline);
@@ -51,8 +31,9 @@ namespace YTVK
 
     void Pipeline::createGraphicsPipeline(const std::string &vertFilePath, const std::string &fragFilePath, const PipelineConfigInfo &configInfo)
     {
-        auto vertCode = readFile(vertFilePath);
-        auto fragCode = readFile(fragFilePath);
+        std::vector<char> vertStorage;
+        std::vector<char> fragStorage;
+        AssetView vertCode = AssetArchive::load(vertFilePath, vertStorage);
 
         assert(
             configInfo.pipelineLayout != VK_NULL_HANDLE &&
@@ -63,7 +44,11 @@ namespace YTVK
             "Cannot create graphics pipeline: no render pass provided in configInfo");
 
         createShaderModule(vertCode, &vertexShader);
-        createShaderModule(fragCode, &fragmentShader);
+        fragmentShader = VK_NULL_HANDLE;
+        if (!fragFilePath.empty())
+        {
+            createShaderModule(AssetArchive::load(fragFilePath, fragStorage), &fragmentShader);
+        }
 
         VkPipelineShaderStageCreateInfo shaderStages[2];
 
@@ -86,8 +71,8 @@ namespace YTVK
         shaderStages[1].pSpecializationInfo = nullptr;
 
         // Needed to read vertices from CPU
-        auto bindingDescriptions = Model::Vertex::getBindDescriptions();
-        auto attributeDescriptions = Model::Vertex::getAtributeDescriptions();
+        const auto &bindingDescriptions = configInfo.bindingDescriptions;
+        const auto &attributeDescriptions = configInfo.attributeDescriptions;
         // Configure Vertex Input Stage of Pipeline
         VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
         vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -98,7 +83,7 @@ namespace YTVK
 
         VkGraphicsPipelineCreateInfo pipelineInfo{};
         pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-        pipelineInfo.stageCount = 2;
+        pipelineInfo.stageCount = fragmentShader != VK_NULL_HANDLE ? 2 : 1;
         pipelineInfo.pStages = shaderStages;
         pipelineInfo.pVertexInputState = &vertexInputInfo;
         pipelineInfo.pInputAssemblyState = &configInfo.inputAssemblyInfo;
@@ -120,14 +105,15 @@ namespace YTVK
         {
             throw std::runtime_error("failed to create graphics pipeline");
         }
+        StartupReport::addPipelineCompiled();
     }
 
-    void Pipeline::createShaderModule(const std::vector<char> &code, VkShaderModule *shaderModule)
+    void Pipeline::createShaderModule(AssetView code, VkShaderModule *shaderModule)
     {
         VkShaderModuleCreateInfo createInfo{};
         createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        createInfo.codeSize = code.size();
-        createInfo.pCode = reinterpret_cast<const uint32_t *>(code.data());
+        createInfo.codeSize = code.size;
+        createInfo.pCode = reinterpret_cast<const uint32_t *>(code.data);
 
         if (vkCreateShaderModule(device.device(), &createInfo, nullptr, shaderModule) != VK_SUCCESS)
         {
@@ -135,6 +121,53 @@ namespace YTVK
         }
     }
 
+    ComputePipeline::ComputePipeline(Device &device, VkPipelineLayout pipelineLayout, const std::string &compFilePath) : device(device)
+    {
+        assert(pipelineLayout != VK_NULL_HANDLE && "Cannot create compute pipeline: no layout provided");
+
+        std::vector<char> storage;
+        AssetView code = AssetArchive::load(compFilePath, storage);
+
+        VkShaderModuleCreateInfo moduleInfo{};
+        moduleInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        moduleInfo.codeSize = code.size;
+        moduleInfo.pCode = reinterpret_cast<const uint32_t *>(code.data);
+
+        // Only needed while the pipeline is created
+        VkShaderModule computeShader;
+        if (vkCreateShaderModule(device.device(), &moduleInfo, nullptr, &computeShader) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create shader module");
+        }
+
+        VkComputePipelineCreateInfo pipelineInfo{};
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = computeShader;
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.layout = pipelineLayout;
+        pipelineInfo.basePipelineIndex = -1;
+
+        VkResult result = vkCreateComputePipelines(device.device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &computePipeline);
+        vkDestroyShaderModule(device.device(), computeShader, nullptr);
+        if (result != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create compute pipeline");
+        }
+        StartupReport::addPipelineCompiled();
+    }
+
+    ComputePipeline::~ComputePipeline()
+    {
+        vkDestroyPipeline(device.device(), computePipeline, nullptr);
+    }
+
+    void ComputePipeline::bind(VkCommandBuffer commandBuffer)
+    {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, computePipeline);
+    }
+
     void Pipeline::defaultPipelineConfigInfo(PipelineConfigInfo &configInfo)
     {
         configInfo.inputAssemblyInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
@@ -204,5 +237,8 @@ namespace YTVK
         configInfo.dynamicStateInfo.pDynamicStates = configInfo.dynamicStateEnables.data();
         configInfo.dynamicStateInfo.dynamicStateCount = static_cast<uint32_t>(configInfo.dynamicStateEnables.size());
         configInfo.dynamicStateInfo.flags = 0;
+
+        configInfo.bindingDescriptions = Model::Vertex::getBindDescriptions();
+        configInfo.attributeDescriptions = Model::Vertex::getAtributeDescriptions();
     }
 }
\ No newline at end of file
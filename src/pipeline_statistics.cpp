@@ -0,0 +1,147 @@
+#include "pipeline_statistics.hpp"
+
+#include <cassert>
+#include <stdexcept>
+
+namespace YTVK
+{
+    namespace
+    {
+        // Results come back in bit order, which is also the order of Result's counters
+        constexpr VkQueryPipelineStatisticFlags STATISTICS =
+            VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+            VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+    }
+
+    PipelineStatistics::Scope::Scope(PipelineStatistics &statistics, VkCommandBuffer commandBuffer, const char *name)
+        : statistics{statistics}, commandBuffer{commandBuffer}, index{statistics.beginScope(commandBuffer, name)}
+    {
+    }
+
+    PipelineStatistics::Scope::~Scope()
+    {
+        statistics.endScope(commandBuffer, index);
+    }
+
+    PipelineStatistics::PipelineStatistics(Device &device, uint32_t framesInFlight, bool enabled) : device{device}, frames(framesInFlight)
+    {
+        if (!enabled || !device.supportsPipelineStatistics())
+        {
+            return;
+        }
+
+        VkQueryPoolCreateInfo queryPoolInfo{};
+        queryPoolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+        queryPoolInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+        queryPoolInfo.queryCount = framesInFlight * MAX_SCOPES_PER_FRAME;
+        queryPoolInfo.pipelineStatistics = STATISTICS;
+
+        if (vkCreateQueryPool(device.device(), &queryPoolInfo, nullptr, &queryPool) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create pipeline statistics query pool");
+        }
+
+        for (auto &frame : frames)
+        {
+            frame.names.reserve(MAX_SCOPES_PER_FRAME);
+        }
+        results.reserve(MAX_SCOPES_PER_FRAME);
+    }
+
+    PipelineStatistics::~PipelineStatistics()
+    {
+        if (queryPool != VK_NULL_HANDLE)
+        {
+            vkDestroyQueryPool(device.device(), queryPool, nullptr);
+        }
+    }
+
+    void PipelineStatistics::beginFrame(VkCommandBuffer commandBuffer, uint32_t frameIndex)
+    {
+        currentFrameIndex = frameIndex;
+        frameNumber++;
+
+        if (!isEnabled())
+        {
+            return;
+        }
+
+        FrameQueries &frame = frames[frameIndex];
+        if (frame.submitted && device.isTimelineValueComplete(frame.timelineValue))
+        {
+            collect(frame, frameIndex);
+        }
+
+        frame.names.clear();
+        frame.submitted = false;
+        frame.frameNumber = frameNumber;
+        vkCmdResetQueryPool(commandBuffer, queryPool, firstQuery(frameIndex), MAX_SCOPES_PER_FRAME);
+    }
+
+    void PipelineStatistics::endFrame(uint64_t timelineValue)
+    {
+        FrameQueries &frame = frames[currentFrameIndex];
+        frame.timelineValue = timelineValue;
+        frame.submitted = !frame.names.empty();
+    }
+
+    uint32_t PipelineStatistics::beginScope(VkCommandBuffer commandBuffer, const char *name)
+    {
+        FrameQueries &frame = frames[currentFrameIndex];
+        if (!isEnabled() || frame.names.size() >= MAX_SCOPES_PER_FRAME)
+        {
+            return INVALID_SCOPE;
+        }
+        assert(!scopeActive && "Pipeline statistics scopes cannot be nested");
+
+        uint32_t index = static_cast<uint32_t>(frame.names.size());
+        frame.names.push_back(name);
+        scopeActive = true;
+
+        vkCmdBeginQuery(commandBuffer, queryPool, firstQuery(currentFrameIndex) + index, 0);
+        return index;
+    }
+
+    void PipelineStatistics::endScope(VkCommandBuffer commandBuffer, uint32_t index)
+    {
+        if (index == INVALID_SCOPE)
+        {
+            return;
+        }
+
+        scopeActive = false;
+        vkCmdEndQuery(commandBuffer, queryPool, firstQuery(currentFrameIndex) + index);
+    }
+
+    void PipelineStatistics::collect(FrameQueries &frame, uint32_t frameIndex)
+    {
+        uint32_t queryCount = static_cast<uint32_t>(frame.names.size());
+
+        // Counters plus availability word per query
+        constexpr uint32_t stride = COUNTER_COUNT + 1;
+        auto &data = queryData;
+        VkResult result = vkGetQueryPoolResults(
+            device.device(),
+            queryPool,
+            firstQuery(frameIndex),
+            queryCount,
+            queryCount * stride * sizeof(uint64_t),
+            data.data(),
+            stride * sizeof(uint64_t),
+            VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+        if (result != VK_SUCCESS)
+        {
+            return;
+        }
+
+        results.clear();
+        for (uint32_t i = 0; i < queryCount; ++i)
+        {
+            const uint64_t *counters = &data[i * stride];
+            results.push_back({frame.names[i], counters[0], counters[1], counters[2], counters[3]});
+        }
+        resultsFrameNumber = frame.frameNumber;
+    }
+}
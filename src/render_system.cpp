@@ -1,22 +1,71 @@
 #include "render_system.hpp"
+#include "render_target.hpp"
+#include "trace.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <stdexcept>
 
 namespace YTVK
 {
+    namespace
+    {
+        // GpuProfiler scope names, also how chooseDepthPrepass tells the variants apart
+        const char *const PREPASS_SCOPE = "RenderSystem depth prepass";
+        const char *const MAIN_SCOPE = "RenderSystem";
+
+        // Where simple_textured.frag samples the object's texture when there is no BindlessSet
+        const uint32_t TEXTURE_SET = 1;
+        const uint32_t TEXTURE_BINDING = 0;
+
+        // Planes of a zero-to-one depth clip space, normalized so distances are in world units
+        std::array<glm::vec4, 6> frustumPlanes(const glm::mat4 &viewProjection)
+        {
+            glm::vec4 row0{viewProjection[0][0], viewProjection[1][0], viewProjection[2][0], viewProjection[3][0]};
+            glm::vec4 row1{viewProjection[0][1], viewProjection[1][1], viewProjection[2][1], viewProjection[3][1]};
+            glm::vec4 row2{viewProjection[0][2], viewProjection[1][2], viewProjection[2][2], viewProjection[3][2]};
+            glm::vec4 row3{viewProjection[0][3], viewProjection[1][3], viewProjection[2][3], viewProjection[3][3]};
+
+            std::array<glm::vec4, 6> planes{row3 + row0, row3 - row0, row3 + row1, row3 - row1, row2, row3 - row2};
+            for (auto &plane : planes)
+            {
+                plane /= glm::length(glm::vec3{plane});
+            }
+            return planes;
+        }
+
+        bool outsideFrustum(const std::array<glm::vec4, 6> &planes, GameObject &object)
+        {
+            glm::vec3 scale = glm::abs(object.transform.scale);
+            glm::vec3 center{object.transform.mat4() * glm::vec4{object.model->getBoundsCenter(), 1.0f}};
+            float radius = object.model->getBoundsRadius() * std::max({scale.x, scale.y, scale.z});
+            for (const auto &plane : planes)
+            {
+                if (glm::dot(glm::vec3{plane}, center) + plane.w < -radius)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+    }
 
+    // Kept at the 128 bytes every device guarantees for push constants
     struct SimplePushConstantData
     {
         glm::mat4 modelMatrix{1.0f};
+        // The shaders only use the upper 3x3; [3].x carries the bindless texture index
         glm::mat4 normalMatrix{1.0f};
     };
 
-    RenderSystem::RenderSystem(Device &device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout) : device{device}
+    RenderSystem::RenderSystem(Device &device, VkRenderPass renderPass, VkDescriptorSetLayout globalSetLayout, BindlessSet *bindless, DepthPrepassMode depthPrepassMode)
+        : device{device}, bindless{bindless}, depthPrepassMode{depthPrepassMode}
     {
         createPipelineLayout(globalSetLayout);
         createPipeline(renderPass);
@@ -36,6 +85,18 @@ namespace YTVK
         pushConstantRange.size = sizeof(SimplePushConstantData);
 
         std::vector<VkDescriptorSetLayout> descriptorSetLayouts{globalSetLayout};
+        if (bindless != nullptr)
+        {
+            descriptorSetLayouts.push_back(bindless->getLayout());
+        }
+        else
+        {
+            textureSetLayout = DescriptorSetLayout::Builder(device)
+            .addBinding(TEXTURE_BINDING, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_SHADER_STAGE_FRAGMENT_BIT)
+            .setPushDescriptor()
+            .build();
+            descriptorSetLayouts.push_back(textureSetLayout->getDescriptorSetLayout());
+        }
 
         VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
         pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
@@ -62,31 +123,229 @@ namespace YTVK
         Pipeline::defaultPipelineConfigInfo(pipelineConfig);
         pipelineConfig.renderPass = renderPass;
         pipelineConfig.pipelineLayout = pipelineLayout;
-        pipeline = std::make_unique<Pipeline>(
-            device,
-            pipelineConfig,
-            "shaders/simple.vert.spv",
-            "shaders/simple.frag.spv");
+        pipelineConfig.subpass = RenderTarget::MAIN_SUBPASS;
+        const char *fragFilePath = bindless != nullptr ? "shaders/simple_bindless.frag.spv" : "shaders/simple.frag.spv";
+        pipeline = std::make_unique<Pipeline>(device, pipelineConfig, "shaders/simple.vert.spv", fragFilePath);
+        if (bindless == nullptr)
+        {
+            texturedPipeline = std::make_unique<Pipeline>(device, pipelineConfig, "shaders/simple.vert.spv", "shaders/simple_textured.frag.spv");
+        }
+
+        if (depthPrepassMode == DepthPrepassMode::Off)
+        {
+            return;
+        }
+
+        pipelineConfig.depthStencilInfo.depthCompareOp = VK_COMPARE_OP_EQUAL;
+        pipelineConfig.depthStencilInfo.depthWriteEnable = VK_FALSE;
+        depthEqualPipeline = std::make_unique<Pipeline>(device, pipelineConfig, "shaders/simple.vert.spv", fragFilePath);
+        if (bindless == nullptr)
+        {
+            texturedDepthEqualPipeline = std::make_unique<Pipeline>(device, pipelineConfig, "shaders/simple.vert.spv", "shaders/simple_textured.frag.spv");
+        }
+
+        PipelineConfigInfo prepassConfig = {};
+        Pipeline::defaultPipelineConfigInfo(prepassConfig);
+        prepassConfig.renderPass = renderPass;
+        prepassConfig.pipelineLayout = pipelineLayout;
+        prepassConfig.subpass = RenderTarget::DEPTH_PREPASS_SUBPASS;
+        prepassConfig.colorBlendInfo.attachmentCount = 0;
+        prepassConfig.bindingDescriptions = Model::Vertex::getPositionBindDescriptions();
+        prepassConfig.attributeDescriptions = Model::Vertex::getPositionAttributeDescriptions();
+        depthPrepassPipeline = std::make_unique<Pipeline>(device, prepassConfig, "shaders/depth_prepass.vert.spv", "");
     }
 
-    void RenderSystem::renderGameObjects(FrameInfo &frameInfo, std::vector<GameObject> &gameObjects)
+    bool RenderSystem::chooseDepthPrepass(const GpuProfiler &profiler)
     {
-        pipeline->bind(frameInfo.commandBuffer);
+        if (depthPrepassMode != DepthPrepassMode::Auto)
+        {
+            return depthPrepassMode == DepthPrepassMode::On;
+        }
+        // Nothing to measure with; every pixel is lit per fragment, so assume shading dominates
+        if (!profiler.isEnabled())
+        {
+            return true;
+        }
+
+        // Results trail by a few frames, so they are attributed by whether the pre-pass scope is in them
+        if (profiler.getResultsFrameNumber() != trial.lastResultsFrame)
+        {
+            trial.lastResultsFrame = profiler.getResultsFrameNumber();
+            double milliseconds = 0.0;
+            bool withPrepass = false;
+            for (const auto &result : profiler.getResults())
+            {
+                bool isPrepass = std::strcmp(result.name, PREPASS_SCOPE) == 0;
+                if (isPrepass || std::strcmp(result.name, MAIN_SCOPE) == 0)
+                {
+                    milliseconds += result.milliseconds;
+                    withPrepass = withPrepass || isPrepass;
+                }
+            }
+            if (withPrepass)
+            {
+                trial.withPrepassMs += milliseconds;
+                trial.withPrepassFrames++;
+            }
+            else
+            {
+                trial.withoutPrepassMs += milliseconds;
+                trial.withoutPrepassFrames++;
+            }
+        }
+
+        if (trial.decided)
+        {
+            if (++trial.framesSinceDecision < PREPASS_REEVALUATE_FRAMES)
+            {
+                return trial.useDepthPrepass;
+            }
+            // The scene or view may have changed enough to flip the decision
+            bool useDepthPrepass = trial.useDepthPrepass;
+            trial = PrepassTrial{};
+            trial.useDepthPrepass = useDepthPrepass;
+        }
+
+        if (trial.withoutPrepassFrames < PREPASS_TRIAL_FRAMES)
+        {
+            return false;
+        }
+        if (trial.withPrepassFrames < PREPASS_TRIAL_FRAMES)
+        {
+            return true;
+        }
 
+        trial.decided = true;
+        trial.useDepthPrepass = trial.withPrepassMs / trial.withPrepassFrames < trial.withoutPrepassMs / trial.withoutPrepassFrames;
+        return trial.useDepthPrepass;
+    }
+
+    void RenderSystem::bindDescriptorSets(FrameInfo &frameInfo)
+    {
+        // The only descriptor bind of the pass with a BindlessSet; everything per object goes through
+        // push constants. Without one, textured draws push their own set 1.
+        VkDescriptorSet descriptorSets[] = {
+            frameInfo.globalDescriptorSet,
+            bindless != nullptr ? bindless->getDescriptorSet() : VK_NULL_HANDLE};
         vkCmdBindDescriptorSets(
             frameInfo.commandBuffer,
             VK_PIPELINE_BIND_POINT_GRAPHICS,
             pipelineLayout,
-            0, 1,
-            &frameInfo.globalDescriptorSet,
+            0, bindless != nullptr ? 2 : 1,
+            descriptorSets,
             0,
             nullptr);
+    }
+
+    void RenderSystem::sortDraws(FrameInfo &frameInfo, std::vector<GameObject> &gameObjects)
+    {
+        YTVK_TRACE_SCOPE("RenderSystem::sortDraws");
+
+        // Nothing is translucent yet. With bindless textures every object goes through one pipeline
+        // per pass and changing material is only a push constant; model changes rebind buffers and
+        // are the state worth grouping by. Without them textured objects need their own pipeline and
+        // a pushed texture set, so they are grouped after the untextured ones.
+        const glm::mat4 &view = frameInfo.camera.getView();
+        auto planes = frustumPlanes(frameInfo.camera.getProjection() * view);
+        drawList.clear();
+        for (uint32_t i = 0; i < gameObjects.size(); ++i)
+        {
+            auto &object = gameObjects[i];
+            if (outsideFrustum(planes, object))
+            {
+                continue;
+            }
+            float viewDepth = (view * glm::vec4{object.transform.translation, 1.0f}).z;
+            uint32_t pipelineIndex = isPushTextured(object) ? 1 : 0;
+            drawList.add(DrawList::opaqueKey(pipelineIndex, object.model->getSortId(), object.textureIndex + 1, viewDepth), i);
+        }
+        drawList.sort();
+    }
+
+    void RenderSystem::renderDepthPrepass(FrameInfo &frameInfo, std::vector<GameObject> &gameObjects)
+    {
+        prepassThisFrame = chooseDepthPrepass(frameInfo.profiler);
+        if (!prepassThisFrame)
+        {
+            return;
+        }
+
+        YTVK_TRACE_SCOPE("RenderSystem::renderDepthPrepass");
+        GpuProfiler::Scope profileScope{frameInfo.profiler, frameInfo.commandBuffer, PREPASS_SCOPE};
+        PipelineStatistics::Scope statisticsScope{frameInfo.pipelineStatistics, frameInfo.commandBuffer, "RenderSystem depth prepass"};
+
+        depthPrepassPipeline->bind(frameInfo.commandBuffer);
+        bindDescriptorSets(frameInfo);
+
+        Model *boundModel = nullptr;
+        for (const auto &draw : drawList.getDraws())
+        {
+            auto &object = gameObjects[draw.objectIndex];
+            SimplePushConstantData push{};
+            push.modelMatrix = object.transform.mat4();
+
+            vkCmdPushConstants(
+                frameInfo.commandBuffer,
+                pipelineLayout,
+                VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+                0,
+                sizeof(SimplePushConstantData),
+                &push);
+            if (object.model.get() != boundModel)
+            {
+                boundModel = object.model.get();
+                boundModel->bindPositions(frameInfo.commandBuffer);
+            }
+            object.model->draw(frameInfo.commandBuffer);
+        }
+    }
+
+    void RenderSystem::renderGameObjects(FrameInfo &frameInfo, std::vector<GameObject> &gameObjects)
+    {
+        YTVK_TRACE_SCOPE("RenderSystem::renderGameObjects");
+        GpuProfiler::Scope profileScope{frameInfo.profiler, frameInfo.commandBuffer, MAIN_SCOPE};
+        PipelineStatistics::Scope statisticsScope{frameInfo.pipelineStatistics, frameInfo.commandBuffer, "RenderSystem"};
+
+        Pipeline *untexturedPipeline = (prepassThisFrame ? depthEqualPipeline : pipeline).get();
+        Pipeline *pushTexturedPipeline = (prepassThisFrame ? texturedDepthEqualPipeline : texturedPipeline).get();
+        untexturedPipeline->bind(frameInfo.commandBuffer);
+        // Bound again since the pre-pass may have been skipped this frame
+        bindDescriptorSets(frameInfo);
 
-        for (auto &object : gameObjects)
+        Pipeline *boundPipeline = untexturedPipeline;
+        Model *boundModel = nullptr;
+        uint32_t boundTexture = ~0u;
+        for (const auto &draw : drawList.getDraws())
         {
+            auto &object = gameObjects[draw.objectIndex];
+            if (isPushTextured(object))
+            {
+                if (boundPipeline != pushTexturedPipeline)
+                {
+                    boundPipeline = pushTexturedPipeline;
+                    boundPipeline->bind(frameInfo.commandBuffer);
+                }
+                if (object.textureIndex != boundTexture)
+                {
+                    boundTexture = object.textureIndex;
+                    bool pushed = PushDescriptorWriter(*textureSetLayout, frameInfo.descriptorAllocator)
+                                      .writeImage(TEXTURE_BINDING, &textures[boundTexture])
+                                      .push(frameInfo.commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, TEXTURE_SET);
+                    if (!pushed)
+                    {
+                        throw std::runtime_error("failed to allocate object texture descriptor set");
+                    }
+                }
+            }
+            else if (boundPipeline != untexturedPipeline)
+            {
+                boundPipeline = untexturedPipeline;
+                boundPipeline->bind(frameInfo.commandBuffer);
+            }
             SimplePushConstantData push{};
             push.modelMatrix = object.transform.mat4();
             push.normalMatrix = object.transform.normalMatrix();
+            push.normalMatrix[3][0] = glm::uintBitsToFloat(object.textureIndex);
 
             vkCmdPushConstants(
                 frameInfo.commandBuffer,
@@ -95,7 +354,11 @@ namespace YTVK
                 0,
                 sizeof(SimplePushConstantData),
                 &push);
-            object.model->bind(frameInfo.commandBuffer);
+            if (object.model.get() != boundModel)
+            {
+                boundModel = object.model.get();
+                boundModel->bind(frameInfo.commandBuffer);
+            }
             object.model->draw(frameInfo.commandBuffer);
         }
     }
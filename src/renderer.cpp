@@ -1,13 +1,31 @@
 #include "renderer.hpp"
+#include "trace.hpp"
+
 #include <stdexcept>
 #include <cassert>
 
 namespace YTVK
 {
-    Renderer::Renderer(Window &window, Device &device) : window{window}, device{device}, isFrameStarted{false}, currentFrameIndex{0}
+    Renderer::Renderer(Window &window, Device &device, const SwapChainSettings &settings) : window{&window}, device{device}, settings{settings}, isFrameStarted{false}, currentFrameIndex{0}
     {
         recreateSwapchain();
         createCommandBuffers();
+        profiler = std::make_unique<GpuProfiler>(device, settings.framesInFlight);
+        pipelineStatistics = std::make_unique<PipelineStatistics>(device, settings.framesInFlight, false);
+    }
+
+    Renderer::Renderer(Device &device, VkExtent2D extent, const SwapChainSettings &settings) : window{nullptr}, device{device}, settings{settings}, isFrameStarted{false}, currentFrameIndex{0}
+    {
+        if (settings.framesInFlight < 1 || settings.framesInFlight > SwapChain::MAX_FRAMES_IN_FLIGHT)
+        {
+            throw std::runtime_error("frames in flight must be between 1 and " + std::to_string(SwapChain::MAX_FRAMES_IN_FLIGHT));
+        }
+
+        offscreenTarget = std::make_unique<OffscreenTarget>(device, extent, settings.framesInFlight);
+        target = offscreenTarget.get();
+        createCommandBuffers();
+        profiler = std::make_unique<GpuProfiler>(device, settings.framesInFlight);
+        pipelineStatistics = std::make_unique<PipelineStatistics>(device, settings.framesInFlight, false);
     }
 
     Renderer::~Renderer()
@@ -17,7 +35,7 @@ namespace YTVK
 
     void Renderer::createCommandBuffers()
     {
-        commandBuffers.resize(SwapChain::MAX_FRAMES_IN_FLIGHT);
+        commandBuffers.resize(settings.framesInFlight);
 
         VkCommandBufferAllocateInfo allocateInfo{};
         allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -37,40 +55,64 @@ namespace YTVK
         commandBuffers.clear();
     }
 
+    void Renderer::setPipelineStatisticsEnabled(bool enabled)
+    {
+        assert(!isFrameStarted && "Cannot toggle pipeline statistics while a frame is in progress");
+        if (enabled == pipelineStatistics->isEnabled())
+        {
+            return;
+        }
+
+        // Earlier frames may still be writing into the old query pool
+        device.deletionQueue().push(
+            device.lastTimelineValue(),
+            [retired = std::shared_ptr<PipelineStatistics>(std::move(pipelineStatistics))]() mutable
+            { retired.reset(); });
+        pipelineStatistics = std::make_unique<PipelineStatistics>(device, settings.framesInFlight, enabled);
+    }
+
     void Renderer::recreateSwapchain()
     {
-        auto extent = window.getExtent();
+        auto extent = window->getExtent();
         while (extent.width == 0 || extent.height == 0)
         {
-            extent = window.getExtent();
+            extent = window->getExtent();
             glfwWaitEvents();
         }
 
-        vkDeviceWaitIdle(device.device());
-
         if (swapchain == nullptr)
         {
-            swapchain = std::make_unique<SwapChain>(device, extent);
+            swapchain = std::make_unique<SwapChain>(device, extent, settings);
         }
         else
         {
+            // No device drain: the old swap chain stays alive until releaseRetiredSwapChains knows
+            // its presents are done
             std::shared_ptr<SwapChain> oldSwapChain = std::move(swapchain);
-            swapchain = std::make_unique<SwapChain>(device, extent, oldSwapChain);
+            swapchain = std::make_unique<SwapChain>(device, extent, settings, oldSwapChain);
 
             if (!oldSwapChain->compareSwapFormats(*swapchain.get()))
             {
                 throw std::runtime_error("Swap chain image or depth format has changed");
             }
+
+            // Counted from the new chain's first present (the next endFrame)
+            retiredSwapChains.push_back({std::move(oldSwapChain), settings.framesInFlight + 2});
         }
 
-        // TODO: something
+        target = swapchain.get();
     }
 
     VkCommandBuffer Renderer::beginFrame()
     {
+        YTVK_TRACE_SCOPE("Renderer::beginFrame");
         assert(!isFrameStarted && "Cannot start frame while frame is already in progress");
 
-        auto result = swapchain->acquireNextImage(&currentImageIndex);
+        acquireStart = std::chrono::high_resolution_clock::now();
+        device.deletionQueue().collect(device.completedTimelineValue());
+
+        auto result = target->acquireNextImage(&currentImageIndex);
+        frameStats.cpuWaitMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - acquireStart).count();
 
         if (result == VK_ERROR_OUT_OF_DATE_KHR)
         {
@@ -95,24 +137,48 @@ namespace YTVK
             throw std::runtime_error("failed to begin recording command buffer");
         }
 
+        profiler->beginFrame(commandBuffer, currentFrameIndex);
+        frameStats.gpuTimeMs = -1.0f;
+        if (!profiler->getResults().empty() && profiler->getResultsFrameNumber() != lastProfiledFrame)
+        {
+            // The first scope is always the whole frame
+            frameStats.gpuTimeMs = profiler->getResults().front().milliseconds;
+            // Both count frames from 1, so this matches that frame's FrameStats::frameNumber
+            frameStats.gpuFrameNumber = profiler->getResultsFrameNumber();
+            lastProfiledFrame = profiler->getResultsFrameNumber();
+        }
+        pipelineStatistics->beginFrame(commandBuffer, currentFrameIndex);
+        frameScope = profiler->beginScope(commandBuffer, "frame");
+
         return commandBuffer;
     }
 
     void Renderer::endFrame()
     {
+        YTVK_TRACE_SCOPE("Renderer::endFrame");
         assert(isFrameStarted && "Cannot end frame unless frame is in progress");
 
         auto commandBuffer = getCurrentCommandBuffer();
 
+        profiler->endScope(commandBuffer, frameScope);
+
         if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS)
         {
             throw std::runtime_error("failed to record command buffer");
         }
 
-        auto result = swapchain->submitCommandBuffers(&commandBuffer, &currentImageIndex);
-        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || window.wasWindowResized())
+        auto result = target->submitCommandBuffers(&commandBuffer, &currentImageIndex);
+        lastFrameTimelineValue = target->getFrameTimelineValue(currentFrameIndex);
+        device.deletionQueue().seal(lastFrameTimelineValue);
+        profiler->endFrame(lastFrameTimelineValue);
+        pipelineStatistics->endFrame(lastFrameTimelineValue);
+        releaseRetiredSwapChains();
+        frameStats.acquireToPresentMs = std::chrono::duration<float, std::milli>(std::chrono::high_resolution_clock::now() - acquireStart).count();
+        frameStats.frameNumber++;
+
+        if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || (window != nullptr && window->wasWindowResized()))
         {
-            window.resetWindowResized();
+            window->resetWindowResized();
             recreateSwapchain();
         }
 
@@ -122,7 +188,32 @@ namespace YTVK
         }
 
         isFrameStarted = false;
-        currentFrameIndex = (currentFrameIndex + 1) % SwapChain::MAX_FRAMES_IN_FLIGHT;
+        currentFrameIndex = (currentFrameIndex + 1) % settings.framesInFlight;
+    }
+
+    void Renderer::releaseRetiredSwapChains()
+    {
+        // The timeline only covers rendering: a present queued before the resize may still be waiting
+        // on the old chain's semaphores or holding one of its images
+        for (auto retired = retiredSwapChains.begin(); retired != retiredSwapChains.end();)
+        {
+            if (device.supportsPresentFences() ? !retired->swapChain->presentsComplete() : --retired->framesUntilRelease > 0)
+            {
+                ++retired;
+                continue;
+            }
+
+            // Without present fences, assume the presents are done once the frame framesInFlight + 1
+            // after the new chain's first present has finished rendering
+            if (!device.supportsPresentFences())
+            {
+                device.deletionQueue().push(
+                    lastFrameTimelineValue,
+                    [swapChain = std::move(retired->swapChain)]() mutable
+                    { swapChain.reset(); });
+            }
+            retired = retiredSwapChains.erase(retired);
+        }
     }
 
     bool Renderer::isFrameInProgress() const
@@ -144,7 +235,12 @@ namespace YTVK
 
     float Renderer::getAspectRation() const
     {
-        return swapchain->extentAspectRatio();
+        return target->extentAspectRatio();
+    }
+
+    VkExtent2D Renderer::getExtent() const
+    {
+        return target->getExtent();
     }
 
     void Renderer::beginSwapChainRenderPass(VkCommandBuffer commandBuffer)
@@ -154,11 +250,11 @@ namespace YTVK
 
         VkRenderPassBeginInfo renderPassInfo{};
         renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        renderPassInfo.renderPass = swapchain->getRenderPass();
-        renderPassInfo.framebuffer = swapchain->getFrameBuffer(currentImageIndex);
+        renderPassInfo.renderPass = target->getRenderPass();
+        renderPassInfo.framebuffer = target->getFrameBuffer(currentImageIndex);
 
         renderPassInfo.renderArea.offset = {0, 0};
-        renderPassInfo.renderArea.extent = swapchain->getSwapChainExtent();
+        renderPassInfo.renderArea.extent = target->getExtent();
 
         std::array<VkClearValue, 2> clearValues{};
         clearValues[0].color = {0.01f, 0.01f, 0.01f, 1.0f};
@@ -167,31 +263,50 @@ namespace YTVK
         renderPassInfo.clearValueCount = static_cast<uint32_t>(clearValues.size());
         renderPassInfo.pClearValues = clearValues.data();
 
+        renderPassScope = profiler->beginScope(commandBuffer, "render pass");
         vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
 
         VkViewport viewport{};
         viewport.x = 0.0f;
         viewport.y = 0.0f;
-        viewport.width = static_cast<float>(swapchain->getSwapChainExtent().width);
-        viewport.height = static_cast<float>(swapchain->getSwapChainExtent().height);
+        viewport.width = static_cast<float>(target->getExtent().width);
+        viewport.height = static_cast<float>(target->getExtent().height);
         viewport.minDepth = 0.0f;
         viewport.maxDepth = 1.0f;
 
-        VkRect2D scissor{{0, 0}, swapchain->getSwapChainExtent()};
+        VkRect2D scissor{{0, 0}, target->getExtent()};
 
         vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
         vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
     }
 
+    void Renderer::beginMainSubpass(VkCommandBuffer commandBuffer)
+    {
+        assert(isFrameStarted && "Cannot begin main subpass if frame is not in progress");
+        assert(commandBuffer == getCurrentCommandBuffer() && "Cannot begin subpass on a different frame");
+        vkCmdNextSubpass(commandBuffer, VK_SUBPASS_CONTENTS_INLINE);
+    }
+
     void Renderer::endSwapChainRenderPass(VkCommandBuffer commandBuffer)
     {
         assert(isFrameStarted && "Cannot end swapchain render pass if frame is not in progress");
         assert(commandBuffer == getCurrentCommandBuffer() && "Cannot end render pass on a different frame");
         vkCmdEndRenderPass(commandBuffer);
+        profiler->endScope(commandBuffer, renderPassScope);
     }
 
     VkRenderPass Renderer::getSwapChainRenderPass() const
     {
-        return swapchain->getRenderPass();
+        return target->getRenderPass();
+    }
+
+    void Renderer::saveLastFrame(const std::string &path)
+    {
+        assert(!isFrameStarted && "Cannot save a frame while it is being recorded");
+        if (offscreenTarget == nullptr)
+        {
+            throw std::runtime_error("frame capture is only supported by the headless renderer");
+        }
+        offscreenTarget->saveImage(currentImageIndex, path);
     }
 }
\ No newline at end of file
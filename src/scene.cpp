@@ -0,0 +1,184 @@
+#include "scene.hpp"
+#include "scene_generator.hpp"
+#include "asset_archive.hpp"
+#include "startup_report.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace YTVK
+{
+    namespace
+    {
+        glm::vec3 readVec3(std::istringstream &line)
+        {
+            glm::vec3 value{};
+            line >> value.x >> value.y >> value.z;
+            return value;
+        }
+
+        glm::vec3 catmullRom(const glm::vec3 &p0, const glm::vec3 &p1, const glm::vec3 &p2, const glm::vec3 &p3, float t)
+        {
+            float t2 = t * t;
+            float t3 = t2 * t;
+            return 0.5f * ((2.0f * p1) +
+                           (p2 - p0) * t +
+                           (2.0f * p0 - 5.0f * p1 + 4.0f * p2 - p3) * t2 +
+                           (3.0f * p1 - p0 - 3.0f * p2 + p3) * t3);
+        }
+    }
+
+    SceneDescription SceneDescription::load(const std::string &path, uint32_t objectCount)
+    {
+        std::vector<char> storage;
+        AssetView data = AssetArchive::load(path, storage);
+        StartupReport::addBytesParsed(data.size);
+
+        SceneDescription scene{};
+        scene.path = path;
+
+        std::istringstream stream{std::string(data.data, data.size)};
+        uint32_t texture = NO_TEXTURE;
+        std::string text;
+        for (uint32_t lineNumber = 1; std::getline(stream, text); ++lineNumber)
+        {
+            text = text.substr(0, text.find('#'));
+            std::istringstream line{text};
+            std::string directive;
+            if (!(line >> directive))
+            {
+                continue;
+            }
+
+            if (directive == "object")
+            {
+                Object object{};
+                std::string modelPath;
+                line >> modelPath;
+                object.model = scene.findOrAddModel(modelPath);
+                object.transform.translation = readVec3(line);
+                object.transform.rotation = readVec3(line);
+                object.transform.scale = readVec3(line);
+                object.texture = texture;
+                scene.objects.push_back(object);
+            }
+            else if (directive == "camera")
+            {
+                CameraKey key{};
+                key.translation = readVec3(line);
+                key.rotation = readVec3(line);
+                scene.cameraPath.push_back(key);
+            }
+            else if (directive == "light")
+            {
+                Light light{};
+                light.position = readVec3(line);
+                light.color = readVec3(line);
+                line >> light.radius;
+                scene.lights.push_back(light);
+            }
+            else if (directive == "frames")
+            {
+                line >> scene.frameCount;
+            }
+            else if (directive == "texture")
+            {
+                std::string texturePath;
+                line >> texturePath;
+                if (texturePath == "none")
+                {
+                    texture = NO_TEXTURE;
+                }
+                else
+                {
+                    auto it = std::find(scene.textures.begin(), scene.textures.end(), texturePath);
+                    texture = static_cast<uint32_t>(it - scene.textures.begin());
+                    if (it == scene.textures.end())
+                    {
+                        scene.textures.push_back(texturePath);
+                    }
+                }
+            }
+            else if (directive == "generate")
+            {
+                std::string arguments;
+                std::getline(line, arguments);
+                SceneGeneratorSettings settings{};
+                try
+                {
+                    settings = SceneGeneratorSettings::parse(arguments);
+                }
+                catch (const std::exception &e)
+                {
+                    throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": " + e.what());
+                }
+                if (objectCount > 0)
+                {
+                    settings.objectCount = objectCount;
+                }
+                size_t firstObject = scene.objects.size();
+                generateSceneObjects(settings, scene);
+                for (size_t i = firstObject; i < scene.objects.size(); ++i)
+                {
+                    scene.objects[i].texture = texture;
+                }
+                continue;
+            }
+            else
+            {
+                throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": unknown directive " + directive);
+            }
+
+            if (line.fail())
+            {
+                throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": malformed " + directive);
+            }
+        }
+
+        if (scene.cameraPath.empty())
+        {
+            throw std::runtime_error(path + ": scene needs at least one camera key");
+        }
+
+        return scene;
+    }
+
+    uint32_t SceneDescription::findOrAddModel(const std::string &modelPath)
+    {
+        auto it = std::find(models.begin(), models.end(), modelPath);
+        if (it != models.end())
+        {
+            return static_cast<uint32_t>(it - models.begin());
+        }
+        models.push_back(modelPath);
+        return static_cast<uint32_t>(models.size() - 1);
+    }
+
+    SceneDescription::CameraKey SceneDescription::sampleCamera(float t) const
+    {
+        if (cameraPath.size() == 1)
+        {
+            return cameraPath[0];
+        }
+
+        float segments = static_cast<float>(cameraPath.size() - 1);
+        float position = std::clamp(t, 0.0f, 1.0f) * segments;
+        size_t segment = std::min(static_cast<size_t>(position), cameraPath.size() - 2);
+        float local = position - static_cast<float>(segment);
+
+        // End points are duplicated so the spline passes through every key
+        auto key = [&](ptrdiff_t index) -> const CameraKey &
+        {
+            index = std::clamp<ptrdiff_t>(index, 0, static_cast<ptrdiff_t>(cameraPath.size()) - 1);
+            return cameraPath[index];
+        };
+        ptrdiff_t i = static_cast<ptrdiff_t>(segment);
+
+        CameraKey result{};
+        result.translation = catmullRom(key(i - 1).translation, key(i).translation, key(i + 1).translation, key(i + 2).translation, local);
+        result.rotation = catmullRom(key(i - 1).rotation, key(i).rotation, key(i + 1).rotation, key(i + 2).rotation, local);
+        return result;
+    }
+}
@@ -0,0 +1,297 @@
+#include "scene_generator.hpp"
+#include "scene.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace YTVK
+{
+    namespace
+    {
+        const char *const BUNDLED_MODELS[] = {
+            "models/smooth_vase.obj",
+            "models/flat_vase.obj",
+            "models/colored_cube.obj",
+            "models/cube.obj",
+        };
+        constexpr uint32_t BUNDLED_MODEL_COUNT = sizeof(BUNDLED_MODELS) / sizeof(BUNDLED_MODELS[0]);
+
+        // Must match the projection in App::run
+        const float FOV_Y = glm::radians(50.0f);
+        constexpr float ASPECT = 4.0f / 3.0f;
+        // Depth range objects are placed in; starts past the near plane so nothing clips the camera
+        constexpr float NEAR_Z = 1.5f;
+        constexpr float FAR_Z = 9.5f;
+        // Keeps objects inside the frustum edges
+        constexpr float MARGIN = 0.9f;
+        // +y is down in this engine
+        constexpr float GROUND_Y = 0.5f;
+
+        SceneDistribution parseDistribution(const std::string &name)
+        {
+            if (name == "grid")
+                return SceneDistribution::Grid;
+            if (name == "clustered")
+                return SceneDistribution::Clustered;
+            if (name == "random")
+                return SceneDistribution::Random;
+            if (name == "forest")
+                return SceneDistribution::Forest;
+
+            throw std::runtime_error("unknown distribution: " + name);
+        }
+
+        float parseFraction(const std::string &key, const std::string &value)
+        {
+            size_t parsed = 0;
+            float fraction = -1.0f;
+            try
+            {
+                fraction = std::stof(value, &parsed);
+            }
+            catch (const std::exception &)
+            {
+                parsed = 0;
+            }
+
+            if (parsed != value.size() || !(fraction >= 0.0f && fraction <= 1.0f))
+            {
+                throw std::runtime_error(key + " must be between 0 and 1: " + value);
+            }
+            return fraction;
+        }
+
+        uint32_t parseUnsigned(const std::string &key, const std::string &value)
+        {
+            size_t parsed = 0;
+            unsigned long number = 0;
+            try
+            {
+                number = std::stoul(value, &parsed);
+            }
+            catch (const std::exception &)
+            {
+                parsed = 0;
+            }
+
+            if (parsed != value.size() || value[0] == '-' || number > UINT32_MAX)
+            {
+                throw std::runtime_error("invalid value for " + key + ": " + value);
+            }
+            return static_cast<uint32_t>(number);
+        }
+
+        // Point i of count laid out by the distribution, in [0, 1]^3
+        class Layout
+        {
+        public:
+            Layout(const SceneGeneratorSettings &settings, uint32_t count, std::mt19937 &random)
+                : distribution{settings.distribution}, random{random}
+            {
+                if (distribution == SceneDistribution::Grid)
+                {
+                    side = std::max(1u, static_cast<uint32_t>(std::ceil(std::cbrt(static_cast<double>(count)))));
+                }
+                else if (distribution == SceneDistribution::Forest)
+                {
+                    side = std::max(1u, static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count)))));
+                }
+                else if (distribution == SceneDistribution::Clustered)
+                {
+                    std::uniform_real_distribution<float> centre{0.1f, 0.9f};
+                    centres.resize(std::max(1u, settings.clusters));
+                    for (auto &c : centres)
+                    {
+                        c = {centre(random), centre(random), centre(random)};
+                    }
+                }
+            }
+
+            glm::vec3 sample(uint32_t i)
+            {
+                switch (distribution)
+                {
+                case SceneDistribution::Grid:
+                    return {cell(i % side), cell(i / side % side), cell(i / (side * side))};
+                case SceneDistribution::Forest:
+                {
+                    float jitter = 0.4f / static_cast<float>(side);
+                    return {
+                        std::clamp(cell(i % side) + unit(random) * jitter, 0.0f, 1.0f),
+                        1.0f,
+                        std::clamp(cell(i / side) + unit(random) * jitter, 0.0f, 1.0f)};
+                }
+                case SceneDistribution::Clustered:
+                {
+                    std::normal_distribution<float> offset{0.0f, 0.05f};
+                    const glm::vec3 &c = centres[i % centres.size()];
+                    return glm::clamp(c + glm::vec3{offset(random), offset(random), offset(random)}, glm::vec3{0.0f}, glm::vec3{1.0f});
+                }
+                default:
+                {
+                    std::uniform_real_distribution<float> position{0.0f, 1.0f};
+                    return {position(random), position(random), position(random)};
+                }
+                }
+            }
+
+        private:
+            float cell(uint32_t index) const
+            {
+                return side > 1 ? static_cast<float>(index) / static_cast<float>(side - 1) : 0.5f;
+            }
+
+            SceneDistribution distribution;
+            std::mt19937 &random;
+            std::uniform_real_distribution<float> unit{-1.0f, 1.0f};
+            uint32_t side = 1;
+            std::vector<glm::vec3> centres;
+        };
+
+        // Maps a layout point into the default view frustum, or its mirror behind the camera
+        glm::vec3 toWorld(const glm::vec3 &p, bool visible, bool onGround)
+        {
+            float halfHeight = std::tan(FOV_Y * 0.5f) * MARGIN;
+            float z = NEAR_Z + (FAR_Z - NEAR_Z) * p.z;
+            glm::vec3 world{
+                (2.0f * p.x - 1.0f) * z * halfHeight * ASPECT,
+                onGround ? GROUND_Y : (2.0f * p.y - 1.0f) * z * halfHeight,
+                z};
+            if (!visible)
+            {
+                world.z = -world.z;
+            }
+            return world;
+        }
+    }
+
+    SceneGeneratorSettings SceneGeneratorSettings::parse(const std::string &arguments)
+    {
+        std::istringstream stream{arguments};
+        std::string distribution;
+        std::string count;
+        if (!(stream >> distribution >> count))
+        {
+            throw std::runtime_error("generate needs a distribution and an object count");
+        }
+
+        SceneGeneratorSettings settings{};
+        settings.distribution = parseDistribution(distribution);
+        settings.objectCount = parseUnsigned("count", count);
+        if (settings.distribution == SceneDistribution::Forest)
+        {
+            settings.modelVariety = 1;
+        }
+
+        std::string option;
+        while (stream >> option)
+        {
+            size_t equals = option.find('=');
+            if (equals == std::string::npos || equals + 1 == option.size())
+            {
+                throw std::runtime_error("expected key=value: " + option);
+            }
+            std::string key = option.substr(0, equals);
+            std::string value = option.substr(equals + 1);
+
+            if (key == "models")
+                settings.modelVariety = parseUnsigned(key, value);
+            else if (key == "static")
+                settings.staticFraction = parseFraction(key, value);
+            else if (key == "coverage")
+                settings.coverage = parseFraction(key, value);
+            else if (key == "clusters")
+                settings.clusters = parseUnsigned(key, value);
+            else if (key == "lights")
+                settings.lightCount = parseUnsigned(key, value);
+            else if (key == "seed")
+                settings.seed = parseUnsigned(key, value);
+            else
+                throw std::runtime_error("unknown generate option: " + key);
+        }
+
+        if (settings.modelVariety > BUNDLED_MODEL_COUNT)
+        {
+            throw std::runtime_error("models must be at most " + std::to_string(BUNDLED_MODEL_COUNT));
+        }
+        return settings;
+    }
+
+    void generateSceneObjects(const SceneGeneratorSettings &settings, SceneDescription &scene)
+    {
+        uint32_t variety = settings.modelVariety == 0 ? BUNDLED_MODEL_COUNT : settings.modelVariety;
+        std::vector<uint32_t> models;
+        for (uint32_t i = 0; i < variety; ++i)
+        {
+            models.push_back(scene.findOrAddModel(BUNDLED_MODELS[i]));
+        }
+
+        std::mt19937 random{settings.seed};
+        std::uniform_real_distribution<float> unit{0.0f, 1.0f};
+
+        uint32_t visibleCount = static_cast<uint32_t>(std::lround(static_cast<double>(settings.objectCount) * settings.coverage));
+        uint32_t hiddenCount = settings.objectCount - visibleCount;
+        bool forest = settings.distribution == SceneDistribution::Forest;
+
+        // Sized so the objects roughly fill the frustum without overlapping
+        float halfHeight = std::tan(FOV_Y * 0.5f) * MARGIN;
+        float depthCubed = FAR_Z * FAR_Z * FAR_Z - NEAR_Z * NEAR_Z * NEAR_Z;
+        float spacing = forest
+                            ? std::sqrt(halfHeight * ASPECT * (FAR_Z * FAR_Z - NEAR_Z * NEAR_Z) / std::max(1u, settings.objectCount))
+                            : std::cbrt(4.0f * halfHeight * halfHeight * ASPECT * depthCubed / 3.0f / std::max(1u, settings.objectCount));
+        float baseScale = std::min(0.5f, 0.5f * spacing);
+
+        scene.objects.reserve(scene.objects.size() + settings.objectCount);
+        uint32_t index = 0;
+        for (bool visible : {true, false})
+        {
+            uint32_t count = visible ? visibleCount : hiddenCount;
+            Layout layout{settings, count, random};
+            for (uint32_t i = 0; i < count; ++i, ++index)
+            {
+                SceneDescription::Object object{};
+                object.model = models[index % models.size()];
+                object.transform.translation = toWorld(layout.sample(i), visible, forest);
+
+                if (forest)
+                {
+                    object.transform.rotation.y = unit(random) * glm::two_pi<float>();
+                    object.transform.scale = glm::vec3{baseScale * (0.75f + 0.5f * unit(random))};
+                }
+                else
+                {
+                    if (settings.distribution != SceneDistribution::Grid)
+                    {
+                        object.transform.rotation = glm::vec3{unit(random), unit(random), unit(random)} * glm::two_pi<float>();
+                    }
+                    object.transform.scale = glm::vec3{baseScale};
+                }
+
+                if (unit(random) >= settings.staticFraction)
+                {
+                    object.spin.y = 2.0f * unit(random) - 1.0f;
+                }
+                scene.objects.push_back(object);
+            }
+        }
+
+        // Enough lights overlap every point that the scene stays lit at any light count
+        std::uniform_real_distribution<float> hue{0.0f, 6.0f};
+        float lightRadius = std::cbrt(4.0f * halfHeight * halfHeight * ASPECT * depthCubed / std::max(1u, settings.lightCount));
+        scene.lights.reserve(scene.lights.size() + settings.lightCount);
+        for (uint32_t i = 0; i < settings.lightCount; ++i)
+        {
+            SceneDescription::Light light{};
+            light.position = toWorld({unit(random), unit(random), unit(random)}, true, false);
+            float h = hue(random);
+            light.color = glm::clamp(glm::vec3{std::abs(h - 3.0f) - 1.0f, 2.0f - std::abs(h - 2.0f), 2.0f - std::abs(h - 4.0f)}, glm::vec3{0.0f}, glm::vec3{1.0f});
+            light.radius = lightRadius;
+            scene.lights.push_back(light);
+        }
+    }
+}
@@ -0,0 +1,137 @@
+#include "startup_report.hpp"
+
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <stdexcept>
+
+namespace YTVK
+{
+    std::atomic<uint64_t> StartupReport::filesRead{0};
+    std::atomic<uint64_t> StartupReport::bytesRead{0};
+    std::atomic<uint64_t> StartupReport::bytesParsed{0};
+    std::atomic<uint64_t> StartupReport::pipelinesCompiled{0};
+
+    namespace
+    {
+        const std::chrono::steady_clock::time_point processStart = std::chrono::steady_clock::now();
+
+        struct Snapshot
+        {
+            double firstFrameMs = 0.0;
+            uint64_t filesRead = 0;
+            uint64_t bytesRead = 0;
+            uint64_t bytesParsed = 0;
+            uint64_t pipelinesCompiled = 0;
+            StartupReport::Allocations allocations{};
+        };
+
+        std::mutex mutex;
+        std::vector<StartupReport::PhaseTime> phases;
+        bool finished = false;
+        Snapshot snapshot{};
+
+        double sinceStart(std::chrono::steady_clock::time_point time)
+        {
+            return std::chrono::duration<double, std::milli>(time - processStart).count();
+        }
+    }
+
+    StartupReport::Phase::Phase(const char *name) : name{name}, start{std::chrono::steady_clock::now()}
+    {
+    }
+
+    StartupReport::Phase::~Phase()
+    {
+        auto end = std::chrono::steady_clock::now();
+
+        std::lock_guard<std::mutex> lock{mutex};
+        if (!finished)
+        {
+            phases.push_back({name, sinceStart(start), std::chrono::duration<double, std::milli>(end - start).count()});
+        }
+    }
+
+    void StartupReport::addFileRead(uint64_t bytes)
+    {
+        filesRead.fetch_add(1, std::memory_order_relaxed);
+        bytesRead.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void StartupReport::addBytesParsed(uint64_t bytes)
+    {
+        bytesParsed.fetch_add(bytes, std::memory_order_relaxed);
+    }
+
+    void StartupReport::addPipelineCompiled()
+    {
+        pipelinesCompiled.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void StartupReport::finish(const Allocations &allocations)
+    {
+        auto now = std::chrono::steady_clock::now();
+
+        std::lock_guard<std::mutex> lock{mutex};
+        if (finished)
+        {
+            return;
+        }
+
+        finished = true;
+        snapshot.firstFrameMs = sinceStart(now);
+        snapshot.filesRead = filesRead.load(std::memory_order_relaxed);
+        snapshot.bytesRead = bytesRead.load(std::memory_order_relaxed);
+        snapshot.bytesParsed = bytesParsed.load(std::memory_order_relaxed);
+        snapshot.pipelinesCompiled = pipelinesCompiled.load(std::memory_order_relaxed);
+        snapshot.allocations = allocations;
+    }
+
+    bool StartupReport::isFinished()
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        return finished;
+    }
+
+    void StartupReport::print(std::ostream &out)
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        out << std::fixed << std::setprecision(2);
+        out << "startup: first frame after " << snapshot.firstFrameMs << " ms" << std::endl;
+        for (const auto &phase : phases)
+        {
+            out << "  " << std::setw(9) << phase.startMs << " ms  " << phase.name << ": " << phase.durationMs << " ms" << std::endl;
+        }
+        out << "  " << snapshot.filesRead << " files read (" << snapshot.bytesRead << " bytes), "
+            << snapshot.bytesParsed << " bytes parsed, " << snapshot.pipelinesCompiled << " pipelines compiled, "
+            << snapshot.allocations.gpuAllocations << " gpu allocations (" << snapshot.allocations.gpuBytes << " bytes), "
+            << snapshot.allocations.heapAllocations << " heap allocations" << std::endl;
+        out << std::defaultfloat;
+    }
+
+    void StartupReport::writeJson(const std::string &path)
+    {
+        std::ofstream out{path};
+        if (!out)
+        {
+            throw std::runtime_error("failed to open " + path);
+        }
+
+        std::lock_guard<std::mutex> lock{mutex};
+        out << std::fixed << std::setprecision(3);
+        out << "{\n  \"first_frame_ms\": " << snapshot.firstFrameMs << ",\n  \"phases\": [\n";
+        for (size_t i = 0; i < phases.size(); ++i)
+        {
+            out << "    {\"name\": \"" << phases[i].name << "\", \"start_ms\": " << phases[i].startMs
+                << ", \"duration_ms\": " << phases[i].durationMs << "}" << (i + 1 < phases.size() ? "," : "") << "\n";
+        }
+        out << "  ],\n"
+            << "  \"files_read\": " << snapshot.filesRead << ",\n"
+            << "  \"bytes_read\": " << snapshot.bytesRead << ",\n"
+            << "  \"bytes_parsed\": " << snapshot.bytesParsed << ",\n"
+            << "  \"pipelines_compiled\": " << snapshot.pipelinesCompiled << ",\n"
+            << "  \"gpu_allocations\": " << snapshot.allocations.gpuAllocations << ",\n"
+            << "  \"gpu_bytes\": " << snapshot.allocations.gpuBytes << ",\n"
+            << "  \"heap_allocations\": " << snapshot.allocations.heapAllocations << "\n}\n";
+    }
+}
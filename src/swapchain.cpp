@@ -1,4 +1,5 @@
 #include "swapchain.hpp"
+#include "trace.hpp"
 
 // std
 #include <array>
@@ -12,22 +13,35 @@
 namespace YTVK
 {
 
-  SwapChain::SwapChain(Device &deviceRef, VkExtent2D extent)
-      : device{deviceRef}, windowExtent{extent}
+  SwapChain::SwapChain(Device &deviceRef, VkExtent2D extent, const SwapChainSettings &settings)
+      : device{deviceRef}, windowExtent{extent}, settings{settings}
   {
     init();
   }
 
-  SwapChain::SwapChain(Device &deviceRef, VkExtent2D extent, std::shared_ptr<SwapChain> previous)
-      : device{deviceRef}, windowExtent{extent}, oldSwapChain(previous)
+  SwapChain::SwapChain(Device &deviceRef, VkExtent2D extent, const SwapChainSettings &settings, std::shared_ptr<SwapChain> previous)
+      : device{deviceRef}, windowExtent{extent}, settings{settings}, oldSwapChain(previous)
   {
+    if (settings.framesInFlight != oldSwapChain->settings.framesInFlight)
+    {
+      throw std::runtime_error("frames in flight cannot change when recreating the swap chain");
+    }
+
     init();
 
+    // Frame slots outlive the swap chain, so carry over what they are still waiting on
+    frameTimelineValues = oldSwapChain->frameTimelineValues;
+    currentFrame = oldSwapChain->currentFrame;
     oldSwapChain = nullptr;
   }
 
   void SwapChain::init()
   {
+    if (settings.framesInFlight < 1 || settings.framesInFlight > MAX_FRAMES_IN_FLIGHT)
+    {
+      throw std::runtime_error("frames in flight must be between 1 and " + std::to_string(MAX_FRAMES_IN_FLIGHT));
+    }
+
     createSwapChain();
     createImageViews();
     createRenderPass();
@@ -54,7 +68,7 @@ namespace YTVK
     {
       vkDestroyImageView(device.device(), depthImageViews[i], nullptr);
       vkDestroyImage(device.device(), depthImages[i], nullptr);
-      vkFreeMemory(device.device(), depthImageMemorys[i], nullptr);
+      device.freeMemory(depthImageMemorys[i]);
     }
 
     for (auto framebuffer : swapChainFramebuffers)
@@ -65,22 +79,21 @@ namespace YTVK
     vkDestroyRenderPass(device.device(), renderPass, nullptr);
 
     // cleanup synchronization objects
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (size_t i = 0; i < imageAvailableSemaphores.size(); i++)
     {
       vkDestroySemaphore(device.device(), renderFinishedSemaphores[i], nullptr);
       vkDestroySemaphore(device.device(), imageAvailableSemaphores[i], nullptr);
-      vkDestroyFence(device.device(), inFlightFences[i], nullptr);
+    }
+    for (auto fence : presentFences)
+    {
+      vkDestroyFence(device.device(), fence, nullptr);
     }
   }
 
   VkResult SwapChain::acquireNextImage(uint32_t *imageIndex)
   {
-    vkWaitForFences(
-        device.device(),
-        1,
-        &inFlightFences[currentFrame],
-        VK_TRUE,
-        std::numeric_limits<uint64_t>::max());
+    YTVK_TRACE_SCOPE("SwapChain::acquireNextImage");
+    device.waitForTimelineValue(frameTimelineValues[currentFrame]);
 
     VkResult result = vkAcquireNextImageKHR(
         device.device(),
@@ -96,11 +109,11 @@ namespace YTVK
   VkResult SwapChain::submitCommandBuffers(
       const VkCommandBuffer *buffers, uint32_t *imageIndex)
   {
-    if (imagesInFlight[*imageIndex] != VK_NULL_HANDLE)
-    {
-      vkWaitForFences(device.device(), 1, &imagesInFlight[*imageIndex], VK_TRUE, UINT64_MAX);
-    }
-    imagesInFlight[*imageIndex] = inFlightFences[currentFrame];
+    device.waitForTimelineValue(imageTimelineValues[*imageIndex]);
+
+    uint64_t signalValue = device.nextTimelineValue();
+    frameTimelineValues[currentFrame] = signalValue;
+    imageTimelineValues[*imageIndex] = signalValue;
 
     VkSubmitInfo submitInfo = {};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
@@ -114,13 +127,19 @@ namespace YTVK
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = buffers;
 
-    VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
-    submitInfo.signalSemaphoreCount = 1;
+    // Binary semaphore values are ignored but the value array must cover every signal semaphore
+    VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame], device.timelineSemaphore()};
+    uint64_t signalValues[] = {0, signalValue};
+    submitInfo.signalSemaphoreCount = 2;
     submitInfo.pSignalSemaphores = signalSemaphores;
 
-    vkResetFences(device.device(), 1, &inFlightFences[currentFrame]);
-    if (vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, inFlightFences[currentFrame]) !=
-        VK_SUCCESS)
+    VkTimelineSemaphoreSubmitInfo timelineInfo = {};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.signalSemaphoreValueCount = 2;
+    timelineInfo.pSignalSemaphoreValues = signalValues;
+    submitInfo.pNext = &timelineInfo;
+
+    if (vkQueueSubmit(device.graphicsQueue(), 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS)
     {
       throw std::runtime_error("failed to submit draw command buffer!");
     }
@@ -137,9 +156,21 @@ namespace YTVK
 
     presentInfo.pImageIndices = imageIndex;
 
+    // This slot's previous present is frames in flight old, so the wait is normally free
+    VkSwapchainPresentFenceInfoEXT presentFenceInfo = {};
+    if (!presentFences.empty())
+    {
+      vkWaitForFences(device.device(), 1, &presentFences[currentFrame], VK_TRUE, UINT64_MAX);
+      vkResetFences(device.device(), 1, &presentFences[currentFrame]);
+      presentFenceInfo.sType = VK_STRUCTURE_TYPE_SWAPCHAIN_PRESENT_FENCE_INFO_EXT;
+      presentFenceInfo.swapchainCount = 1;
+      presentFenceInfo.pFences = &presentFences[currentFrame];
+      presentInfo.pNext = &presentFenceInfo;
+    }
+
     auto result = vkQueuePresentKHR(device.presentQueue(), &presentInfo);
 
-    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    currentFrame = (currentFrame + 1) % settings.framesInFlight;
 
     return result;
   }
@@ -149,7 +180,7 @@ namespace YTVK
     SwapChainSupportDetails swapChainSupport = device.getSwapChainSupport();
 
     VkSurfaceFormatKHR surfaceFormat = chooseSwapSurfaceFormat(swapChainSupport.formats);
-    VkPresentModeKHR presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
+    presentMode = chooseSwapPresentMode(swapChainSupport.presentModes);
     VkExtent2D extent = chooseSwapExtent(swapChainSupport.capabilities);
 
     uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
@@ -265,32 +296,48 @@ namespace YTVK
     colorAttachmentRef.attachment = 0;
     colorAttachmentRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
-    VkSubpassDescription subpass = {};
-    subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
-    subpass.colorAttachmentCount = 1;
-    subpass.pColorAttachments = &colorAttachmentRef;
-    subpass.pDepthStencilAttachment = &depthAttachmentRef;
-
-    VkSubpassDependency dependency = {};
-    dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
-    dependency.srcAccessMask = 0;
-    dependency.srcStageMask =
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependency.dstSubpass = 0;
-    dependency.dstStageMask =
-        VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT | VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
-    dependency.dstAccessMask =
-        VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    std::array<VkSubpassDescription, 2> subpasses = {};
+    subpasses[DEPTH_PREPASS_SUBPASS].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpasses[DEPTH_PREPASS_SUBPASS].pDepthStencilAttachment = &depthAttachmentRef;
+    subpasses[MAIN_SUBPASS].pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+    subpasses[MAIN_SUBPASS].colorAttachmentCount = 1;
+    subpasses[MAIN_SUBPASS].pColorAttachments = &colorAttachmentRef;
+    subpasses[MAIN_SUBPASS].pDepthStencilAttachment = &depthAttachmentRef;
+
+    std::array<VkSubpassDependency, 3> dependencies = {};
+    dependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[0].srcStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencies[0].srcAccessMask = 0;
+    dependencies[0].dstSubpass = DEPTH_PREPASS_SUBPASS;
+    dependencies[0].dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT;
+    dependencies[0].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+    // Chains to the image acquire semaphore wait, which is at color attachment output
+    dependencies[1].srcSubpass = VK_SUBPASS_EXTERNAL;
+    dependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[1].srcAccessMask = 0;
+    dependencies[1].dstSubpass = MAIN_SUBPASS;
+    dependencies[1].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    dependencies[1].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+    // Pre-pass depth is tested (and without a pre-pass, written) by the main subpass
+    dependencies[2].srcSubpass = DEPTH_PREPASS_SUBPASS;
+    dependencies[2].srcStageMask = VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencies[2].srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependencies[2].dstSubpass = MAIN_SUBPASS;
+    dependencies[2].dstStageMask = VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+    dependencies[2].dstAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+    dependencies[2].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
 
     std::array<VkAttachmentDescription, 2> attachments = {colorAttachment, depthAttachment};
     VkRenderPassCreateInfo renderPassInfo = {};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
     renderPassInfo.attachmentCount = static_cast<uint32_t>(attachments.size());
     renderPassInfo.pAttachments = attachments.data();
-    renderPassInfo.subpassCount = 1;
-    renderPassInfo.pSubpasses = &subpass;
-    renderPassInfo.dependencyCount = 1;
-    renderPassInfo.pDependencies = &dependency;
+    renderPassInfo.subpassCount = static_cast<uint32_t>(subpasses.size());
+    renderPassInfo.pSubpasses = subpasses.data();
+    renderPassInfo.dependencyCount = static_cast<uint32_t>(dependencies.size());
+    renderPassInfo.pDependencies = dependencies.data();
 
     if (vkCreateRenderPass(device.device(), &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS)
     {
@@ -380,29 +427,55 @@ namespace YTVK
 
   void SwapChain::createSyncObjects()
   {
-    imageAvailableSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    renderFinishedSemaphores.resize(MAX_FRAMES_IN_FLIGHT);
-    inFlightFences.resize(MAX_FRAMES_IN_FLIGHT);
-    imagesInFlight.resize(imageCount(), VK_NULL_HANDLE);
+    imageAvailableSemaphores.resize(settings.framesInFlight);
+    renderFinishedSemaphores.resize(settings.framesInFlight);
+    frameTimelineValues.resize(settings.framesInFlight, 0);
+    imageTimelineValues.resize(imageCount(), 0);
 
     VkSemaphoreCreateInfo semaphoreInfo = {};
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
 
-    VkFenceCreateInfo fenceInfo = {};
-    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
-
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++)
+    for (size_t i = 0; i < settings.framesInFlight; i++)
     {
       if (vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) !=
               VK_SUCCESS ||
           vkCreateSemaphore(device.device(), &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) !=
-              VK_SUCCESS ||
-          vkCreateFence(device.device(), &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS)
+              VK_SUCCESS)
       {
         throw std::runtime_error("failed to create synchronization objects for a frame!");
       }
     }
+
+    if (!device.supportsPresentFences())
+    {
+      return;
+    }
+
+    // Signaled, so a slot that has not presented yet counts as complete
+    VkFenceCreateInfo fenceInfo = {};
+    fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+    fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+
+    presentFences.resize(settings.framesInFlight);
+    for (size_t i = 0; i < settings.framesInFlight; i++)
+    {
+      if (vkCreateFence(device.device(), &fenceInfo, nullptr, &presentFences[i]) != VK_SUCCESS)
+      {
+        throw std::runtime_error("failed to create present fence!");
+      }
+    }
+  }
+
+  bool SwapChain::presentsComplete()
+  {
+    for (auto fence : presentFences)
+    {
+      if (vkGetFenceStatus(device.device(), fence) != VK_SUCCESS)
+      {
+        return false;
+      }
+    }
+    return true;
   }
 
   VkSurfaceFormatKHR SwapChain::chooseSwapSurfaceFormat(
@@ -420,26 +493,38 @@ namespace YTVK
     return availableFormats[0];
   }
 
+  const char *presentModeName(VkPresentModeKHR mode)
+  {
+    switch (mode)
+    {
+    case VK_PRESENT_MODE_FIFO_KHR:
+      return "fifo";
+    case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+      return "fifo-relaxed";
+    case VK_PRESENT_MODE_MAILBOX_KHR:
+      return "mailbox";
+    case VK_PRESENT_MODE_IMMEDIATE_KHR:
+      return "immediate";
+    default:
+      return "unknown";
+    }
+  }
+
   VkPresentModeKHR SwapChain::chooseSwapPresentMode(
       const std::vector<VkPresentModeKHR> &availablePresentModes)
   {
     for (const auto &availablePresentMode : availablePresentModes)
     {
-      if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR)
+      if (availablePresentMode == settings.presentMode)
       {
-        std::cout << "Present mode: Mailbox" << std::endl;
+        std::cout << "Present mode: " << presentModeName(availablePresentMode) << std::endl;
         return availablePresentMode;
       }
     }
 
-    // for (const auto &availablePresentMode : availablePresentModes) {
-    //   if (availablePresentMode == VK_PRESENT_MODE_IMMEDIATE_KHR) {
-    //     std::cout << "Present mode: Immediate" << std::endl;
-    //     return availablePresentMode;
-    //   }
-    // }
-
-    std::cout << "Present mode: V-Sync" << std::endl;
+    // FIFO is the only mode every implementation has to support
+    std::cout << "Present mode: " << presentModeName(settings.presentMode)
+              << " unavailable, falling back to " << presentModeName(VK_PRESENT_MODE_FIFO_KHR) << std::endl;
     return VK_PRESENT_MODE_FIFO_KHR;
   }
 
@@ -0,0 +1,611 @@
+#include "texture.hpp"
+#include "asset_archive.hpp"
+#include "startup_report.hpp"
+#include "trace.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+namespace YTVK
+{
+    namespace
+    {
+        struct Ktx2Header
+        {
+            uint8_t identifier[12];
+            uint32_t vkFormat;
+            uint32_t typeSize;
+            uint32_t pixelWidth;
+            uint32_t pixelHeight;
+            uint32_t pixelDepth;
+            uint32_t layerCount;
+            uint32_t faceCount;
+            uint32_t levelCount;
+            uint32_t supercompressionScheme;
+            uint32_t dfdByteOffset;
+            uint32_t dfdByteLength;
+            uint32_t kvdByteOffset;
+            uint32_t kvdByteLength;
+            uint64_t sgdByteOffset;
+            uint64_t sgdByteLength;
+        };
+        static_assert(sizeof(Ktx2Header) == 80, "KTX2 header must match the file layout");
+
+        struct Ktx2Level
+        {
+            uint64_t byteOffset;
+            uint64_t byteLength;
+            uint64_t uncompressedByteLength;
+        };
+
+        const uint8_t KTX2_IDENTIFIER[12] = {0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n'};
+
+        // Satisfies the copy offset rules for every format: 4 bytes and the texel block size
+        constexpr VkDeviceSize LEVEL_ALIGNMENT = 16;
+
+        struct TexelBlock
+        {
+            uint32_t width;
+            uint32_t height;
+            uint32_t bytes;
+        };
+
+        // Formats ktx2 files are accepted in; anything else cannot be size checked and is refused
+        bool texelBlock(VkFormat format, TexelBlock &block)
+        {
+            if (format >= VK_FORMAT_ASTC_4x4_UNORM_BLOCK && format <= VK_FORMAT_ASTC_12x12_SRGB_BLOCK)
+            {
+                // UNORM and SRGB alternate for each footprint
+                static const uint32_t footprints[][2] = {
+                    {4, 4}, {5, 4}, {5, 5}, {6, 5}, {6, 6}, {8, 5}, {8, 6}, {8, 8}, {10, 5}, {10, 6}, {10, 8}, {10, 10}, {12, 10}, {12, 12}};
+                const uint32_t *footprint = footprints[(format - VK_FORMAT_ASTC_4x4_UNORM_BLOCK) / 2];
+                block = {footprint[0], footprint[1], 16};
+                return true;
+            }
+
+            switch (format)
+            {
+            case VK_FORMAT_R8_UNORM:
+            case VK_FORMAT_R8_SRGB:
+                block = {1, 1, 1};
+                return true;
+            case VK_FORMAT_R8G8_UNORM:
+            case VK_FORMAT_R8G8_SRGB:
+            case VK_FORMAT_R16_UNORM:
+            case VK_FORMAT_R16_SFLOAT:
+                block = {1, 1, 2};
+                return true;
+            case VK_FORMAT_R8G8B8A8_UNORM:
+            case VK_FORMAT_R8G8B8A8_SRGB:
+            case VK_FORMAT_B8G8R8A8_UNORM:
+            case VK_FORMAT_B8G8R8A8_SRGB:
+            case VK_FORMAT_A2B10G10R10_UNORM_PACK32:
+            case VK_FORMAT_B10G11R11_UFLOAT_PACK32:
+            case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
+            case VK_FORMAT_R16G16_SFLOAT:
+            case VK_FORMAT_R32_SFLOAT:
+                block = {1, 1, 4};
+                return true;
+            case VK_FORMAT_R16G16B16A16_UNORM:
+            case VK_FORMAT_R16G16B16A16_SFLOAT:
+            case VK_FORMAT_R32G32_SFLOAT:
+                block = {1, 1, 8};
+                return true;
+            case VK_FORMAT_R32G32B32A32_SFLOAT:
+                block = {1, 1, 16};
+                return true;
+            case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+            case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+            case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+            case VK_FORMAT_BC4_UNORM_BLOCK:
+            case VK_FORMAT_BC4_SNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+            case VK_FORMAT_EAC_R11_UNORM_BLOCK:
+            case VK_FORMAT_EAC_R11_SNORM_BLOCK:
+                block = {4, 4, 8};
+                return true;
+            case VK_FORMAT_BC2_UNORM_BLOCK:
+            case VK_FORMAT_BC2_SRGB_BLOCK:
+            case VK_FORMAT_BC3_UNORM_BLOCK:
+            case VK_FORMAT_BC3_SRGB_BLOCK:
+            case VK_FORMAT_BC5_UNORM_BLOCK:
+            case VK_FORMAT_BC5_SNORM_BLOCK:
+            case VK_FORMAT_BC6H_UFLOAT_BLOCK:
+            case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+            case VK_FORMAT_BC7_UNORM_BLOCK:
+            case VK_FORMAT_BC7_SRGB_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK:
+            case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+            case VK_FORMAT_EAC_R11G11_UNORM_BLOCK:
+            case VK_FORMAT_EAC_R11G11_SNORM_BLOCK:
+                block = {4, 4, 16};
+                return true;
+            default:
+                return false;
+            }
+        }
+
+        uint32_t fullMipChainLength(VkExtent2D extent)
+        {
+            return static_cast<uint32_t>(std::floor(std::log2(std::max(extent.width, extent.height)))) + 1;
+        }
+
+        bool endsWith(const std::string &text, const std::string &suffix)
+        {
+            return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+        }
+
+        void imageBarrier(
+            VkCommandBuffer commandBuffer,
+            VkImage image,
+            uint32_t baseMipLevel,
+            uint32_t levelCount,
+            VkImageLayout oldLayout,
+            VkImageLayout newLayout,
+            VkPipelineStageFlags srcStage,
+            VkAccessFlags srcAccess,
+            VkPipelineStageFlags dstStage,
+            VkAccessFlags dstAccess)
+        {
+            VkImageMemoryBarrier barrier{};
+            barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+            barrier.srcAccessMask = srcAccess;
+            barrier.dstAccessMask = dstAccess;
+            barrier.oldLayout = oldLayout;
+            barrier.newLayout = newLayout;
+            barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+            barrier.image = image;
+            barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            barrier.subresourceRange.baseMipLevel = baseMipLevel;
+            barrier.subresourceRange.levelCount = levelCount;
+            barrier.subresourceRange.baseArrayLayer = 0;
+            barrier.subresourceRange.layerCount = 1;
+
+            vkCmdPipelineBarrier(commandBuffer, srcStage, dstStage, 0, 0, nullptr, 0, nullptr, 1, &barrier);
+        }
+
+        void makeShaderReadable(VkCommandBuffer commandBuffer, VkImage image, uint32_t baseMipLevel, uint32_t levelCount, VkImageLayout oldLayout)
+        {
+            bool fromCopy = oldLayout == VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+            imageBarrier(
+                commandBuffer, image, baseMipLevel, levelCount,
+                oldLayout, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+                VK_PIPELINE_STAGE_TRANSFER_BIT, fromCopy ? VK_ACCESS_TRANSFER_WRITE_BIT : VK_ACCESS_TRANSFER_READ_BIT,
+                VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+        }
+    }
+
+    // *************** Sampler Cache *********************
+
+    bool SamplerSettings::operator==(const SamplerSettings &other) const
+    {
+        return filter == other.filter && mipmapMode == other.mipmapMode &&
+               addressMode == other.addressMode && maxAnisotropy == other.maxAnisotropy;
+    }
+
+    size_t SamplerCache::SettingsHash::operator()(const SamplerSettings &settings) const
+    {
+        size_t seed = 0;
+        hashCombine(seed, settings.filter, settings.mipmapMode, settings.addressMode, settings.maxAnisotropy);
+        return seed;
+    }
+
+    SamplerCache::~SamplerCache()
+    {
+        for (auto &[settings, sampler] : samplers)
+        {
+            vkDestroySampler(device.device(), sampler, nullptr);
+        }
+    }
+
+    VkSampler SamplerCache::getSampler(const SamplerSettings &settings)
+    {
+        auto it = samplers.find(settings);
+        if (it != samplers.end())
+        {
+            return it->second;
+        }
+
+        float anisotropy = std::min(settings.maxAnisotropy, device.properties.limits.maxSamplerAnisotropy);
+
+        VkSamplerCreateInfo samplerInfo{};
+        samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+        samplerInfo.magFilter = settings.filter;
+        samplerInfo.minFilter = settings.filter;
+        samplerInfo.mipmapMode = settings.mipmapMode;
+        samplerInfo.addressModeU = settings.addressMode;
+        samplerInfo.addressModeV = settings.addressMode;
+        samplerInfo.addressModeW = settings.addressMode;
+        samplerInfo.anisotropyEnable = anisotropy > 1.0f ? VK_TRUE : VK_FALSE;
+        samplerInfo.maxAnisotropy = std::max(anisotropy, 1.0f);
+        samplerInfo.compareOp = VK_COMPARE_OP_ALWAYS;
+        samplerInfo.minLod = 0.0f;
+        samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+        samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+
+        VkSampler sampler;
+        if (vkCreateSampler(device.device(), &samplerInfo, nullptr, &sampler) != VK_SUCCESS)
+        {
+            throw std::runtime_error("failed to create texture sampler");
+        }
+        samplers.emplace(settings, sampler);
+        return sampler;
+    }
+
+    // *************** Texture Builder *********************
+
+    void Texture::Builder::loadTexture(const std::string &path)
+    {
+        if (endsWith(path, ".ktx2"))
+        {
+            loadKtx2(path);
+        }
+        else if (endsWith(path, ".ppm"))
+        {
+            loadPpm(path);
+        }
+        else
+        {
+            throw std::runtime_error("unsupported texture file: " + path);
+        }
+    }
+
+    void Texture::Builder::loadKtx2(const std::string &path)
+    {
+        YTVK_TRACE_SCOPE("Texture::Builder::loadKtx2");
+        std::vector<char> storage;
+        AssetView file = AssetArchive::load(path, storage);
+        StartupReport::addBytesParsed(file.size);
+
+        Ktx2Header header;
+        if (file.size < sizeof(header))
+        {
+            throw std::runtime_error("truncated ktx2 file: " + path);
+        }
+        std::memcpy(&header, file.data, sizeof(header));
+
+        if (std::memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0)
+        {
+            throw std::runtime_error("not a ktx2 file: " + path);
+        }
+        // Basis Universal and zstd payloads would need a transcoder
+        if (header.vkFormat == VK_FORMAT_UNDEFINED || header.supercompressionScheme != 0)
+        {
+            throw std::runtime_error("supercompressed ktx2 is not supported: " + path);
+        }
+        if (header.pixelWidth == 0 || header.pixelHeight == 0 || header.pixelDepth > 1 || header.layerCount > 1 || header.faceCount != 1)
+        {
+            throw std::runtime_error("only 2d ktx2 textures are supported: " + path);
+        }
+
+        TexelBlock block;
+        if (!texelBlock(static_cast<VkFormat>(header.vkFormat), block))
+        {
+            throw std::runtime_error("unsupported ktx2 format " + std::to_string(header.vkFormat) + ": " + path);
+        }
+
+        // A level count of 0 asks the loader to generate the mip chain
+        uint32_t levelCount = std::max(header.levelCount, 1u);
+        if (levelCount > fullMipChainLength({header.pixelWidth, header.pixelHeight}))
+        {
+            throw std::runtime_error("ktx2 file has more mip levels than its extent allows: " + path);
+        }
+        if (file.size < sizeof(header) + levelCount * sizeof(Ktx2Level))
+        {
+            throw std::runtime_error("truncated ktx2 file: " + path);
+        }
+
+        format = static_cast<VkFormat>(header.vkFormat);
+        extent = {header.pixelWidth, header.pixelHeight};
+        generateMipmaps = header.levelCount == 0;
+        levels.clear();
+        data.clear();
+
+        for (uint32_t i = 0; i < levelCount; ++i)
+        {
+            Ktx2Level level;
+            std::memcpy(&level, file.data + sizeof(header) + i * sizeof(Ktx2Level), sizeof(level));
+            if (level.byteLength == 0 || level.byteOffset > file.size || level.byteLength > file.size - level.byteOffset)
+            {
+                throw std::runtime_error("ktx2 mip level " + std::to_string(i) + " is out of bounds: " + path);
+            }
+
+            // The upload copies a full level, which must all be in the staged data
+            uint64_t blocksWide = (std::max(extent.width >> i, 1u) + block.width - 1) / block.width;
+            uint64_t blocksHigh = (std::max(extent.height >> i, 1u) + block.height - 1) / block.height;
+            if (level.byteLength < blocksWide * blocksHigh * block.bytes)
+            {
+                throw std::runtime_error("ktx2 mip level " + std::to_string(i) + " is smaller than its extent: " + path);
+            }
+
+            VkDeviceSize offset = (data.size() + LEVEL_ALIGNMENT - 1) / LEVEL_ALIGNMENT * LEVEL_ALIGNMENT;
+            data.resize(offset + level.byteLength);
+            std::memcpy(data.data() + offset, file.data + level.byteOffset, level.byteLength);
+            levels.push_back({offset, level.byteLength});
+        }
+    }
+
+    void Texture::Builder::loadPpm(const std::string &path)
+    {
+        YTVK_TRACE_SCOPE("Texture::Builder::loadPpm");
+        std::vector<char> storage;
+        AssetView file = AssetArchive::load(path, storage);
+        StartupReport::addBytesParsed(file.size);
+
+        size_t position = 0;
+        auto nextToken = [&]()
+        {
+            while (position < file.size)
+            {
+                if (file.data[position] == '#')
+                {
+                    while (position < file.size && file.data[position] != '\n')
+                        position++;
+                }
+                else if (std::isspace(static_cast<unsigned char>(file.data[position])))
+                {
+                    position++;
+                }
+                else
+                {
+                    break;
+                }
+            }
+            size_t start = position;
+            while (position < file.size && !std::isspace(static_cast<unsigned char>(file.data[position])))
+            {
+                position++;
+            }
+            return std::string(file.data + start, position - start);
+        };
+        auto nextNumber = [&]()
+        {
+            std::string token = nextToken();
+            if (token.empty() || token.size() > 9 || token.find_first_not_of("0123456789") != std::string::npos)
+            {
+                throw std::runtime_error("malformed ppm header: " + path);
+            }
+            return static_cast<uint32_t>(std::stoul(token));
+        };
+
+        if (nextToken() != "P6")
+        {
+            throw std::runtime_error("only binary (P6) ppm textures are supported: " + path);
+        }
+        uint32_t width = nextNumber();
+        uint32_t height = nextNumber();
+        if (width == 0 || height == 0 || nextNumber() != 255)
+        {
+            throw std::runtime_error("ppm textures must be 8 bit and non-empty: " + path);
+        }
+        // Exactly one whitespace byte separates the header from the pixels
+        position++;
+
+        size_t pixelCount = static_cast<size_t>(width) * height;
+        if (position > file.size || file.size - position < pixelCount * 3)
+        {
+            throw std::runtime_error("truncated ppm file: " + path);
+        }
+
+        format = VK_FORMAT_R8G8B8A8_SRGB;
+        extent = {width, height};
+        data.resize(pixelCount * 4);
+        const char *pixels = file.data + position;
+        for (size_t i = 0; i < pixelCount; ++i)
+        {
+            data[i * 4 + 0] = pixels[i * 3 + 0];
+            data[i * 4 + 1] = pixels[i * 3 + 1];
+            data[i * 4 + 2] = pixels[i * 3 + 2];
+            data[i * 4 + 3] = static_cast<char>(0xFF);
+        }
+        levels = {{0, data.size()}};
+        generateMipmaps = true;
+    }
+
+    // *************** Texture *********************
+
+    Texture::Texture(Device &device, UploadBatch &uploadBatch, const Texture::Builder &builder, VkSampler sampler, uint32_t baseLevel)
+        : device{device},
+          sampler{sampler},
+          format{builder.format},
+          extent{std::max(builder.extent.width >> baseLevel, 1u), std::max(builder.extent.height >> baseLevel, 1u)}
+    {
+        assert(baseLevel < builder.levels.size() && "Texture needs at least one mip level");
+
+        VkFormatProperties properties = device.getFormatProperties(format);
+        if ((properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) == 0)
+        {
+            throw std::runtime_error("texture format " + std::to_string(format) + " is not supported by the device");
+        }
+
+        // Blitting needs linear filtering support; otherwise the texture keeps the levels it came with
+        constexpr VkFormatFeatureFlags BLIT_FEATURES =
+            VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+        bool blit = builder.generateMipmaps && (properties.optimalTilingFeatures & BLIT_FEATURES) == BLIT_FEATURES;
+
+        uint32_t givenLevels = static_cast<uint32_t>(builder.levels.size()) - baseLevel;
+        mipLevels = givenLevels;
+        if (blit)
+        {
+            mipLevels = fullMipChainLength(extent);
+        }
+
+        VkImageUsageFlags usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+        if (mipLevels > givenLevels)
+        {
+            usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        }
+        createImage(usage);
+        createImageView();
+        recordUpload(uploadBatch, builder, baseLevel);
+    }
+
+    Texture::~Texture()
+    {
+        if (bindlessSet != nullptr)
+        {
+            bindlessSet->removeTexture(bindlessIndex);
+        }
+        device.notifyResourceDestroyed(Device::handleKey(imageView));
+
+        // Frames in flight may still sample it
+        device.deletionQueue().push(
+            [owner = &device, image = image, imageView = imageView, memory = memory]()
+            {
+                vkDestroyImageView(owner->device(), imageView, nullptr);
+                vkDestroyImage(owner->device(), image, nullptr);
+                owner->freeMemory(memory);
+            });
+    }
+
+    std::unique_ptr<Texture> Texture::createTextureFromFile(
+        Device &device, UploadBatch &uploadBatch, SamplerCache &samplerCache, const std::string &path)
+    {
+        Builder builder{};
+        builder.loadTexture(path);
+        return std::make_unique<Texture>(device, uploadBatch, builder, samplerCache.getSampler());
+    }
+
+    uint32_t Texture::registerBindless(BindlessSet &bindlessSet)
+    {
+        if (this->bindlessSet == nullptr)
+        {
+            bindlessIndex = bindlessSet.addTexture(imageView, sampler);
+            this->bindlessSet = &bindlessSet;
+        }
+        assert(this->bindlessSet == &bindlessSet && "Texture is registered with another bindless set");
+        return bindlessIndex;
+    }
+
+    VkDescriptorImageInfo Texture::descriptorInfo() const
+    {
+        return {sampler, imageView, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    }
+
+    void Texture::createImage(VkImageUsageFlags usage)
+    {
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = format;
+        imageInfo.extent = {extent.width, extent.height, 1};
+        imageInfo.mipLevels = mipLevels;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = usage;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+        device.createImageWithInfo(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, memory);
+
+        VkMemoryRequirements requirements;
+        vkGetImageMemoryRequirements(device.device(), image, &requirements);
+        memorySize = requirements.size;
+    }
+
+    void Texture::createImageView()
+    {
+        VkImageViewCreateInfo viewInfo{};
+        viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+        viewInfo.image = image;
+        viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+        viewInfo.format = format;
+        viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        viewInfo.subresourceRange.baseMipLevel = 0;
+        viewInfo.subresourceRange.levelCount = mipLevels;
+        viewInfo.subresourceRange.baseArrayLayer = 0;
+        viewInfo.subresourceRange.layerCount = 1;
+
+        if (vkCreateImageView(device.device(), &viewInfo, nullptr, &imageView) != VK_SUCCESS)
+        {
+            vkDestroyImage(device.device(), image, nullptr);
+            device.freeMemory(memory);
+            throw std::runtime_error("failed to create texture image view");
+        }
+    }
+
+    void Texture::recordUpload(UploadBatch &uploadBatch, const Texture::Builder &builder, uint32_t baseLevel)
+    {
+        // Levels are stored largest first, so the ones we want are a suffix of data
+        VkDeviceSize dataOffset = builder.levels[baseLevel].offset;
+        VkDeviceSize dataSize = builder.data.size() - dataOffset;
+        UploadBatch::Staging staging = uploadBatch.stage(dataSize, LEVEL_ALIGNMENT);
+        std::memcpy(staging.data, builder.data.data() + dataOffset, dataSize);
+
+        VkCommandBuffer commandBuffer = uploadBatch.getCommandBuffer();
+        imageBarrier(
+            commandBuffer, image, 0, mipLevels,
+            VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, 0,
+            VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT);
+
+        uint32_t givenLevels = std::min(static_cast<uint32_t>(builder.levels.size()) - baseLevel, mipLevels);
+        std::vector<VkBufferImageCopy> regions(givenLevels);
+        for (uint32_t level = 0; level < givenLevels; ++level)
+        {
+            VkBufferImageCopy &region = regions[level];
+            region.bufferOffset = staging.offset + builder.levels[baseLevel + level].offset - dataOffset;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.mipLevel = level;
+            region.imageSubresource.baseArrayLayer = 0;
+            region.imageSubresource.layerCount = 1;
+            region.imageExtent = {std::max(extent.width >> level, 1u), std::max(extent.height >> level, 1u), 1};
+        }
+        vkCmdCopyBufferToImage(
+            commandBuffer,
+            staging.buffer,
+            image,
+            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            static_cast<uint32_t>(regions.size()),
+            regions.data());
+
+        if (mipLevels == givenLevels)
+        {
+            makeShaderReadable(commandBuffer, image, 0, mipLevels, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+            return;
+        }
+
+        // Each generated level is blitted from the one above, which is then done
+        for (uint32_t level = givenLevels; level < mipLevels; ++level)
+        {
+            imageBarrier(
+                commandBuffer, image, level - 1, 1,
+                VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_WRITE_BIT,
+                VK_PIPELINE_STAGE_TRANSFER_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+
+            VkImageBlit blit{};
+            blit.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level - 1, 0, 1};
+            blit.srcOffsets[1] = {static_cast<int32_t>(std::max(extent.width >> (level - 1), 1u)),
+                                  static_cast<int32_t>(std::max(extent.height >> (level - 1), 1u)), 1};
+            blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, level, 0, 1};
+            blit.dstOffsets[1] = {static_cast<int32_t>(std::max(extent.width >> level, 1u)),
+                                  static_cast<int32_t>(std::max(extent.height >> level, 1u)), 1};
+            vkCmdBlitImage(
+                commandBuffer,
+                image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+                1, &blit,
+                VK_FILTER_LINEAR);
+
+            makeShaderReadable(commandBuffer, image, level - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
+        }
+
+        if (givenLevels > 1)
+        {
+            makeShaderReadable(commandBuffer, image, 0, givenLevels - 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+        }
+        makeShaderReadable(commandBuffer, image, mipLevels - 1, 1, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+    }
+}
@@ -0,0 +1,276 @@
+#include "texture_streamer.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace YTVK
+{
+    namespace
+    {
+        constexpr VkDeviceSize LEVEL_ALIGNMENT = 16;
+
+        bool isRgba8(VkFormat format)
+        {
+            return format == VK_FORMAT_R8G8B8A8_UNORM || format == VK_FORMAT_R8G8B8A8_SRGB ||
+                   format == VK_FORMAT_B8G8R8A8_UNORM || format == VK_FORMAT_B8G8R8A8_SRGB;
+        }
+
+        // Streaming needs every level in host memory; sources without a chain get a 2x2 box filtered one
+        void buildMipChain(Texture::Builder &builder)
+        {
+            uint32_t width = builder.extent.width;
+            uint32_t height = builder.extent.height;
+            while (width > 1 || height > 1)
+            {
+                uint32_t nextWidth = std::max(width / 2, 1u);
+                uint32_t nextHeight = std::max(height / 2, 1u);
+
+                VkDeviceSize source = builder.levels.back().offset;
+                VkDeviceSize offset = (builder.data.size() + LEVEL_ALIGNMENT - 1) / LEVEL_ALIGNMENT * LEVEL_ALIGNMENT;
+                VkDeviceSize size = static_cast<VkDeviceSize>(nextWidth) * nextHeight * 4;
+                builder.data.resize(offset + size);
+
+                const auto *in = reinterpret_cast<const uint8_t *>(builder.data.data() + source);
+                auto *out = reinterpret_cast<uint8_t *>(builder.data.data() + offset);
+                for (uint32_t y = 0; y < nextHeight; ++y)
+                {
+                    uint32_t y0 = std::min(y * 2, height - 1);
+                    uint32_t y1 = std::min(y * 2 + 1, height - 1);
+                    for (uint32_t x = 0; x < nextWidth; ++x)
+                    {
+                        uint32_t x0 = std::min(x * 2, width - 1);
+                        uint32_t x1 = std::min(x * 2 + 1, width - 1);
+                        for (uint32_t c = 0; c < 4; ++c)
+                        {
+                            uint32_t sum = in[(y0 * width + x0) * 4 + c] + in[(y0 * width + x1) * 4 + c] +
+                                           in[(y1 * width + x0) * 4 + c] + in[(y1 * width + x1) * 4 + c];
+                            out[(y * nextWidth + x) * 4 + c] = static_cast<uint8_t>((sum + 2) / 4);
+                        }
+                    }
+                }
+
+                builder.levels.push_back({offset, size});
+                width = nextWidth;
+                height = nextHeight;
+            }
+            builder.generateMipmaps = false;
+        }
+    }
+
+    TextureStreamer::TextureStreamer(Device &device, BindlessSet &bindlessSet, SamplerCache &samplerCache, VkDeviceSize budgetBytes)
+        : device{device},
+          bindlessSet{bindlessSet},
+          samplerCache{samplerCache},
+          budgetBytes{budgetBytes},
+          slotOwners(bindlessSet.getTextureCapacity(), NO_TEXTURE)
+    {
+    }
+
+    TextureStreamer::~TextureStreamer() {}
+
+    uint32_t TextureStreamer::addTexture(const std::string &path, UploadBatch &uploadBatch)
+    {
+        StreamedTexture texture{};
+        texture.source.loadTexture(path);
+        if (texture.source.generateMipmaps)
+        {
+            if (!isRgba8(texture.source.format) || texture.source.levels.size() != 1)
+            {
+                throw std::runtime_error("streamed textures need a full mip chain or an 8 bit rgba source: " + path);
+            }
+            buildMipChain(texture.source);
+        }
+
+        // The first level no larger than INITIAL_MAX_EXTENT, or the smallest one there is
+        uint32_t lastMip = static_cast<uint32_t>(texture.source.levels.size()) - 1;
+        uint32_t largest = std::max(texture.source.extent.width, texture.source.extent.height);
+        texture.initialMip = 0;
+        while (texture.initialMip < lastMip && (largest >> texture.initialMip) > INITIAL_MAX_EXTENT)
+        {
+            texture.initialMip++;
+        }
+        texture.residentMip = texture.initialMip;
+        texture.desiredMip = texture.initialMip;
+        texture.resident = std::make_unique<Texture>(device, uploadBatch, texture.source, samplerCache.getSampler(), texture.initialMip);
+        residentBytes += texture.resident->getMemorySize();
+
+        uint32_t slot = texture.resident->registerBindless(bindlessSet);
+        slotOwners[slot] = static_cast<uint32_t>(textures.size());
+        textures.push_back(std::move(texture));
+        return slot;
+    }
+
+    void TextureStreamer::update(const Camera &camera, float viewportHeight, std::vector<GameObject> &gameObjects)
+    {
+        YTVK_TRACE_SCOPE("TextureStreamer::update");
+        estimateDesiredMips(camera, viewportHeight, gameObjects);
+        swapInFinishedUploads(gameObjects);
+        startUploads();
+    }
+
+    VkDeviceSize TextureStreamer::bytesFrom(const StreamedTexture &texture, uint32_t mip)
+    {
+        return texture.source.data.size() - texture.source.levels[mip].offset;
+    }
+
+    void TextureStreamer::estimateDesiredMips(const Camera &camera, float viewportHeight, const std::vector<GameObject> &gameObjects)
+    {
+        for (auto &texture : textures)
+        {
+            texture.desiredMip = texture.initialMip;
+        }
+
+        // Screen pixels covered by one world unit at depth 1; the UVs are assumed to span the object once
+        float pixelsPerUnit = camera.getProjection()[1][1] * viewportHeight * 0.5f;
+        const glm::mat4 &view = camera.getView();
+        for (const auto &object : gameObjects)
+        {
+            if (object.textureIndex >= slotOwners.size() || slotOwners[object.textureIndex] == NO_TEXTURE)
+            {
+                continue;
+            }
+            StreamedTexture &texture = textures[slotOwners[object.textureIndex]];
+
+            const glm::vec3 &scale = object.transform.scale;
+            float depth = (view * glm::vec4{object.transform.translation, 1.0f}).z;
+            float radius = std::max({std::abs(scale.x), std::abs(scale.y), std::abs(scale.z)});
+            if (depth + radius <= 0.0f)
+            {
+                continue;
+            }
+            float pixels = 2.0f * radius * pixelsPerUnit / std::max(depth, radius);
+
+            float texels = static_cast<float>(std::max(texture.source.extent.width, texture.source.extent.height));
+            float level = pixels > 0.0f ? std::log2(std::max(texels / pixels, 1.0f)) : static_cast<float>(texture.initialMip);
+            texture.desiredMip = std::min(texture.desiredMip, static_cast<uint32_t>(level));
+        }
+    }
+
+    void TextureStreamer::swapInFinishedUploads(std::vector<GameObject> &gameObjects)
+    {
+        movedSlots.clear();
+        for (uint32_t id = 0; id < textures.size(); ++id)
+        {
+            StreamedTexture &texture = textures[id];
+            if (!texture.incoming || !device.isTimelineValueComplete(texture.incomingTimelineValue))
+            {
+                continue;
+            }
+
+            // Frames in flight keep the old slot and image; both are released once they retire
+            uint32_t oldSlot = texture.resident->getBindlessIndex();
+            uint32_t newSlot = texture.incoming->registerBindless(bindlessSet);
+            residentBytes -= texture.resident->getMemorySize();
+            texture.resident = std::move(texture.incoming);
+            texture.residentMip = texture.incomingMip;
+
+            slotOwners[oldSlot] = NO_TEXTURE;
+            slotOwners[newSlot] = id;
+            movedSlots.push_back({oldSlot, newSlot});
+        }
+
+        if (movedSlots.empty())
+        {
+            return;
+        }
+        for (auto &object : gameObjects)
+        {
+            for (const auto &[oldSlot, newSlot] : movedSlots)
+            {
+                if (object.textureIndex == oldSlot)
+                {
+                    object.textureIndex = newSlot;
+                    break;
+                }
+            }
+        }
+    }
+
+    void TextureStreamer::startUploads()
+    {
+        // Most mips missing first
+        candidates.clear();
+        for (uint32_t id = 0; id < textures.size(); ++id)
+        {
+            if (!textures[id].incoming && textures[id].desiredMip < textures[id].residentMip)
+            {
+                candidates.push_back(id);
+            }
+        }
+        std::sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b)
+                  { return textures[a].residentMip - textures[a].desiredMip > textures[b].residentMip - textures[b].desiredMip; });
+
+        // --vram-budget-mb may leave less room than the streaming budget; the streamer's own images are
+        // already inside the tracked total, so only the headroom beyond them can be added
+        VkDeviceSize headroom = device.memoryTracker().getDeviceLocalHeadroom();
+        VkDeviceSize budget = headroom >= budgetBytes ? budgetBytes : std::min(budgetBytes, residentBytes + headroom);
+
+        UploadBatch uploadBatch{device};
+        started.clear();
+        VkDeviceSize uploadBytes = 0;
+        bool blocked = false;
+        for (uint32_t id : candidates)
+        {
+            VkDeviceSize bytes = bytesFrom(textures[id], textures[id].desiredMip);
+            if (uploadBytes > 0 && uploadBytes + bytes > MAX_UPLOAD_BYTES_PER_UPDATE)
+            {
+                break;
+            }
+            if (residentBytes + bytes > budget || !startUpload(id, textures[id].desiredMip, uploadBatch))
+            {
+                blocked = true;
+                continue;
+            }
+            uploadBytes += bytes;
+        }
+
+        // Shrink textures that hold more detail than their objects need, largest surplus first
+        if (blocked || residentBytes > budget)
+        {
+            candidates.clear();
+            for (uint32_t id = 0; id < textures.size(); ++id)
+            {
+                if (!textures[id].incoming && textures[id].desiredMip > textures[id].residentMip)
+                {
+                    candidates.push_back(id);
+                }
+            }
+            std::sort(candidates.begin(), candidates.end(), [this](uint32_t a, uint32_t b)
+                      { return textures[a].desiredMip - textures[a].residentMip > textures[b].desiredMip - textures[b].residentMip; });
+            for (uint32_t id : candidates)
+            {
+                startUpload(id, textures[id].desiredMip, uploadBatch);
+            }
+        }
+
+        if (started.empty())
+        {
+            return;
+        }
+        uint64_t timelineValue = uploadBatch.submit();
+        for (uint32_t id : started)
+        {
+            textures[id].incomingTimelineValue = timelineValue;
+        }
+    }
+
+    bool TextureStreamer::startUpload(uint32_t id, uint32_t mip, UploadBatch &uploadBatch)
+    {
+        StreamedTexture &texture = textures[id];
+        try
+        {
+            texture.incoming = std::make_unique<Texture>(device, uploadBatch, texture.source, texture.resident->getSampler(), mip);
+        }
+        catch (const MemoryBudgetExceeded &)
+        {
+            // Alignment can make the image larger than its texel bytes; the texture stays as it is
+            return false;
+        }
+        texture.incomingMip = mip;
+        residentBytes += texture.incoming->getMemorySize();
+        started.push_back(id);
+        return true;
+    }
+}
@@ -0,0 +1,132 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+namespace YTVK
+{
+    ThreadPool::ThreadPool(uint32_t threadCount)
+    {
+        threadCount = std::max(threadCount, 1u);
+        workers.reserve(threadCount);
+        for (uint32_t i = 0; i < threadCount; ++i)
+        {
+            workers.emplace_back([this]
+                                 { workerLoop(); });
+        }
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            stopping = true;
+        }
+        jobAvailable.notify_all();
+
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    void ThreadPool::submit(std::function<void()> job)
+    {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            jobs.push_back(std::move(job));
+            ++pendingJobs;
+        }
+        jobAvailable.notify_one();
+    }
+
+    void ThreadPool::wait()
+    {
+        std::unique_lock<std::mutex> lock{mutex};
+        jobsFinished.wait(lock, [this]
+                          { return pendingJobs == 0; });
+
+        if (firstError)
+        {
+            auto error = firstError;
+            firstError = nullptr;
+            std::rethrow_exception(error);
+        }
+    }
+
+    void ThreadPool::parallelFor(size_t count, size_t minChunk, const std::function<void(size_t, size_t)> &job)
+    {
+        if (count == 0)
+        {
+            return;
+        }
+
+        size_t chunkCount = std::min<size_t>(size(), (count + minChunk - 1) / std::max<size_t>(minChunk, 1));
+        if (chunkCount <= 1)
+        {
+            job(0, count);
+            return;
+        }
+
+        // The chunk jobs capture 16 bytes, which std::function stores without allocating
+        struct Range
+        {
+            const std::function<void(size_t, size_t)> &job;
+            size_t count;
+            size_t chunkSize;
+        } range{job, count, (count + chunkCount - 1) / chunkCount};
+
+        for (size_t begin = 0; begin < count; begin += range.chunkSize)
+        {
+            submit([&range, begin]
+                   { range.job(begin, std::min(begin + range.chunkSize, range.count)); });
+        }
+        wait();
+    }
+
+    void ThreadPool::workerLoop()
+    {
+        while (true)
+        {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock{mutex};
+                jobAvailable.wait(lock, [this]
+                                  { return stopping || nextJob < jobs.size(); });
+
+                if (stopping && nextJob == jobs.size())
+                {
+                    return;
+                }
+
+                job = std::move(jobs[nextJob++]);
+                if (nextJob == jobs.size())
+                {
+                    jobs.clear();
+                    nextJob = 0;
+                }
+            }
+
+            try
+            {
+                job();
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                if (!firstError)
+                {
+                    firstError = std::current_exception();
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock{mutex};
+                --pendingJobs;
+                if (pendingJobs == 0)
+                {
+                    jobsFinished.notify_all();
+                }
+            }
+        }
+    }
+}
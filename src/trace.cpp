@@ -0,0 +1,146 @@
+#include "trace.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace YTVK
+{
+    std::atomic<bool> Trace::enabledFlag{false};
+
+    namespace
+    {
+        struct TraceEvent
+        {
+            const char *name;
+            uint64_t begin;
+            uint64_t end;
+        };
+
+        struct ThreadBuffer
+        {
+            uint32_t threadId;
+            std::string threadName;
+            // Only contended while a dump is being written
+            std::mutex mutex;
+            std::vector<TraceEvent> events;
+            size_t next = 0;
+            bool wrapped = false;
+        };
+
+        std::mutex registryMutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> registry;
+
+        ThreadBuffer &threadBuffer()
+        {
+            thread_local std::shared_ptr<ThreadBuffer> buffer = []
+            {
+                auto created = std::make_shared<ThreadBuffer>();
+                created->events.resize(Trace::EVENTS_PER_THREAD);
+
+                std::lock_guard<std::mutex> lock{registryMutex};
+                created->threadId = static_cast<uint32_t>(registry.size() + 1);
+                registry.push_back(created);
+                return created;
+            }();
+            return *buffer;
+        }
+    }
+
+    uint64_t Trace::now()
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+    }
+
+    void Trace::record(const char *name, uint64_t begin, uint64_t end)
+    {
+        ThreadBuffer &buffer = threadBuffer();
+        std::lock_guard<std::mutex> lock{buffer.mutex};
+
+        buffer.events[buffer.next] = {name, begin, end};
+        buffer.next++;
+        if (buffer.next == buffer.events.size())
+        {
+            buffer.next = 0;
+            buffer.wrapped = true;
+        }
+    }
+
+    void Trace::setThreadName(const std::string &name)
+    {
+        ThreadBuffer &buffer = threadBuffer();
+        std::lock_guard<std::mutex> lock{buffer.mutex};
+        buffer.threadName = name;
+    }
+
+    void Trace::writeChromeJson(const std::string &path)
+    {
+        std::ofstream out{path};
+        if (!out.is_open())
+        {
+            throw std::runtime_error("failed to open file: " + path);
+        }
+
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        {
+            std::lock_guard<std::mutex> lock{registryMutex};
+            buffers = registry;
+        }
+
+        // Timestamps are rebased so the trace starts near zero
+        uint64_t origin = ~0ull;
+        std::vector<std::pair<std::shared_ptr<ThreadBuffer>, std::vector<TraceEvent>>> snapshots;
+        for (auto &buffer : buffers)
+        {
+            std::vector<TraceEvent> events;
+            {
+                std::lock_guard<std::mutex> lock{buffer->mutex};
+                if (buffer->wrapped)
+                {
+                    events.insert(events.end(), buffer->events.begin() + buffer->next, buffer->events.end());
+                }
+                events.insert(events.end(), buffer->events.begin(), buffer->events.begin() + buffer->next);
+            }
+
+            for (const auto &event : events)
+            {
+                origin = std::min(origin, event.begin);
+            }
+            snapshots.emplace_back(buffer, std::move(events));
+        }
+
+        out << std::fixed << std::setprecision(3);
+        out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+        bool first = true;
+        auto separator = [&]() -> const char *
+        {
+            const char *value = first ? "" : ",\n";
+            first = false;
+            return value;
+        };
+
+        for (const auto &[buffer, events] : snapshots)
+        {
+            std::string threadName = buffer->threadName.empty() ? "thread " + std::to_string(buffer->threadId) : buffer->threadName;
+            out << separator() << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << buffer->threadId
+                << ", \"args\": {\"name\": \"" << escapeJson(threadName) << "\"}}";
+
+            for (const auto &event : events)
+            {
+                // Chrome trace timestamps are fractional microseconds
+                out << separator() << "{\"name\": \"" << escapeJson(event.name) << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << buffer->threadId
+                    << ", \"ts\": " << static_cast<double>(event.begin - origin) / 1000.0
+                    << ", \"dur\": " << static_cast<double>(event.end - event.begin) / 1000.0 << "}";
+            }
+        }
+        out << "\n]}\n";
+    }
+}
@@ -0,0 +1,88 @@
+#include "upload_batch.hpp"
+#include "trace.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace YTVK
+{
+    UploadBatch::UploadBatch(Device &device) : device{device} {}
+
+    UploadBatch::~UploadBatch()
+    {
+        if (commandBuffer != VK_NULL_HANDLE)
+        {
+            vkEndCommandBuffer(commandBuffer);
+            vkFreeCommandBuffers(device.device(), device.getCommandPool(), 1, &commandBuffer);
+        }
+    }
+
+    UploadBatch::Staging UploadBatch::stage(VkDeviceSize size, VkDeviceSize alignment)
+    {
+        VkDeviceSize offset = (chunkOffset + alignment - 1) / alignment * alignment;
+        if (chunks.empty() || offset + size > chunks.back()->getBufferSize())
+        {
+            auto chunk = std::make_unique<Buffer>(
+                device,
+                std::max(size, STAGING_CHUNK_SIZE),
+                1,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+                VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+            chunk->map();
+            chunks.push_back(std::move(chunk));
+            offset = 0;
+        }
+
+        Buffer &chunk = *chunks.back();
+        chunkOffset = offset + size;
+        stagedBytes += size;
+        return {chunk.getBuffer(), offset, static_cast<char *>(chunk.getMappedMemory()) + offset};
+    }
+
+    void UploadBatch::copyToBuffer(const void *data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset)
+    {
+        Staging staging = stage(size);
+        std::memcpy(staging.data, data, static_cast<size_t>(size));
+
+        VkBufferCopy copyRegion{};
+        copyRegion.srcOffset = staging.offset;
+        copyRegion.dstOffset = dstOffset;
+        copyRegion.size = size;
+        vkCmdCopyBuffer(getCommandBuffer(), staging.buffer, dstBuffer, 1, &copyRegion);
+    }
+
+    VkCommandBuffer UploadBatch::getCommandBuffer()
+    {
+        if (commandBuffer == VK_NULL_HANDLE)
+        {
+            commandBuffer = device.beginSingleTimeCommands();
+        }
+        return commandBuffer;
+    }
+
+    uint64_t UploadBatch::submit()
+    {
+        YTVK_TRACE_SCOPE("UploadBatch::submit");
+        if (commandBuffer == VK_NULL_HANDLE)
+        {
+            return device.lastTimelineValue();
+        }
+
+        uint64_t timelineValue = device.submitSingleTimeCommands(commandBuffer);
+        commandBuffer = VK_NULL_HANDLE;
+
+        // Shared so the deletion queue callback stays copyable
+        auto staging = std::make_shared<std::vector<std::unique_ptr<Buffer>>>(std::move(chunks));
+        device.deletionQueue().push(timelineValue, [staging]()
+                                    { staging->clear(); });
+        chunks.clear();
+        chunkOffset = 0;
+        stagedBytes = 0;
+        return timelineValue;
+    }
+
+    void UploadBatch::submitAndWait()
+    {
+        device.waitForTimelineValue(submit());
+    }
+}
@@ -0,0 +1,206 @@
+/*
+ * ytvk-cook: offline mesh cooker
+ *
+ * Imports OBJ files through Model::Builder, runs dedup / vertex cache / fetch optimization,
+ * generates clustered LODs and writes quantized .ymesh artifacts. Inputs whose content hash
+ * matches the hash recorded in an existing artifact are skipped.
+ *
+ * With --archive, the artifacts and every other input (e.g. SPIR-V) are packed under the paths the
+ * runtime asks for: models/a.obj is stored as models/a.ymesh, shaders/a.vert.spv as itself.
+ * Inputs are relative to the working directory, which must be the repository root.
+ *
+ * usage: ytvk-cook [-o outdir] [-j threads] [--lods N] [--archive out.ytva] [--force] <file.obj|file>...
+ */
+
+#include "model.hpp"
+#include "mesh_processing.hpp"
+#include "asset_archive.hpp"
+#include "thread_pool.hpp"
+
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Bump whenever the processing pipeline or artifact layout changes so old outputs get rebuilt
+    constexpr uint64_t COOK_VERSION = 1;
+
+    struct CookOptions
+    {
+        fs::path outputDirectory{"cooked"};
+        uint32_t threadCount = std::thread::hardware_concurrency();
+        uint32_t lodCount = 3;
+        std::string archivePath{};
+        bool force = false;
+        std::vector<fs::path> inputs{};
+    };
+
+    void printUsage()
+    {
+        std::cerr << "usage: ytvk-cook [-o outdir] [-j threads] [--lods N] [--archive out.ytva] [--force] <file.obj|file>..."
+                  << std::endl;
+    }
+
+    bool parseOptions(int argc, char **argv, CookOptions &options)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            bool hasValue = i + 1 < argc;
+
+            if (arg == "-o" && hasValue)
+                options.outputDirectory = argv[++i];
+            else if (arg == "-j" && hasValue)
+                options.threadCount = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+            else if (arg == "--lods" && hasValue)
+                options.lodCount = static_cast<uint32_t>(std::max(1, std::atoi(argv[++i])));
+            else if (arg == "--archive" && hasValue)
+                options.archivePath = argv[++i];
+            else if (arg == "--force")
+                options.force = true;
+            else if (!arg.empty() && arg[0] == '-')
+                return false;
+            else
+                options.inputs.push_back(arg);
+        }
+        return !options.inputs.empty();
+    }
+
+    // Artifacts and archive keys mirror the input path, so it has to stay below the working directory
+    bool escapesRoot(const fs::path &normalized)
+    {
+        return normalized.empty() || normalized.has_root_path() || *normalized.begin() == "..";
+    }
+
+    YTVK::Model::Builder optimize(YTVK::Model::Builder builder)
+    {
+        YTVK::deduplicateVertices(builder);
+        YTVK::optimizeVertexCache(builder);
+        YTVK::optimizeVertexFetch(builder);
+        return builder;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    CookOptions options{};
+    if (!parseOptions(argc, argv, options))
+    {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    for (const auto &input : options.inputs)
+    {
+        if (escapesRoot(input.lexically_normal()))
+        {
+            std::cerr << input.string() << ": inputs must be relative paths inside the working directory" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // Cooked meshes get an artifact under outputDirectory; anything else is packed as is
+    std::vector<fs::path> outputs(options.inputs.size());
+    std::vector<std::string> archiveKeys(options.inputs.size());
+    std::atomic<uint32_t> cookedCount{0};
+    std::atomic<uint32_t> skippedCount{0};
+    std::atomic<uint32_t> failedCount{0};
+    std::mutex logMutex;
+
+    {
+        YTVK::ThreadPool pool{options.threadCount};
+
+        for (size_t i = 0; i < options.inputs.size(); ++i)
+        {
+            fs::path key = options.inputs[i].lexically_normal();
+            if (key.extension() != ".obj")
+            {
+                outputs[i] = options.inputs[i];
+                archiveKeys[i] = key.generic_string();
+                continue;
+            }
+            key.replace_extension(".ymesh");
+            archiveKeys[i] = key.generic_string();
+            outputs[i] = options.outputDirectory / key;
+
+            pool.submit([&, i]
+                        {
+                const fs::path &input = options.inputs[i];
+                const fs::path &output = outputs[i];
+
+                try
+                {
+                    std::vector<char> source = YTVK::AssetArchive::readFile(input.string());
+                    uint64_t hash = YTVK::AssetArchive::hashBytes(source.data(), source.size());
+                    uint64_t settings[] = {COOK_VERSION, options.lodCount};
+                    hash = YTVK::AssetArchive::hashBytes(reinterpret_cast<const char *>(settings), sizeof(settings), hash);
+
+                    if (!options.force && YTVK::CookedMesh::readSourceHash(output.string()) == hash)
+                    {
+                        skippedCount++;
+                        return;
+                    }
+
+                    YTVK::Model::Builder imported{};
+                    imported.loadModel(input.string());
+                    float acmrBefore = YTVK::averageCacheMissRatio(imported);
+
+                    YTVK::CookedMesh mesh{};
+                    mesh.sourceHash = hash;
+                    mesh.lods.push_back(optimize(std::move(imported)));
+
+                    // Each LOD targets roughly a quarter of the previous vertex count
+                    for (uint32_t lod = 1; lod < options.lodCount; ++lod)
+                    {
+                        float targetVertices = static_cast<float>(mesh.lods[0].vertices.size()) / std::pow(4.0f, static_cast<float>(lod));
+                        uint32_t grid = std::max(2u, static_cast<uint32_t>(std::sqrt(targetVertices)));
+                        auto simplified = optimize(YTVK::generateLod(mesh.lods[0], grid));
+                        if (simplified.indices.empty())
+                        {
+                            break;
+                        }
+                        mesh.lods.push_back(std::move(simplified));
+                    }
+
+                    fs::create_directories(output.parent_path());
+                    mesh.write(output.string());
+                    cookedCount++;
+
+                    std::lock_guard<std::mutex> lock{logMutex};
+                    std::cout << input.string() << " -> " << output.string()
+                              << " (" << mesh.lods[0].vertices.size() << " vertices, "
+                              << mesh.lods.size() << " lods, acmr " << acmrBefore << " -> "
+                              << YTVK::averageCacheMissRatio(mesh.lods[0]) << ")" << std::endl;
+                }
+                catch (const std::exception &e)
+                {
+                    failedCount++;
+                    std::lock_guard<std::mutex> lock{logMutex};
+                    std::cerr << input.string() << ": " << e.what() << std::endl;
+                } });
+        }
+
+        pool.wait();
+    }
+
+    if (!options.archivePath.empty() && failedCount == 0)
+    {
+        YTVK::AssetArchive::Writer writer{};
+        for (size_t i = 0; i < outputs.size(); ++i)
+        {
+            writer.addFile(archiveKeys[i], outputs[i].string());
+        }
+        writer.write(options.archivePath);
+    }
+
+    std::cout << "cooked " << cookedCount << ", up to date " << skippedCount << ", failed " << failedCount << std::endl;
+    return failedCount == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}